@@ -0,0 +1,124 @@
+#ifndef ALIGNED_ARENA_H
+#define ALIGNED_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+/*
+ * Cache-line aligned scratch memory for per-frame buffers.
+ *
+ * FrameArena hands out blocks from one preallocated buffer by bumping an
+ * offset and is reset wholesale at the start of every frame, so steady-state
+ * frames never call malloc. Every block starts on a 64-byte boundary and is
+ * padded to a multiple of 64 bytes. Kernels given such a block may read and
+ * write whole cache lines past the logical end, which is what the aligned_t
+ * overloads in aligned_kernels.h rely on.
+ */
+
+// Alignment and padding granularity of arena blocks
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Round a byte count up to a whole number of cache lines
+ */
+inline size_t cache_line_round_up(size_t bytes) {
+    return (bytes + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+}
+
+/**
+ * @brief Non-owning view of a cache-line aligned, cache-line padded array
+ */
+template <typename T>
+class AlignedSpan {
+public:
+    AlignedSpan() = default;
+    AlignedSpan(T* data, size_t size) : data_(data), size_(size) {}
+    
+    template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+    AlignedSpan(AlignedSpan<U> other) : data_(other.data()), size_(other.size()) {}
+    
+    T* data() const { return static_cast<T*>(__builtin_assume_aligned(data_, CACHE_LINE_SIZE)); }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    
+    T& operator[](size_t i) const { return data_[i]; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Bump allocator over one cache-line aligned buffer, reset once per frame
+ */
+class FrameArena {
+public:
+    /**
+     * @brief Allocate the backing buffer
+     * @param capacity_bytes Total bytes available between resets (rounded up to a cache line)
+     */
+    explicit FrameArena(size_t capacity_bytes)
+        : capacity_(cache_line_round_up(capacity_bytes)),
+          base_(static_cast<uint8_t*>(std::aligned_alloc(CACHE_LINE_SIZE, capacity_ ? capacity_ : CACHE_LINE_SIZE))) {
+        if (!base_) throw std::bad_alloc();
+    }
+    
+    ~FrameArena() { std::free(base_); }
+    
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    
+    /**
+     * @brief Allocate an uninitialized array
+     * @param count Number of elements
+     * @return Cache-line aligned pointer, valid until the next reset()
+     * @throws std::bad_alloc if the arena is exhausted
+     */
+    template <typename T>
+    T* allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is released without destructors");
+        static_assert(alignof(T) <= CACHE_LINE_SIZE, "over-aligned type");
+        
+        const size_t bytes = cache_line_round_up(count * sizeof(T));
+        if (bytes > capacity_ - used_) throw std::bad_alloc();
+        
+        T* ptr = reinterpret_cast<T*>(base_ + used_);
+        used_ += bytes;
+        if (used_ > high_water_) high_water_ = used_;
+        return ptr;
+    }
+    
+    /**
+     * @brief Allocate an uninitialized array as an AlignedSpan
+     */
+    template <typename T>
+    AlignedSpan<T> allocate_span(size_t count) {
+        return AlignedSpan<T>(allocate<T>(count), count);
+    }
+    
+    /**
+     * @brief Release every allocation at once
+     */
+    void reset() { used_ = 0; }
+    
+    size_t used() const { return used_; }
+    size_t capacity() const { return capacity_; }
+    
+    /**
+     * @brief Largest used() seen since construction, for sizing the arena
+     */
+    size_t high_water() const { return high_water_; }
+
+private:
+    size_t capacity_;
+    uint8_t* base_;
+    size_t used_ = 0;
+    size_t high_water_ = 0;
+};
+
+#endif // ALIGNED_ARENA_H
@@ -0,0 +1,291 @@
+#ifndef ALIGNED_KERNELS_H
+#define ALIGNED_KERNELS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "simd.h"
+#include "simd_tail.h"
+#include "aligned_arena.h"
+#include "obj_detection_util.h"
+
+/*
+ * Aligned fast paths of the array kernels, selected with the `aligned` tag:
+ *
+ *     float avg = weighted_average(aligned, values, weights, count);
+ *
+ * Every pointer must be 64-byte aligned and its buffer padded to a whole
+ * number of cache lines, as FrameArena and AlignedSpan guarantee. The loops
+ * then move one full cache line (16 floats) per iteration with four-register
+ * loads and stores, and finish with one more full line instead of a scalar
+ * tail: reductions mask the lanes past count, element-wise kernels simply
+ * write into the padding.
+ *
+ * exp_moving_average() has no aligned overload: it is one serial scalar
+ * recurrence, and neither alignment nor padding shortens that chain.
+ */
+
+/**
+ * @brief Tag selecting the aligned, padded overload of a kernel
+ */
+struct aligned_t {
+    explicit aligned_t() = default;
+};
+
+constexpr aligned_t aligned{};
+
+// Floats per cache line, the step of every aligned loop
+constexpr size_t ALIGNED_LINE_FLOATS = CACHE_LINE_SIZE / sizeof(float);
+
+/**
+ * @brief Zero the lanes of a cache line at or past `remaining`
+ * @param line Sixteen floats
+ * @param remaining Number of valid floats in the line (1 to 16)
+ */
+inline float32x4x4_t aligned_mask_line(float32x4x4_t line, size_t remaining) {
+    for (size_t k = 0; k < 4; ++k) {
+        const size_t valid = remaining > 4 * k ? remaining - 4 * k : 0;
+        const uint32x4_t mask = simd_tail::lane_mask_first(valid < 4 ? valid : 4);
+        line.val[k] = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(line.val[k]), mask));
+    }
+    return line;
+}
+
+/**
+ * @brief Sum four accumulators and their lanes
+ */
+inline float aligned_reduce(const float32x4_t acc[4]) {
+    return vaddvq_f32(vaddq_f32(vaddq_f32(acc[0], acc[1]), vaddq_f32(acc[2], acc[3])));
+}
+
+/**
+ * @brief Calculate weighted average of an aligned, padded array of values
+ * @param values Array of values to average
+ * @param weights Array of weights corresponding to each value
+ * @param count Number of elements in both arrays
+ * @return Weighted average result
+ */
+inline float weighted_average(aligned_t, const float* values, const float* weights, size_t count) {
+    const float* v = static_cast<const float*>(__builtin_assume_aligned(values, CACHE_LINE_SIZE));
+    const float* w = static_cast<const float*>(__builtin_assume_aligned(weights, CACHE_LINE_SIZE));
+    
+    float32x4_t sum_weighted[4], sum_weights[4];
+    for (size_t k = 0; k < 4; ++k) {
+        sum_weighted[k] = vdupq_n_f32(0.0f);
+        sum_weights[k] = vdupq_n_f32(0.0f);
+    }
+    
+    for (size_t i = 0; i < count; i += ALIGNED_LINE_FLOATS) {
+        float32x4x4_t vals = vld1q_f32_x4(&v[i]);
+        float32x4x4_t wts = vld1q_f32_x4(&w[i]);
+        if (count - i < ALIGNED_LINE_FLOATS) {
+            vals = aligned_mask_line(vals, count - i);
+            wts = aligned_mask_line(wts, count - i);
+        }
+        
+        for (size_t k = 0; k < 4; ++k) {
+            sum_weighted[k] = vfmaq_f32(sum_weighted[k], vals.val[k], wts.val[k]);
+            sum_weights[k] = vaddq_f32(sum_weights[k], wts.val[k]);
+        }
+    }
+    
+    const float weight_sum = aligned_reduce(sum_weights);
+    return weight_sum > 0.0f ? aligned_reduce(sum_weighted) / weight_sum : 0.0f;
+}
+
+/**
+ * @brief Calculate cross-correlation between two aligned, padded signals
+ * @param signal1 First signal array
+ * @param signal2 Second signal array
+ * @param length Length of both signals
+ * @return Cross-correlation value
+ */
+inline float cross_correlation(aligned_t, const float* signal1, const float* signal2, size_t length) {
+    const float* a = static_cast<const float*>(__builtin_assume_aligned(signal1, CACHE_LINE_SIZE));
+    const float* b = static_cast<const float*>(__builtin_assume_aligned(signal2, CACHE_LINE_SIZE));
+    
+    float32x4_t sum[4];
+    for (size_t k = 0; k < 4; ++k) sum[k] = vdupq_n_f32(0.0f);
+    
+    for (size_t i = 0; i < length; i += ALIGNED_LINE_FLOATS) {
+        float32x4x4_t s1 = vld1q_f32_x4(&a[i]);
+        float32x4x4_t s2 = vld1q_f32_x4(&b[i]);
+        if (length - i < ALIGNED_LINE_FLOATS) {
+            s1 = aligned_mask_line(s1, length - i);
+            s2 = aligned_mask_line(s2, length - i);
+        }
+        
+        for (size_t k = 0; k < 4; ++k) {
+            sum[k] = vfmaq_f32(sum[k], s1.val[k], s2.val[k]);
+        }
+    }
+    
+    return aligned_reduce(sum);
+}
+
+/**
+ * @brief Calculate speed from aligned, padded position arrays
+ * @param positions_prev Previous position values
+ * @param positions_curr Current position values
+ * @param speeds Output array for calculated speeds (padding is overwritten)
+ * @param count Number of elements
+ * @param time_delta Time difference between measurements
+ */
+inline void speed(aligned_t, const float* positions_prev, const float* positions_curr,
+                  float* speeds, size_t count, float time_delta) {
+    const float* prev = static_cast<const float*>(__builtin_assume_aligned(positions_prev, CACHE_LINE_SIZE));
+    const float* curr = static_cast<const float*>(__builtin_assume_aligned(positions_curr, CACHE_LINE_SIZE));
+    float* out = static_cast<float*>(__builtin_assume_aligned(speeds, CACHE_LINE_SIZE));
+    const float32x4_t time_inv = vdupq_n_f32(1.0f / time_delta);
+    
+    for (size_t i = 0; i < count; i += ALIGNED_LINE_FLOATS) {
+        float32x4x4_t p = vld1q_f32_x4(&prev[i]);
+        float32x4x4_t c = vld1q_f32_x4(&curr[i]);
+        
+        float32x4x4_t result;
+        for (size_t k = 0; k < 4; ++k) {
+            result.val[k] = vmulq_f32(vsubq_f32(c.val[k], p.val[k]), time_inv);
+        }
+        vst1q_f32_x4(&out[i], result);
+    }
+}
+
+/**
+ * @brief Calculate the cumulative sum of an aligned, padded array
+ * @param input Input array
+ * @param output Output array for the running sums (padding is overwritten)
+ * @param count Number of elements
+ * @param carry_in Running sum before input[0]
+ *
+ * Same sums, in the same order, as cumulative_sum().
+ */
+inline void cumulative_sum(aligned_t, const float* input, float* output, size_t count, float carry_in = 0.0f) {
+    const float* in = static_cast<const float*>(__builtin_assume_aligned(input, CACHE_LINE_SIZE));
+    float* out = static_cast<float*>(__builtin_assume_aligned(output, CACHE_LINE_SIZE));
+    float32x4_t carry = vdupq_n_f32(carry_in);
+    
+    for (size_t i = 0; i < count; i += ALIGNED_LINE_FLOATS) {
+        float32x4x4_t line = vld1q_f32_x4(&in[i]);
+        for (size_t k = 0; k < 4; ++k) {
+            line.val[k] = vaddq_f32(prefix_sum_f32x4(line.val[k]), carry);
+            carry = vdupq_laneq_f32(line.val[k], 3);
+        }
+        vst1q_f32_x4(&out[i], line);
+    }
+}
+
+/**
+ * @brief Apply a moving average filter to an aligned, padded signal
+ * @param input Input signal array
+ * @param output Filtered output array (padding is overwritten)
+ * @param count Number of elements in signal
+ * @param window_size Size of the moving average window
+ *
+ * Same outputs as moving_average_filter(). The warm-up and the rest of
+ * its cache line go through the general kernel, then every line holds
+ * four full-window vectors and is stored whole. The window loads start
+ * at every offset, so only the stores benefit from the alignment.
+ */
+inline void moving_average_filter(aligned_t, const float* input, float* output,
+                                  size_t count, size_t window_size) {
+    if (window_size == 0 || count == 0) return;
+    
+    const size_t warmup = window_size - 1;
+    const size_t first_line = (warmup + ALIGNED_LINE_FLOATS - 1) & ~(ALIGNED_LINE_FLOATS - 1);
+    moving_average_filter(input, output, first_line < count ? first_line : count, window_size);
+    
+    float* out = static_cast<float*>(__builtin_assume_aligned(output, CACHE_LINE_SIZE));
+    const float32x4_t scale_vec = vdupq_n_f32(1.0f / window_size);
+    for (size_t i = first_line; i < count; i += ALIGNED_LINE_FLOATS) {
+        float32x4x4_t line;
+        for (size_t k = 0; k < 4; ++k) {
+            line.val[k] = moving_window_mean(&input[i + 4 * k], window_size, scale_vec);
+        }
+        vst1q_f32_x4(&out[i], line);
+    }
+}
+
+/**
+ * @brief Detect values above threshold in aligned, padded sensor data
+ * @param sensor_data Input sensor data array
+ * @param detections Output boolean detection array (padding is overwritten)
+ * @param count Number of elements
+ * @param threshold Detection threshold value
+ */
+inline void threshold_detection(aligned_t, const float* sensor_data, uint8_t* detections,
+                                size_t count, float threshold) {
+    const float* data = static_cast<const float*>(__builtin_assume_aligned(sensor_data, CACHE_LINE_SIZE));
+    uint8_t* out = static_cast<uint8_t*>(__builtin_assume_aligned(detections, CACHE_LINE_SIZE));
+    const float32x4_t thresh_vec = vdupq_n_f32(threshold);
+    const uint8x16_t one = vdupq_n_u8(1);
+    
+    for (size_t i = 0; i < count; i += ALIGNED_LINE_FLOATS) {
+        float32x4x4_t line = vld1q_f32_x4(&data[i]);
+        
+        // Four 32-bit masks -> sixteen 8-bit masks in element order
+        uint16x8_t lo = vuzp1q_u16(vreinterpretq_u16_u32(vcgtq_f32(line.val[0], thresh_vec)),
+                                   vreinterpretq_u16_u32(vcgtq_f32(line.val[1], thresh_vec)));
+        uint16x8_t hi = vuzp1q_u16(vreinterpretq_u16_u32(vcgtq_f32(line.val[2], thresh_vec)),
+                                   vreinterpretq_u16_u32(vcgtq_f32(line.val[3], thresh_vec)));
+        uint8x16_t mask = vuzp1q_u8(vreinterpretq_u8_u16(lo), vreinterpretq_u8_u16(hi));
+        
+        vst1q_u8(&out[i], vandq_u8(mask, one));
+    }
+}
+
+/**
+ * @brief Find index of minimum value in an aligned, padded array
+ * @param array Input array to search
+ * @param count Number of elements in array
+ * @return Index of the first minimum value (0 if array is empty)
+ */
+inline size_t min_index(aligned_t, const float* array, size_t count) {
+    if (count == 0) return 0;
+    
+    const float* data = static_cast<const float*>(__builtin_assume_aligned(array, CACHE_LINE_SIZE));
+    // Copies of data[0] under index 0 start every lane and fill the lanes past count: they can never
+    // beat the real first element, so no sentinel value is needed
+    const float32x4_t first = vdupq_n_f32(data[0]);
+    const uint32x4_t step = vdupq_n_u32(ALIGNED_LINE_FLOATS);
+    
+    float32x4_t min_vec[4];
+    uint32x4_t min_idx[4], idx[4];
+    for (size_t k = 0; k < 4; ++k) {
+        min_vec[k] = first;
+        min_idx[k] = vdupq_n_u32(0);
+        const uint32x4_t lane = {0, 1, 2, 3};
+        idx[k] = vaddq_u32(lane, vdupq_n_u32(static_cast<uint32_t>(4 * k)));
+    }
+    
+    for (size_t i = 0; i < count; i += ALIGNED_LINE_FLOATS) {
+        float32x4x4_t line = vld1q_f32_x4(&data[i]);
+        const size_t remaining = count - i;
+        
+        for (size_t k = 0; k < 4; ++k) {
+            float32x4_t v = line.val[k];
+            if (remaining < ALIGNED_LINE_FLOATS) {
+                const size_t valid = remaining > 4 * k ? remaining - 4 * k : 0;
+                v = vbslq_f32(simd_tail::lane_mask_first(valid < 4 ? valid : 4), v, first);
+            }
+            
+            uint32x4_t mask = vcltq_f32(v, min_vec[k]);
+            min_vec[k] = vbslq_f32(mask, v, min_vec[k]);
+            min_idx[k] = vbslq_u32(mask, idx[k], min_idx[k]);
+            idx[k] = vaddq_u32(idx[k], step);
+        }
+    }
+    
+    // Earliest index among all lanes holding the minimum
+    const float min_val = vminvq_f32(vminq_f32(vminq_f32(min_vec[0], min_vec[1]), vminq_f32(min_vec[2], min_vec[3])));
+    const float32x4_t min_dup = vdupq_n_f32(min_val);
+    uint32x4_t candidates = vdupq_n_u32(UINT32_MAX);
+    for (size_t k = 0; k < 4; ++k) {
+        candidates = vminq_u32(candidates, vbslq_u32(vceqq_f32(min_vec[k], min_dup), min_idx[k], vdupq_n_u32(UINT32_MAX)));
+    }
+    
+    const uint32_t result = vminvq_u32(candidates);
+    return result == UINT32_MAX ? 0 : result;
+}
+
+#endif // ALIGNED_KERNELS_H
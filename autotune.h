@@ -0,0 +1,155 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "tuned_kernels.h"
+#include "benchmark.h"
+
+/*
+ * Measures every compiled loop shape of the tuned kernels on the running
+ * core and picks the fastest, for tuned_kernels.h to load at startup.
+ *
+ * The search runs in two stages per kernel:
+ *
+ *  1. Every accumulator/unroll shape, without prefetch, on arrays that
+ *     stay in L1. This isolates latency hiding and loop overhead.
+ *  2. Every prefetch distance with the winning shape, on arrays larger
+ *     than the last-level cache, where prefetching can pay off.
+ *
+ * A candidate replaces the current best only when it is faster by more
+ * than AUTOTUNE_MIN_GAIN. Shapes are tried simplest first, so noise does
+ * not trade a plain loop for a deeper one, or add prefetches that only
+ * cost bandwidth.
+ */
+
+// Fractional speedup a candidate needs over the current best to replace it
+constexpr double AUTOTUNE_MIN_GAIN = 0.02;
+
+struct AutotuneConfig {
+    size_t compute_elements = 2048;       // stage 1: 8 KB per array
+    size_t memory_elements = 4194304;     // stage 2: 16 MB per array
+    std::vector<size_t> prefetch_distances = {0, 128, 256, 512, 1024, 2048};
+    int warmup_trials = 2;
+    int trials = 9;
+    uint32_t seed = 42;
+};
+
+/**
+ * @brief One measured candidate
+ */
+struct AutotuneCandidate {
+    TunedKernel kernel;
+    const char* stage;  // "shape" or "prefetch"
+    TuningParams params;
+    double ns_per_element;  // median over trials
+    bool selected;          // best of its stage
+};
+
+struct AutotuneResult {
+    KernelTuning tuning;
+    std::vector<AutotuneCandidate> candidates;
+};
+
+/**
+ * @brief Benchmark entry running one shape of one kernel on the suite's buffers
+ */
+inline BenchmarkKernel autotune_kernel(TunedKernel kernel, const TuningParams& params, BenchmarkData& data) {
+    KernelTuning tuning = default_tuning("generic");
+    tuning.params[kernel] = params;
+    const TunedKernelTable table = select_tuned_kernels(tuning);
+    const size_t prefetch = params.prefetch_bytes;
+    BenchmarkData* s = &data;
+    
+    // Traffic and FLOP counts are unused: candidates are compared by time alone
+    BenchmarkKernel entry{tuned_kernel_name(kernel), 0.0, 0.0, 0.0, nullptr};
+    switch (kernel) {
+    case TUNED_CROSS_CORRELATION:
+        entry.run = [s, table, prefetch](size_t n) {
+            bench_sink_float = table.cross_correlation(s->a.data(), s->b.data(), n, prefetch);
+        };
+        break;
+    case TUNED_WEIGHTED_AVERAGE:
+        entry.run = [s, table, prefetch](size_t n) {
+            float weighted_sum, weight_sum;
+            table.weighted_sums(s->a.data(), s->b.data(), n, weighted_sum, weight_sum, prefetch);
+            bench_sink_float = weighted_sum + weight_sum;
+        };
+        break;
+    case TUNED_SPEED:
+        entry.run = [s, table, prefetch](size_t n) {
+            table.speed(s->a.data(), s->c.data(), s->out.data(), n, 0.1f, prefetch);
+        };
+        break;
+    default:
+        entry.run = [s, table, prefetch](size_t n) {
+            table.threshold_detection(s->a.data(), s->detections.data(), n, 50.0f, prefetch);
+        };
+        break;
+    }
+    return entry;
+}
+
+/**
+ * @brief Measure every shape and prefetch distance of every tuned kernel on this core
+ */
+inline AutotuneResult run_autotune(const AutotuneConfig& config) {
+    BenchmarkConfig bench;
+    bench.warmup_trials = config.warmup_trials;
+    bench.trials = config.trials;
+    
+    const BenchmarkSize compute_size = {"shape", config.compute_elements};
+    const BenchmarkSize memory_size = {"prefetch", config.memory_elements};
+    BenchmarkData data(std::max(config.compute_elements, config.memory_elements), config.seed);
+    
+    AutotuneResult result;
+    result.tuning = default_tuning(detect_core_name());
+    result.tuning.source = "autotune";
+    
+    // Best candidate of one stage; the earlier (simpler) one wins unless clearly beaten
+    auto search = [&](TunedKernel kernel, const std::vector<TuningParams>& candidates, const BenchmarkSize& size) {
+        const size_t first = result.candidates.size();
+        size_t best = first;
+        for (const TuningParams& params : candidates) {
+            const double ns = run_benchmark(autotune_kernel(kernel, params, data), size, bench).ns_per_element_p50;
+            result.candidates.push_back({kernel, size.tier, params, ns, false});
+            if (ns < result.candidates[best].ns_per_element * (1.0 - AUTOTUNE_MIN_GAIN)) best = result.candidates.size() - 1;
+        }
+        result.candidates[best].selected = true;
+        return result.candidates[best].params;
+    };
+    
+    for (int k = 0; k < TUNED_KERNEL_COUNT; ++k) {
+        const TunedKernel kernel = static_cast<TunedKernel>(k);
+        const TuningParams shape = search(kernel, tuning_shapes(kernel), compute_size);
+        
+        std::vector<TuningParams> distances;
+        for (size_t bytes : config.prefetch_distances) distances.push_back({shape.accumulators, shape.unroll, bytes});
+        result.tuning.params[k] = search(kernel, distances, memory_size);
+    }
+    return result;
+}
+
+/**
+ * @brief Print every candidate, marking the winner of each stage with '*'
+ */
+inline void print_autotune_table(std::ostream& out, const AutotuneResult& result) {
+    out << std::left << std::setw(22) << "kernel" << std::setw(10) << "stage" << std::right
+        << std::setw(6) << "acc" << std::setw(8) << "unroll" << std::setw(10) << "prefetch"
+        << std::setw(10) << "ns/el" << "\n";
+    
+    for (const AutotuneCandidate& c : result.candidates) {
+        out << std::left << std::setw(22) << tuned_kernel_name(c.kernel) << std::setw(10) << c.stage << std::right
+            << std::setw(6) << c.params.accumulators << std::setw(8) << c.params.unroll
+            << std::setw(10) << c.params.prefetch_bytes << std::fixed << std::setprecision(3)
+            << std::setw(10) << c.ns_per_element << (c.selected ? " *" : "") << "\n";
+    }
+}
+
+#endif // AUTOTUNE_H
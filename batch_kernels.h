@@ -0,0 +1,314 @@
+#ifndef BATCH_KERNELS_H
+#define BATCH_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "simd.h"
+#include "simd_tail.h"
+
+/*
+ * Ragged batch versions of the reductions in obj_detection_util.h.
+ *
+ * Many short arrays (one per track) are concatenated into one buffer and
+ * described CSR-style: segment s covers [offsets[s], offsets[s + 1]), so
+ * offsets has num_segments + 1 entries. One call processes every segment,
+ * which removes the per-call setup, and four segments are reduced together:
+ * their accumulators are folded with two pairwise adds into a single vector
+ * holding one result per lane instead of four separate horizontal sums.
+ *
+ * Segment tails are read as a full vector with the out-of-segment lanes
+ * masked off. That load stays inside the concatenated buffer for every
+ * segment but the last, whose tail is staged through simd_tail::Partial.
+ */
+
+/**
+ * @brief Fold four per-segment accumulators into one vector of totals
+ * @return {sum(a0), sum(a1), sum(a2), sum(a3)}
+ */
+inline float32x4_t reduce_4x4(float32x4_t a0, float32x4_t a1, float32x4_t a2, float32x4_t a3) {
+    return vpaddq_f32(vpaddq_f32(a0, a1), vpaddq_f32(a2, a3));
+}
+
+/**
+ * @brief Accumulate the products (and optionally the second operand) of one segment
+ * @param a First operand buffer
+ * @param b Second operand buffer
+ * @param begin First element of the segment
+ * @param end One past the last element of the segment
+ * @param buffer_end One past the last valid element of both buffers
+ * @param dot Accumulator for a[i] * b[i]
+ * @param b_sum Accumulator for b[i], or nullptr
+ */
+inline void batch_accumulate_segment(const float* a, const float* b, size_t begin, size_t end,
+                                     size_t buffer_end, float32x4_t& dot, float32x4_t* b_sum) {
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        float32x4_t va = vld1q_f32(&a[i]);
+        float32x4_t vb = vld1q_f32(&b[i]);
+        dot = vfmaq_f32(dot, va, vb);
+        if (b_sum) *b_sum = vaddq_f32(*b_sum, vb);
+    }
+    
+    if (i == end) return;
+    
+    if (i + 4 <= buffer_end) {
+        const uint32x4_t mask = simd_tail::lane_mask_first(end - i);
+        float32x4_t va = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vld1q_f32(&a[i])), mask));
+        float32x4_t vb = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vld1q_f32(&b[i])), mask));
+        dot = vfmaq_f32(dot, va, vb);
+        if (b_sum) *b_sum = vaddq_f32(*b_sum, vb);
+    } else {
+        simd_tail::Partial<float> tail_a, tail_b;
+        tail_a.load(&a[i], end - i, 0.0f);
+        tail_b.load(&b[i], end - i, 0.0f);
+        float32x4_t vb = vld1q_f32(tail_b.lanes);
+        dot = vfmaq_f32(dot, vld1q_f32(tail_a.lanes), vb);
+        if (b_sum) *b_sum = vaddq_f32(*b_sum, vb);
+    }
+}
+
+/**
+ * @brief Accumulate four segments, interleaving their common prefix for ILP
+ * @param a First operand buffer
+ * @param b Second operand buffer
+ * @param offsets CSR segment boundaries
+ * @param first Index of the first segment in the group
+ * @param active Number of real segments in the group (1 to 4), the rest are empty
+ * @param buffer_end One past the last valid element of both buffers
+ * @param dot Totals of a[i] * b[i], one segment per lane
+ * @param b_sum Totals of b[i], one segment per lane, or nullptr
+ */
+inline void batch_accumulate_group(const float* a, const float* b, const size_t* offsets,
+                                   size_t first, size_t active, size_t buffer_end,
+                                   float32x4_t& dot, float32x4_t* b_sum) {
+    size_t begin[4], end[4];
+    size_t common = SIZE_MAX;
+    for (size_t k = 0; k < 4; ++k) {
+        begin[k] = k < active ? offsets[first + k] : 0;
+        end[k] = k < active ? offsets[first + k + 1] : 0;
+        const size_t len = end[k] - begin[k];
+        if (len < common) common = len;
+    }
+    common &= ~size_t{3};
+    
+    float32x4_t acc[4], wsum[4];
+    for (size_t k = 0; k < 4; ++k) {
+        acc[k] = vdupq_n_f32(0.0f);
+        wsum[k] = vdupq_n_f32(0.0f);
+    }
+    
+    for (size_t j = 0; j < common; j += 4) {
+        for (size_t k = 0; k < 4; ++k) {
+            float32x4_t vb = vld1q_f32(&b[begin[k] + j]);
+            acc[k] = vfmaq_f32(acc[k], vld1q_f32(&a[begin[k] + j]), vb);
+            if (b_sum) wsum[k] = vaddq_f32(wsum[k], vb);
+        }
+    }
+    
+    for (size_t k = 0; k < active; ++k) {
+        batch_accumulate_segment(a, b, begin[k] + common, end[k], buffer_end,
+                                 acc[k], b_sum ? &wsum[k] : nullptr);
+    }
+    
+    dot = reduce_4x4(acc[0], acc[1], acc[2], acc[3]);
+    if (b_sum) *b_sum = reduce_4x4(wsum[0], wsum[1], wsum[2], wsum[3]);
+}
+
+/**
+ * @brief Calculate the weighted average of every segment of a ragged batch
+ * @param values Concatenated value arrays
+ * @param weights Concatenated weight arrays
+ * @param offsets Segment boundaries (num_segments + 1 entries)
+ * @param num_segments Number of segments
+ * @param results Output array, one weighted average per segment (0 if weights sum to 0)
+ */
+inline void weighted_average_batch(const float* values, const float* weights, const size_t* offsets,
+                                   size_t num_segments, float* results) {
+    const size_t buffer_end = offsets[num_segments];
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    
+    for (size_t s = 0; s < num_segments; s += 4) {
+        const size_t active = num_segments - s < 4 ? num_segments - s : 4;
+        
+        float32x4_t weighted, weight_sum;
+        batch_accumulate_group(values, weights, offsets, s, active, buffer_end, weighted, &weight_sum);
+        
+        const uint32x4_t valid = vcgtq_f32(weight_sum, zero);
+        float32x4_t avg = vbslq_f32(valid, vdivq_f32(weighted, weight_sum), zero);
+        
+        if (active == 4) {
+            vst1q_f32(&results[s], avg);
+        } else {
+            simd_tail::Partial<float> lanes;
+            vst1q_f32(lanes.lanes, avg);
+            lanes.store(&results[s], active);
+        }
+    }
+}
+
+/**
+ * @brief Calculate the cross-correlation of every segment pair of a ragged batch
+ * @param signal1 Concatenated first signals
+ * @param signal2 Concatenated second signals
+ * @param offsets Segment boundaries (num_segments + 1 entries)
+ * @param num_segments Number of segments
+ * @param results Output array, one correlation per segment
+ */
+inline void cross_correlation_batch(const float* signal1, const float* signal2, const size_t* offsets,
+                                    size_t num_segments, float* results) {
+    const size_t buffer_end = offsets[num_segments];
+    
+    for (size_t s = 0; s < num_segments; s += 4) {
+        const size_t active = num_segments - s < 4 ? num_segments - s : 4;
+        
+        float32x4_t sums;
+        batch_accumulate_group(signal1, signal2, offsets, s, active, buffer_end, sums, nullptr);
+        
+        if (active == 4) {
+            vst1q_f32(&results[s], sums);
+        } else {
+            simd_tail::Partial<float> lanes;
+            vst1q_f32(lanes.lanes, sums);
+            lanes.store(&results[s], active);
+        }
+    }
+}
+
+/**
+ * @brief Transpose four vectors in place, so that lane j of vector k becomes lane k of vector j
+ */
+inline void transpose_4x4(float32x4_t& a0, float32x4_t& a1, float32x4_t& a2, float32x4_t& a3) {
+    const float32x4_t t0 = vtrn1q_f32(a0, a1);
+    const float32x4_t t1 = vtrn2q_f32(a0, a1);
+    const float32x4_t t2 = vtrn1q_f32(a2, a3);
+    const float32x4_t t3 = vtrn2q_f32(a2, a3);
+    a0 = vcombine_f32(vget_low_f32(t0), vget_low_f32(t2));
+    a1 = vcombine_f32(vget_low_f32(t1), vget_low_f32(t3));
+    a2 = vcombine_f32(vget_high_f32(t0), vget_high_f32(t2));
+    a3 = vcombine_f32(vget_high_f32(t1), vget_high_f32(t3));
+}
+
+/**
+ * @brief Running minimum of one segment: the smallest value each lane has seen and its index
+ *
+ * Lanes that have not seen an element yet hold index UINT32_MAX, so no
+ * infinity sentinel is needed (-ffast-math assumes there are none).
+ */
+struct BatchMinLanes {
+    float32x4_t value;
+    uint32x4_t index;  // relative to the segment start
+};
+
+/**
+ * @brief Fold candidates into a running minimum, keeping the earliest index on ties
+ * @param m Running minimum
+ * @param data Candidate values
+ * @param index Candidate indices, larger than any index already in m except in unset lanes
+ * @param valid Lanes of data that hold elements of the segment
+ */
+inline void batch_min_update(BatchMinLanes& m, float32x4_t data, uint32x4_t index, uint32x4_t valid) {
+    const uint32x4_t unset = vceqq_u32(m.index, vdupq_n_u32(UINT32_MAX));
+    const uint32x4_t take = vandq_u32(valid, vorrq_u32(vcltq_f32(data, m.value), unset));
+    m.value = vbslq_f32(take, data, m.value);
+    m.index = vbslq_u32(take, index, m.index);
+}
+
+/**
+ * @brief Find the index of the minimum of every segment of a ragged batch
+ * @param values Concatenated arrays
+ * @param offsets Segment boundaries (num_segments + 1 entries)
+ * @param num_segments Number of segments
+ * @param results Output array, index of the first minimum relative to the segment start
+ *                (0 for empty segments)
+ *
+ * Like the other batch reductions, four segments are scanned together,
+ * interleaved over their common prefix. Each keeps a vector of per-lane
+ * minima and indices. A single transpose then puts lane j of every
+ * segment side by side, and three compare/select steps leave the minimum
+ * of segment k in lane k, with no horizontal reduction per segment.
+ */
+inline void min_index_batch(const float* values, const size_t* offsets,
+                            size_t num_segments, size_t* results) {
+    const size_t buffer_end = offsets[num_segments];
+    const uint32x4_t lane = {0, 1, 2, 3};
+    const uint32x4_t four = vdupq_n_u32(4);
+    const uint32x4_t every_lane = vdupq_n_u32(UINT32_MAX);
+    const uint32x4_t no_index = vdupq_n_u32(UINT32_MAX);
+    
+    for (size_t s = 0; s < num_segments; s += 4) {
+        const size_t active = num_segments - s < 4 ? num_segments - s : 4;
+        
+        size_t begin[4], end[4];
+        size_t common = SIZE_MAX;
+        for (size_t k = 0; k < 4; ++k) {
+            begin[k] = k < active ? offsets[s + k] : 0;
+            end[k] = k < active ? offsets[s + k + 1] : 0;
+            const size_t len = end[k] - begin[k];
+            if (len < common) common = len;
+        }
+        common &= ~size_t{3};
+        
+        // Common prefix: start from the first vector of each segment, then plain compares
+        BatchMinLanes m[4];
+        for (size_t k = 0; k < 4; ++k) {
+            m[k].value = common ? vld1q_f32(&values[begin[k]]) : vdupq_n_f32(0.0f);
+            m[k].index = common ? lane : no_index;
+        }
+        uint32x4_t idx = common ? vaddq_u32(lane, four) : lane;
+        for (size_t j = 4; j < common; j += 4) {
+            for (size_t k = 0; k < 4; ++k) {
+                const float32x4_t data = vld1q_f32(&values[begin[k] + j]);
+                const uint32x4_t mask = vcltq_f32(data, m[k].value);
+                m[k].value = vbslq_f32(mask, data, m[k].value);
+                m[k].index = vbslq_u32(mask, idx, m[k].index);
+            }
+            idx = vaddq_u32(idx, four);
+        }
+        
+        // The rest of each segment, with the partial last vector masked
+        for (size_t k = 0; k < active; ++k) {
+            uint32x4_t seg_idx = idx;
+            size_t i = begin[k] + common;
+            for (; i + 4 <= end[k]; i += 4) {
+                batch_min_update(m[k], vld1q_f32(&values[i]), seg_idx, every_lane);
+                seg_idx = vaddq_u32(seg_idx, four);
+            }
+            if (i == end[k]) continue;
+            
+            float32x4_t data;
+            if (i + 4 <= buffer_end) {
+                data = vld1q_f32(&values[i]);
+            } else {
+                simd_tail::Partial<float> tail;
+                tail.load(&values[i], end[k] - i, 0.0f);
+                data = vld1q_f32(tail.lanes);
+            }
+            batch_min_update(m[k], data, seg_idx, simd_tail::lane_mask_first(end[k] - i));
+        }
+        
+        // Lane j of every segment side by side, then fold the four columns into one
+        float32x4_t index_bits[4];
+        for (size_t k = 0; k < 4; ++k) index_bits[k] = vreinterpretq_f32_u32(m[k].index);
+        transpose_4x4(m[0].value, m[1].value, m[2].value, m[3].value);
+        transpose_4x4(index_bits[0], index_bits[1], index_bits[2], index_bits[3]);
+        
+        BatchMinLanes best = {m[0].value, vreinterpretq_u32_f32(index_bits[0])};
+        for (size_t j = 1; j < 4; ++j) {
+            const uint32x4_t index = vreinterpretq_u32_f32(index_bits[j]);
+            const uint32x4_t tie = vandq_u32(vceqq_f32(m[j].value, best.value), vcltq_u32(index, best.index));
+            const uint32x4_t set = vmvnq_u32(vceqq_u32(index, no_index));
+            const uint32x4_t unset = vceqq_u32(best.index, no_index);
+            const uint32x4_t take = vandq_u32(set, vorrq_u32(vorrq_u32(vcltq_f32(m[j].value, best.value), tie), unset));
+            best.value = vbslq_f32(take, m[j].value, best.value);
+            best.index = vbslq_u32(take, index, best.index);
+        }
+        
+        // Empty segments never set an index and report 0
+        uint32_t found[4];
+        vst1q_u32(found, vandq_u32(best.index, vmvnq_u32(vceqq_u32(best.index, no_index))));
+        for (size_t k = 0; k < active; ++k) results[s + k] = found[k];
+    }
+}
+
+#endif // BATCH_KERNELS_H
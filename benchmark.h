@@ -0,0 +1,483 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "simd_tail.h"
+#include "obj_detection_util.h"
+#include "cpu_dispatch.h"
+#include "tuned_kernels.h"
+#include "point_kernels.h"
+#include "perf_counters.h"
+
+/*
+ * Benchmark harness for the kernels in obj_detection_util.h.
+ *
+ * Every kernel runs at each size of a sweep chosen to sit in L1, L2, L3
+ * and DRAM. Each size gets untimed warm-up trials and then repeated timed
+ * trials. A trial repeats the call enough times to cover
+ * BENCH_TRIAL_ELEMENTS elements, so small sizes are not dominated by timer
+ * resolution. The reported statistics are percentiles of ns/element over
+ * trials, with GB/s and GFLOP/s derived from each kernel's nominal traffic
+ * and operation count per element. Inputs come from a fixed-seed generator,
+ * so runs are comparable across builds. Results can be printed as a table
+ * or written as JSON for regression tracking.
+ *
+ * Builds with BENCHMARK_MODE (make benchmark) also wrap every timed trial in
+ * hardware counters (cycles, instructions, L1D and LLC read misses, branch
+ * misses) and report cycles/element, IPC and misses/element. Where
+ * perf_event_open is unavailable only the clock_gettime timings are reported.
+ */
+
+// Elements covered by one timed trial (the call is repeated to reach it)
+constexpr size_t BENCH_TRIAL_ELEMENTS = 1 << 20;
+
+// Moving average window used by the suite
+constexpr size_t BENCH_MOVING_AVERAGE_WINDOW = 8;
+
+/**
+ * @brief One point of the size sweep
+ */
+struct BenchmarkSize {
+    const char* tier;
+    size_t elements;
+};
+
+/**
+ * @brief Default sweep: per-array footprints of 8 KB, 128 KB, 2 MB and 32 MB
+ */
+inline std::vector<BenchmarkSize> default_benchmark_sizes() {
+    return {{"L1", 2048}, {"L2", 32768}, {"L3", 524288}, {"DRAM", 8388608}};
+}
+
+struct BenchmarkConfig {
+    std::vector<BenchmarkSize> sizes = default_benchmark_sizes();
+    int warmup_trials = 3;
+    int trials = 21;
+    uint32_t seed = 42;
+    std::string filter;  // run only kernels whose name contains this
+};
+
+struct BenchmarkResult {
+    std::string kernel;
+    const char* tier;
+    size_t elements;
+    double ns_per_element_p5;
+    double ns_per_element_p50;
+    double ns_per_element_p95;
+    double gb_per_s;     // at the median
+    double gflop_per_s;  // at the median
+    
+    // Counter totals over all timed trials (BENCHMARK_MODE builds with perf access only)
+    PerfSample counters;
+    double counted_elements = 0.0;
+};
+
+/**
+ * @brief Counter value per processed element, or -1 if the event was not measured
+ */
+inline double counter_per_element(const BenchmarkResult& r, PerfEvent event) {
+    return r.counters.valid[event] && r.counted_elements > 0 ? r.counters.values[event] / r.counted_elements : -1.0;
+}
+
+/**
+ * @brief Instructions per cycle, or -1 if not measured
+ */
+inline double counter_ipc(const BenchmarkResult& r) {
+    const bool valid = r.counters.valid[PERF_EVENT_CYCLES] && r.counters.valid[PERF_EVENT_INSTRUCTIONS] &&
+                       r.counters.values[PERF_EVENT_CYCLES] > 0;
+    return valid ? static_cast<double>(r.counters.values[PERF_EVENT_INSTRUCTIONS]) / r.counters.values[PERF_EVENT_CYCLES] : -1.0;
+}
+
+/**
+ * @brief Monotonic time in nanoseconds
+ */
+inline uint64_t bench_now_ns() {
+    return PerfCounters::monotonic_ns();
+}
+
+/**
+ * @brief Linear-interpolated percentile of sorted samples
+ */
+inline double bench_percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    const double rank = p / 100.0 * (sorted.size() - 1);
+    const size_t lo = static_cast<size_t>(rank);
+    const size_t hi = lo + 1 < sorted.size() ? lo + 1 : lo;
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (rank - lo);
+}
+
+// Stores reduction results so the compiler cannot drop the calls
+inline volatile float bench_sink_float;
+inline volatile size_t bench_sink_index;
+inline volatile int64_t bench_sink_int;
+
+/**
+ * @brief A kernel under test
+ */
+struct BenchmarkKernel {
+    std::string name;
+    double bytes_per_element;  // nominal memory traffic (reads + writes)
+    double write_bytes_per_element;  // part of the traffic that is writes
+    double flops_per_element;  // nominal floating-point operations
+    std::function<void(size_t)> run;
+};
+
+// Queries per nearest_points_x8 call, read from c and d whatever the size
+constexpr size_t BENCH_NEAREST_QUERIES = 8;
+
+/**
+ * @brief Input and output buffers shared by every kernel of the suite
+ *
+ * Buffers hold at least BENCH_NEAREST_QUERIES elements, so the query
+ * arrays stay readable at sizes below the query count.
+ */
+struct BenchmarkData {
+    std::vector<float> a, b, c, d, out;
+    std::vector<int16_t> a16;
+    std::vector<int8_t> a8, b8;
+    std::vector<float16_t> a_f16;
+    std::vector<uint8_t> detections;
+    
+    BenchmarkData(size_t max_elements, uint32_t seed) : BenchmarkData(seed, std::max(max_elements, BENCH_NEAREST_QUERIES)) {}
+
+private:
+    BenchmarkData(uint32_t seed, size_t elements)
+        : a(elements), b(elements), c(elements), d(elements), out(elements),
+          a16(elements), a8(elements), b8(elements), a_f16(elements),
+          detections(elements) {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> dis(0.0f, 100.0f);
+        for (size_t i = 0; i < elements; ++i) {
+            a[i] = dis(gen);
+            b[i] = dis(gen) / 100.0f;
+            c[i] = dis(gen);
+            d[i] = dis(gen);
+            a16[i] = static_cast<int16_t>(a[i] * 300.0f - 15000.0f);
+            a8[i] = static_cast<int8_t>(a[i] * 2.5f - 125.0f);
+            b8[i] = static_cast<int8_t>(c[i] * 2.5f - 125.0f);
+            a_f16[i] = static_cast<float16_t>(a[i]);
+        }
+    }
+};
+
+/**
+ * @brief Every kernel of obj_detection_util.h, bound to the suite's buffers
+ */
+inline std::vector<BenchmarkKernel> benchmark_kernels(BenchmarkData& data) {
+    BenchmarkData* s = &data;
+    std::vector<BenchmarkKernel> kernels;
+    
+    // SoA distances over all n points: the last count % 4 are an overlapping vector, or staged when n < 4
+    kernels.push_back({"vector_distance_squared", 20.0, 4.0, 5.0, [s](size_t n) {
+        auto distances = [](const float* x1, const float* y1, const float* x2, const float* y2, size_t i) {
+            return vector_distance_squared(vld1q_f32(&x1[i]), vld1q_f32(&y1[i]), vld1q_f32(&x2[i]), vld1q_f32(&y2[i]));
+        };
+        if (n < 4) {
+            simd_tail::Partial<float> x1, y1, x2, y2, result;
+            x1.load(s->a.data(), n, 0.0f);
+            y1.load(s->b.data(), n, 0.0f);
+            x2.load(s->c.data(), n, 0.0f);
+            y2.load(s->d.data(), n, 0.0f);
+            vst1q_f32(result.lanes, distances(x1.lanes, y1.lanes, x2.lanes, y2.lanes, 0));
+            result.store(s->out.data(), n);
+            return;
+        }
+        for (size_t i = 0; i + 4 <= n; i += 4) {
+            vst1q_f32(&s->out[i], distances(s->a.data(), s->b.data(), s->c.data(), s->d.data(), i));
+        }
+        if (n & 3) vst1q_f32(&s->out[n - 4], distances(s->a.data(), s->b.data(), s->c.data(), s->d.data(), n - 4));
+    }});
+    kernels.push_back({"weighted_average", 8.0, 0.0, 3.0, [s](size_t n) {
+        bench_sink_float = weighted_average(s->a.data(), s->b.data(), n);
+    }});
+    kernels.push_back({"cumulative_sum", 8.0, 4.0, 1.0, [s](size_t n) {
+        cumulative_sum(s->a.data(), s->out.data(), n);
+    }});
+    kernels.push_back({"speed", 12.0, 4.0, 2.0, [s](size_t n) {
+        speed(s->a.data(), s->c.data(), s->out.data(), n, 0.1f);
+    }});
+    kernels.push_back({"moving_average_filter", 8.0, 4.0, BENCH_MOVING_AVERAGE_WINDOW + 1.0, [s](size_t n) {
+        moving_average_filter(s->a.data(), s->out.data(), n, BENCH_MOVING_AVERAGE_WINDOW);
+    }});
+    kernels.push_back({"min_index", 4.0, 0.0, 1.0, [s](size_t n) {
+        bench_sink_index = min_index(s->a.data(), n);
+    }});
+    kernels.push_back({"min_index_s16", 2.0, 0.0, 0.0, [s](size_t n) {
+        bench_sink_index = min_index(s->a16.data(), n);
+    }});
+    kernels.push_back({"cross_correlation", 8.0, 0.0, 2.0, [s](size_t n) {
+        bench_sink_float = cross_correlation(s->a.data(), s->b.data(), n);
+    }});
+    kernels.push_back({"exp_moving_average", 8.0, 4.0, 3.0, [s](size_t n) {
+        exp_moving_average(s->a.data(), s->out.data(), n, 0.3f);
+    }});
+    kernels.push_back({"threshold_detection", 5.0, 1.0, 1.0, [s](size_t n) {
+        threshold_detection(s->a.data(), s->detections.data(), n, 50.0f);
+    }});
+    kernels.push_back({"threshold_detection_s16", 3.0, 1.0, 0.0, [s](size_t n) {
+        threshold_detection(s->a16.data(), s->detections.data(), n, int16_t{0});
+    }});
+    
+    // Multi-versioned kernels run the variant cpu_dispatch.h selected for this CPU
+    kernels.push_back({"dot_product_q7", 2.0, 0.0, 0.0, [s](size_t n) {
+        bench_sink_int = dispatch::dot_product_q7(s->a8.data(), s->b8.data(), n);
+    }});
+    kernels.push_back({"threshold_detection_f16", 3.0, 1.0, 1.0, [s](size_t n) {
+        dispatch::threshold_detection(s->a_f16.data(), s->detections.data(), n, 50.0f);
+    }});
+    
+    // Loop shapes tuned for this core (tuned_kernels.h)
+    kernels.push_back({"cross_correlation_tuned", 8.0, 0.0, 2.0, [s](size_t n) {
+        bench_sink_float = tuned::cross_correlation(s->a.data(), s->b.data(), n);
+    }});
+    kernels.push_back({"weighted_average_tuned", 8.0, 0.0, 3.0, [s](size_t n) {
+        bench_sink_float = tuned::weighted_average(s->a.data(), s->b.data(), n);
+    }});
+    kernels.push_back({"speed_tuned", 12.0, 4.0, 2.0, [s](size_t n) {
+        tuned::speed(s->a.data(), s->c.data(), s->out.data(), n, 0.1f);
+    }});
+    kernels.push_back({"threshold_detection_tuned", 5.0, 1.0, 1.0, [s](size_t n) {
+        tuned::threshold_detection(s->a.data(), s->detections.data(), n, 50.0f);
+    }});
+    
+    // Nearest point to one track and to eight, without a distance array (point_kernels.h)
+    kernels.push_back({"nearest_point", 8.0, 0.0, 5.0, [s](size_t n) {
+        bench_sink_index = nearest_point(s->a.data(), s->b.data(), n, 50.0f, 0.5f).index;
+    }});
+    kernels.push_back({"nearest_points_x8", 8.0, 0.0, 40.0, [s](size_t n) {
+        NearestPoint nearest[BENCH_NEAREST_QUERIES];
+        nearest_points(s->a.data(), s->b.data(), n, s->c.data(), s->d.data(), BENCH_NEAREST_QUERIES, nearest);
+        bench_sink_index = nearest[BENCH_NEAREST_QUERIES - 1].index;
+    }});
+    
+    return kernels;
+}
+
+/**
+ * @brief Time one kernel at one size
+ * @param counters Hardware counters to read around each trial, or nullptr for timing only
+ */
+inline BenchmarkResult run_benchmark(const BenchmarkKernel& kernel, const BenchmarkSize& size,
+                                     const BenchmarkConfig& config, PerfCounters* counters = nullptr) {
+    const size_t n = size.elements;
+    const size_t reps = n >= BENCH_TRIAL_ELEMENTS ? 1 : BENCH_TRIAL_ELEMENTS / n;
+    
+    for (int t = 0; t < config.warmup_trials; ++t) {
+        for (size_t r = 0; r < reps; ++r) kernel.run(n);
+    }
+    
+    BenchmarkResult result;
+    std::vector<double> ns_per_element;
+    ns_per_element.reserve(config.trials);
+    for (int t = 0; t < config.trials; ++t) {
+        uint64_t elapsed_ns;
+        if (counters) {
+            counters->start();
+            for (size_t r = 0; r < reps; ++r) kernel.run(n);
+            PerfSample sample = counters->stop();
+            
+            elapsed_ns = sample.wall_ns;
+            for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+                result.counters.values[e] += sample.values[e];
+                result.counters.valid[e] = sample.valid[e];
+            }
+            result.counters.wall_ns += sample.wall_ns;
+            result.counted_elements += static_cast<double>(reps) * n;
+        } else {
+            const uint64_t start = bench_now_ns();
+            for (size_t r = 0; r < reps; ++r) kernel.run(n);
+            elapsed_ns = bench_now_ns() - start;
+        }
+        ns_per_element.push_back(static_cast<double>(elapsed_ns) / (static_cast<double>(reps) * n));
+    }
+    std::sort(ns_per_element.begin(), ns_per_element.end());
+    
+    result.kernel = kernel.name;
+    result.tier = size.tier;
+    result.elements = n;
+    result.ns_per_element_p5 = bench_percentile(ns_per_element, 5.0);
+    result.ns_per_element_p50 = bench_percentile(ns_per_element, 50.0);
+    result.ns_per_element_p95 = bench_percentile(ns_per_element, 95.0);
+    result.gb_per_s = kernel.bytes_per_element / result.ns_per_element_p50;
+    result.gflop_per_s = kernel.flops_per_element / result.ns_per_element_p50;
+    return result;
+}
+
+/**
+ * @brief Run the whole sweep
+ */
+inline std::vector<BenchmarkResult> run_benchmarks(const BenchmarkConfig& config) {
+    size_t max_elements = 0;
+    for (const BenchmarkSize& size : config.sizes) max_elements = std::max(max_elements, size.elements);
+    
+    PerfCounters* counters = nullptr;
+#ifdef BENCHMARK_MODE
+    PerfCounters perf;
+    if (perf.available()) counters = &perf;
+#endif
+    
+    BenchmarkData data(max_elements, config.seed);
+    std::vector<BenchmarkResult> results;
+    for (const BenchmarkKernel& kernel : benchmark_kernels(data)) {
+        if (!config.filter.empty() && kernel.name.find(config.filter) == std::string::npos) continue;
+        for (const BenchmarkSize& size : config.sizes) {
+            results.push_back(run_benchmark(kernel, size, config, counters));
+        }
+    }
+    return results;
+}
+
+/**
+ * @brief Print results as an aligned table
+ */
+inline void print_benchmark_table(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+    out << std::left << std::setw(26) << "kernel" << std::setw(6) << "tier" << std::right
+        << std::setw(10) << "elements" << std::setw(10) << "ns/el p5" << std::setw(10) << "p50"
+        << std::setw(10) << "p95" << std::setw(9) << "GB/s" << std::setw(9) << "GFLOP/s" << "\n";
+    
+    for (const BenchmarkResult& r : results) {
+        out << std::left << std::setw(26) << r.kernel << std::setw(6) << r.tier << std::right
+            << std::setw(10) << r.elements << std::fixed << std::setprecision(3)
+            << std::setw(10) << r.ns_per_element_p5 << std::setw(10) << r.ns_per_element_p50
+            << std::setw(10) << r.ns_per_element_p95 << std::setprecision(2)
+            << std::setw(9) << r.gb_per_s << std::setw(9) << r.gflop_per_s << "\n";
+    }
+    
+    bool any_counters = false;
+    for (const BenchmarkResult& r : results) any_counters = any_counters || r.counted_elements > 0;
+    if (!any_counters) return;
+    
+    out << "\n" << std::left << std::setw(26) << "kernel" << std::setw(6) << "tier" << std::right
+        << std::setw(10) << "elements" << std::setw(10) << "cyc/el" << std::setw(8) << "IPC"
+        << std::setw(12) << "L1D miss/el" << std::setw(12) << "LLC miss/el" << std::setw(12) << "br miss/el" << "\n";
+    
+    // Events the PMU could not count print as "-"
+    auto field = [&out](double value, int width, int precision) {
+        if (value < 0.0) {
+            out << std::setw(width) << "-";
+        } else {
+            out << std::setw(width) << std::fixed << std::setprecision(precision) << value;
+        }
+    };
+    
+    for (const BenchmarkResult& r : results) {
+        out << std::left << std::setw(26) << r.kernel << std::setw(6) << r.tier << std::right
+            << std::setw(10) << r.elements;
+        field(counter_per_element(r, PERF_EVENT_CYCLES), 10, 3);
+        field(counter_ipc(r), 8, 2);
+        field(counter_per_element(r, PERF_EVENT_L1D_MISSES), 12, 4);
+        field(counter_per_element(r, PERF_EVENT_LLC_MISSES), 12, 4);
+        field(counter_per_element(r, PERF_EVENT_BRANCH_MISSES), 12, 4);
+        out << "\n";
+    }
+}
+
+/**
+ * @brief Description of the build, recorded with JSON results
+ */
+inline std::string benchmark_target() {
+    std::string target;
+#if defined(__aarch64__)
+    target = "aarch64";
+#elif defined(__arm__)
+    target = "arm";
+#elif defined(__x86_64__)
+    target = "x86_64";
+#else
+    target = "unknown";
+#endif
+#if defined(__ARM_FEATURE_DOTPROD)
+    target += "+dotprod";
+#endif
+#if defined(__ARM_FEATURE_FP16_VECTOR_ARITHMETIC)
+    target += "+fp16";
+#endif
+#if defined(__AVX2__)
+    target += "+avx2";
+#elif defined(__SSE4_1__)
+    target += "+sse4.1";
+#endif
+#if defined(__FMA__)
+    target += "+fma";
+#endif
+    target += " simd=" SIMD_BACKEND;
+#if defined(__FAST_MATH__)
+    target += " fast-math";
+#endif
+    return target;
+}
+
+/**
+ * @brief Write the run parameters and results as members of a JSON object (no braces)
+ */
+inline void write_benchmark_json_fields(std::ostream& out, const std::vector<BenchmarkResult>& results,
+                                        const BenchmarkConfig& config) {
+    out << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+    out << "  \"target\": \"" << benchmark_target() << "\",\n";
+    out << "  \"dispatch\": \"" << describe_dispatch(dispatch_table) << "\",\n";
+    out << "  \"tuning\": \"" << tuned_table.tuning.core << ": " << describe_tuning(tuned_table.tuning) << "\",\n";
+    out << "  \"seed\": " << config.seed << ",\n";
+    out << "  \"warmup_trials\": " << config.warmup_trials << ",\n";
+    out << "  \"trials\": " << config.trials << ",\n";
+    out << "  \"results\": [\n";
+    
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        out << std::setprecision(6) << std::defaultfloat
+            << "    {\"kernel\": \"" << r.kernel << "\", \"tier\": \"" << r.tier
+            << "\", \"elements\": " << r.elements
+            << ", \"ns_per_element_p5\": " << r.ns_per_element_p5
+            << ", \"ns_per_element_p50\": " << r.ns_per_element_p50
+            << ", \"ns_per_element_p95\": " << r.ns_per_element_p95
+            << ", \"gb_per_s\": " << r.gb_per_s
+            << ", \"gflop_per_s\": " << r.gflop_per_s;
+        
+        if (r.counted_elements > 0) {
+            const char* names[PERF_EVENT_COUNT] = {"cycles_per_element", "instructions_per_element",
+                                                   "l1d_misses_per_element", "llc_misses_per_element",
+                                                   "branch_misses_per_element"};
+            for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+                const double value = counter_per_element(r, static_cast<PerfEvent>(e));
+                out << ", \"" << names[e] << "\": ";
+                if (value < 0.0) {
+                    out << "null";
+                } else {
+                    out << value;
+                }
+            }
+            const double ipc = counter_ipc(r);
+            out << ", \"ipc\": ";
+            if (ipc < 0.0) {
+                out << "null";
+            } else {
+                out << ipc;
+            }
+        }
+        out << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    
+    out << "  ]";
+}
+
+/**
+ * @brief Write results and run parameters as JSON
+ */
+inline void write_benchmark_json(std::ostream& out, const std::vector<BenchmarkResult>& results,
+                                 const BenchmarkConfig& config) {
+    out << "{\n";
+    write_benchmark_json_fields(out, results, config);
+    out << "\n}\n";
+}
+
+#endif // BENCHMARK_H
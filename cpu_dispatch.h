@@ -0,0 +1,298 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#elif defined(__aarch64__) && defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+#include "simd.h"
+#include "obj_detection_util.h"
+#include "fixed_point_util.h"
+
+/*
+ * Runtime selection of kernel variants, so one binary built for the
+ * baseline (-march=armv8-a+simd) runs at full speed on every node.
+ *
+ * Kernels that gain from an optional extension are compiled a second time
+ * with a per-function target attribute:
+ *
+ *  - dotprod (Armv8.2 SDOT, Cortex-A55/A76 and later): dot_product_q7
+ *  - fp16 vector arithmetic (Cortex-A55/A75 and later): threshold_detection
+ *    on half-precision samples, compared natively sixteen at a time
+ *
+ * At startup detect_cpu_features() reads HWCAP (Linux), sysctl (macOS) or
+ * cpuid (x86), and dispatch_table is filled once with the best variant the
+ * CPU supports. The dispatch:: functions then cost one indirect call, with
+ * no feature checks per call. x86 hosts record their features but always
+ * run the baseline, since they only execute the portable build.
+ *
+ * dispatch_table is initialized before main(); do not call the dispatch::
+ * functions from other static initializers.
+ */
+
+#if defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define CPU_DISPATCH_VARIANTS 1
+#define CPU_DISPATCH_TARGET_DOTPROD __attribute__((target("arch=armv8.2-a+dotprod")))
+#define CPU_DISPATCH_TARGET_FP16 __attribute__((target("arch=armv8.2-a+fp16")))
+#else
+#define CPU_DISPATCH_VARIANTS 0
+#endif
+
+/**
+ * @brief Instruction set extensions the kernels can use
+ */
+struct CpuFeatures {
+    bool neon = false;
+    bool dotprod = false;  // SDOT/UDOT
+    bool fp16 = false;     // half-precision vector arithmetic
+    bool sse42 = false;
+    bool avx2 = false;
+    bool fma = false;
+};
+
+/**
+ * @brief Query the running CPU for the extensions the kernels use
+ */
+inline CpuFeatures detect_cpu_features() {
+    CpuFeatures features;
+#if defined(__aarch64__) && defined(__linux__)
+    // Bit positions from <asm/hwcap.h>, spelled out for older headers
+    constexpr unsigned long hwcap_asimd = 1UL << 1;
+    constexpr unsigned long hwcap_fphp = 1UL << 9;
+    constexpr unsigned long hwcap_asimdhp = 1UL << 10;
+    constexpr unsigned long hwcap_asimddp = 1UL << 20;
+    
+    const unsigned long hwcap = getauxval(AT_HWCAP);
+    features.neon = (hwcap & hwcap_asimd) != 0;
+    features.dotprod = (hwcap & hwcap_asimddp) != 0;
+    features.fp16 = (hwcap & hwcap_fphp) != 0 && (hwcap & hwcap_asimdhp) != 0;
+#elif defined(__aarch64__) && defined(__APPLE__)
+    auto sysctl_flag = [](const char* name) {
+        int value = 0;
+        size_t size = sizeof(value);
+        return sysctlbyname(name, &value, &size, nullptr, 0) == 0 && value != 0;
+    };
+    features.neon = true;
+    features.dotprod = sysctl_flag("hw.optional.arm.FEAT_DotProd");
+    features.fp16 = sysctl_flag("hw.optional.arm.FEAT_FP16");
+#elif defined(__aarch64__)
+    // No runtime query available: trust the compile-time target
+    features.neon = true;
+#if defined(__ARM_FEATURE_DOTPROD)
+    features.dotprod = true;
+#endif
+#if defined(__ARM_FEATURE_FP16_VECTOR_ARITHMETIC)
+    features.fp16 = true;
+#endif
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    features.sse42 = __builtin_cpu_supports("sse4.2");
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.fma = __builtin_cpu_supports("fma");
+#elif defined(__ARM_NEON)
+    features.neon = true;
+#endif
+    return features;
+}
+
+/**
+ * @brief Comma-separated list of the detected features, for logs and reports
+ */
+inline std::string describe_cpu_features(const CpuFeatures& features) {
+    std::string text;
+    auto add = [&](bool present, const char* name) {
+        if (!present) return;
+        if (!text.empty()) text += ",";
+        text += name;
+    };
+    add(features.neon, "neon");
+    add(features.dotprod, "dotprod");
+    add(features.fp16, "fp16");
+    add(features.sse42, "sse4.2");
+    add(features.avx2, "avx2");
+    add(features.fma, "fma");
+    return text.empty() ? "none" : text;
+}
+
+/**
+ * @brief The largest half-precision value h with (x > h) == (x > threshold) for every half x
+ *
+ * Rounds the threshold toward negative infinity, so comparing in fp16 gives
+ * exactly the single-precision result.
+ */
+inline float16_t half_threshold_below(float threshold) {
+    float16_t half = static_cast<float16_t>(threshold);
+    if (static_cast<float>(half) > threshold) {
+        uint16_t bits;
+        std::memcpy(&bits, &half, sizeof(bits));
+        if ((bits & 0x7fff) == 0) {
+            bits = 0x8001;  // smallest negative subnormal
+        } else if (bits & 0x8000) {
+            bits += 1;
+        } else {
+            bits -= 1;
+        }
+        std::memcpy(&half, &bits, sizeof(half));
+    }
+    return half;
+}
+
+#if CPU_DISPATCH_VARIANTS
+
+/**
+ * @brief dot_product_q7() using SDOT, four products per lane per instruction
+ */
+CPU_DISPATCH_TARGET_DOTPROD
+inline int64_t dot_product_q7_dotprod(const int8_t* a, const int8_t* b, size_t count) {
+    // Each 32-bit lane gains at most 4 * 2^14 per SDOT; flush to 64 bits every 2^14 vectors
+    const size_t block_size = 16 * 16384;
+    
+    int64x2_t acc64 = vdupq_n_s64(0);
+    const size_t simd_count = count & ~15;
+    
+    for (size_t block = 0; block < simd_count; block += block_size) {
+        const size_t block_end = block + block_size < simd_count ? block + block_size : simd_count;
+        int32x4_t acc0 = vdupq_n_s32(0);
+        int32x4_t acc1 = vdupq_n_s32(0);
+        
+        size_t i = block;
+        for (; i + 32 <= block_end; i += 32) {
+            acc0 = vdotq_s32(acc0, vld1q_s8(&a[i]), vld1q_s8(&b[i]));
+            acc1 = vdotq_s32(acc1, vld1q_s8(&a[i + 16]), vld1q_s8(&b[i + 16]));
+        }
+        if (i < block_end) {
+            acc0 = vdotq_s32(acc0, vld1q_s8(&a[i]), vld1q_s8(&b[i]));
+        }
+        
+        acc64 = vpadalq_s32(acc64, acc0);
+        acc64 = vpadalq_s32(acc64, acc1);
+    }
+    
+    // Overlapping last vector with the lanes already accumulated zeroed
+    if (simd_count < count) {
+        int8x16_t va = simd_tail::load_tail_zeroed(a, count);
+        int8x16_t vb = simd_tail::load_tail_zeroed(b, count);
+        acc64 = vpadalq_s32(acc64, vdotq_s32(vdupq_n_s32(0), va, vb));
+    }
+    
+    return vaddvq_s64(acc64);
+}
+
+/**
+ * @brief threshold_detection() on half-precision data, compared in fp16 arithmetic
+ */
+CPU_DISPATCH_TARGET_FP16
+inline void threshold_detection_fp16(const float16_t* sensor_data, uint8_t* detections,
+                                     size_t count, float threshold) {
+    const float16x8_t thresh_vec = vdupq_n_f16(half_threshold_below(threshold));
+    const uint8x16_t one = vdupq_n_u8(1);
+    
+    if (count < 16) {
+        simd_tail::Partial<float16_t, 16> data;
+        simd_tail::Partial<uint8_t> result;
+        data.load(sensor_data, count, 0);
+        const uint8x16_t above = vcombine_u8(vmovn_u16(vcgtq_f16(vld1q_f16(data.lanes), thresh_vec)),
+                                             vmovn_u16(vcgtq_f16(vld1q_f16(data.lanes + 8), thresh_vec)));
+        vst1q_u8(result.lanes, vandq_u8(above, one));
+        result.store(detections, count);
+        return;
+    }
+    
+    // Last 16 detections, stored over the overlap at the end
+    const float16_t* last = &sensor_data[count - 16];
+    const uint8x16_t tail = vandq_u8(vcombine_u8(vmovn_u16(vcgtq_f16(vld1q_f16(last), thresh_vec)),
+                                                 vmovn_u16(vcgtq_f16(vld1q_f16(last + 8), thresh_vec))), one);
+    
+    const size_t simd_count = count & ~15;
+    for (size_t i = 0; i < simd_count; i += 16) {
+        const uint8x16_t above = vcombine_u8(vmovn_u16(vcgtq_f16(vld1q_f16(&sensor_data[i]), thresh_vec)),
+                                             vmovn_u16(vcgtq_f16(vld1q_f16(&sensor_data[i + 8]), thresh_vec)));
+        vst1q_u8(&detections[i], vandq_u8(above, one));
+    }
+    
+    vst1q_u8(&detections[count - 16], tail);
+}
+
+#endif // CPU_DISPATCH_VARIANTS
+
+/**
+ * @brief Kernel entry points selected for one CPU, with the name of each choice
+ */
+struct KernelTable {
+    int64_t (*dot_product_q7)(const int8_t*, const int8_t*, size_t);
+    void (*threshold_detection_f16)(const float16_t*, uint8_t*, size_t, float);
+    const char* dot_product_q7_variant;
+    const char* threshold_detection_f16_variant;
+};
+
+/**
+ * @brief Best variant of every dispatched kernel for the given features
+ */
+inline KernelTable select_kernels(const CpuFeatures& features) {
+    KernelTable table;
+    table.dot_product_q7 = &::dot_product_q7;
+    table.threshold_detection_f16 = static_cast<void (*)(const float16_t*, uint8_t*, size_t, float)>(&::threshold_detection);
+    table.dot_product_q7_variant = "baseline";
+    table.threshold_detection_f16_variant = "baseline";
+
+#if CPU_DISPATCH_VARIANTS
+    if (features.dotprod) {
+        table.dot_product_q7 = &dot_product_q7_dotprod;
+        table.dot_product_q7_variant = "dotprod";
+    }
+    if (features.fp16) {
+        table.threshold_detection_f16 = &threshold_detection_fp16;
+        table.threshold_detection_f16_variant = "fp16";
+    }
+#else
+    (void)features;
+#endif
+    return table;
+}
+
+/**
+ * @brief Features of the CPU this process runs on, detected once
+ */
+inline const CpuFeatures& cpu_features() {
+    static const CpuFeatures features = detect_cpu_features();
+    return features;
+}
+
+/**
+ * @brief Kernel and selected variant pairs, e.g. "dot_product_q7=dotprod,threshold_detection_f16=fp16"
+ */
+inline std::string describe_dispatch(const KernelTable& table) {
+    return std::string("dot_product_q7=") + table.dot_product_q7_variant
+         + ",threshold_detection_f16=" + table.threshold_detection_f16_variant;
+}
+
+// Filled once, before main(), with the variants for this CPU
+inline const KernelTable dispatch_table = select_kernels(cpu_features());
+
+namespace dispatch {
+
+/**
+ * @brief dot_product_q7() through the variant selected for this CPU
+ */
+inline int64_t dot_product_q7(const int8_t* a, const int8_t* b, size_t count) {
+    return dispatch_table.dot_product_q7(a, b, count);
+}
+
+/**
+ * @brief threshold_detection() on half-precision data through the variant selected for this CPU
+ */
+inline void threshold_detection(const float16_t* sensor_data, uint8_t* detections,
+                                size_t count, float threshold) {
+    dispatch_table.threshold_detection_f16(sensor_data, detections, count, threshold);
+}
+
+} // namespace dispatch
+
+#endif // CPU_DISPATCH_H
@@ -0,0 +1,333 @@
+#ifndef FIXED_POINT_UTIL_H
+#define FIXED_POINT_UTIL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "simd.h"
+#include "obj_detection_util.h"
+
+/*
+ * Fixed-point (Q15 / Q7) variants of the kernels in obj_detection_util.h.
+ *
+ * Q15 values are int16_t in [-1, 1) scaled by 2^15, Q7 values are int8_t
+ * scaled by 2^7. Raw integer ADC samples can be passed directly; the Q
+ * format only matters where a result is rescaled (averages, FIR output).
+ * Products are widened before accumulation so intermediate sums cannot
+ * wrap, and narrowing back to 16 bits saturates.
+ *
+ * Comparisons and reductions that need no rescaling (threshold_detection,
+ * min_index) are plain integer overloads in obj_detection_util.h.
+ */
+
+/**
+ * @brief Inclusive prefix sum of the four lanes of an int32 vector
+ * @param v Input lanes {a, b, c, d}
+ * @return {a, a+b, a+b+c, a+b+c+d}
+ */
+inline int32x4_t prefix_sum_s32x4(int32x4_t v) {
+    const int32x4_t zero = vdupq_n_s32(0);
+    v = vaddq_s32(v, vextq_s32(zero, v, 3));
+    v = vaddq_s32(v, vextq_s32(zero, v, 2));
+    return v;
+}
+
+/**
+ * @brief Dot product of two Q15 arrays
+ * @param a First Q15 array
+ * @param b Second Q15 array
+ * @param count Number of elements in both arrays
+ * @return Exact sum of products in Q30 (multiply by 2^-30 for the real value)
+ */
+inline int64_t dot_product_q15(const int16_t* a, const int16_t* b, size_t count) {
+    int64x2_t acc_lo = vdupq_n_s64(0);
+    int64x2_t acc_hi = vdupq_n_s64(0);
+    
+    const size_t simd_count = count & ~7;
+    
+    for (size_t i = 0; i < simd_count; i += 8) {
+        int16x8_t va = vld1q_s16(&a[i]);
+        int16x8_t vb = vld1q_s16(&b[i]);
+        
+        // Q15 x Q15 products need 31 bits, so pairwise-accumulate them into 64-bit lanes
+        acc_lo = vpadalq_s32(acc_lo, vmull_s16(vget_low_s16(va), vget_low_s16(vb)));
+        acc_hi = vpadalq_s32(acc_hi, vmull_high_s16(va, vb));
+    }
+    
+    // Overlapping last vector with the lanes already accumulated zeroed
+    if (simd_count < count) {
+        int16x8_t va = simd_tail::load_tail_zeroed(a, count);
+        int16x8_t vb = simd_tail::load_tail_zeroed(b, count);
+        
+        acc_lo = vpadalq_s32(acc_lo, vmull_s16(vget_low_s16(va), vget_low_s16(vb)));
+        acc_hi = vpadalq_s32(acc_hi, vmull_high_s16(va, vb));
+    }
+    
+    return vaddvq_s64(vaddq_s64(acc_lo, acc_hi));
+}
+
+/**
+ * @brief Dot product of two Q7 arrays
+ * @param a First Q7 array
+ * @param b Second Q7 array
+ * @param count Number of elements in both arrays
+ * @return Exact sum of products in Q14 (multiply by 2^-14 for the real value)
+ */
+inline int64_t dot_product_q7(const int8_t* a, const int8_t* b, size_t count) {
+    // Each 32-bit lane absorbs 4 products of at most 2^14 per iteration; flush to 64 bits
+    // well before 2^31 is reachable
+    const size_t block_size = 16 * 16384;
+    
+    int64x2_t acc64 = vdupq_n_s64(0);
+    const size_t simd_count = count & ~15;
+    
+    for (size_t block = 0; block < simd_count; block += block_size) {
+        const size_t block_end = block + block_size < simd_count ? block + block_size : simd_count;
+        int32x4_t acc32 = vdupq_n_s32(0);
+        
+        for (size_t i = block; i < block_end; i += 16) {
+            int8x16_t va = vld1q_s8(&a[i]);
+            int8x16_t vb = vld1q_s8(&b[i]);
+            
+            acc32 = vpadalq_s16(acc32, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+            acc32 = vpadalq_s16(acc32, vmull_high_s8(va, vb));
+        }
+        
+        acc64 = vpadalq_s32(acc64, acc32);
+    }
+    
+    // Overlapping last vector with the lanes already accumulated zeroed
+    if (simd_count < count) {
+        int8x16_t va = simd_tail::load_tail_zeroed(a, count);
+        int8x16_t vb = simd_tail::load_tail_zeroed(b, count);
+        
+        int32x4_t acc32 = vpaddlq_s16(vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+        acc32 = vpadalq_s16(acc32, vmull_high_s8(va, vb));
+        acc64 = vpadalq_s32(acc64, acc32);
+    }
+    
+    return vaddvq_s64(acc64);
+}
+
+/**
+ * @brief Compute cumulative sum of a Q15 array with 64-bit output
+ * @param input Input Q15 array
+ * @param output Output array of running sums (exact for any count)
+ * @param count Number of elements
+ */
+inline void cumulative_sum_q15(const int16_t* input, int64_t* output, size_t count) {
+    int64x2_t carry = vdupq_n_s64(0);
+    
+    // Running sums of eight samples, continuing from carry. Sums within the block
+    // fit in 32 bits; only the running total needs 64.
+    auto block = [&carry](int16x8_t data, int64_t* out) {
+        int32x4_t lo = prefix_sum_s32x4(vmovl_s16(vget_low_s16(data)));
+        int32x4_t hi = vaddq_s32(prefix_sum_s32x4(vmovl_high_s16(data)), vdupq_laneq_s32(lo, 3));
+        int64x2_t last = vaddq_s64(vmovl_high_s32(hi), carry);
+        
+        vst1q_s64(out, vaddq_s64(vmovl_s32(vget_low_s32(lo)), carry));
+        vst1q_s64(out + 2, vaddq_s64(vmovl_high_s32(lo), carry));
+        vst1q_s64(out + 4, vaddq_s64(vmovl_s32(vget_low_s32(hi)), carry));
+        vst1q_s64(out + 6, last);
+        carry = vdupq_laneq_s64(last, 1);
+    };
+    
+    const size_t simd_count = count & ~7;
+    for (size_t i = 0; i < simd_count; i += 8) {
+        block(vld1q_s16(&input[i]), &output[i]);
+    }
+    
+    // Zero-padded last block; the padding lanes are never stored
+    if (simd_count < count) {
+        simd_tail::Partial<int16_t> data;
+        simd_tail::Partial<int64_t, 8> sums;
+        data.load(&input[simd_count], count - simd_count, 0);
+        block(vld1q_s16(data.lanes), sums.lanes);
+        sums.store(&output[simd_count], count - simd_count);
+    }
+}
+
+/**
+ * @brief Compute cumulative sum of a Q7 array with 32-bit output
+ * @param input Input Q7 array
+ * @param output Output array of running sums
+ * @param count Number of elements
+ */
+inline void cumulative_sum_q7(const int8_t* input, int32_t* output, size_t count) {
+    int32x4_t carry = vdupq_n_s32(0);
+    
+    // Running sums of sixteen samples, continuing from carry
+    auto block = [&carry](int8x16_t data, int32_t* out) {
+        int16x8_t halves[2] = {vmovl_s8(vget_low_s8(data)), vmovl_high_s8(data)};
+        
+        for (int h = 0; h < 2; ++h) {
+            int32x4_t lo = vaddq_s32(prefix_sum_s32x4(vmovl_s16(vget_low_s16(halves[h]))), carry);
+            carry = vdupq_laneq_s32(lo, 3);
+            int32x4_t hi = vaddq_s32(prefix_sum_s32x4(vmovl_high_s16(halves[h])), carry);
+            carry = vdupq_laneq_s32(hi, 3);
+            
+            vst1q_s32(out + 8 * h, lo);
+            vst1q_s32(out + 8 * h + 4, hi);
+        }
+    };
+    
+    const size_t simd_count = count & ~15;
+    for (size_t i = 0; i < simd_count; i += 16) {
+        block(vld1q_s8(&input[i]), &output[i]);
+    }
+    
+    // Zero-padded last block; the padding lanes are never stored
+    if (simd_count < count) {
+        simd_tail::Partial<int8_t> data;
+        simd_tail::Partial<int32_t, 16> sums;
+        data.load(&input[simd_count], count - simd_count, 0);
+        block(vld1q_s8(data.lanes), sums.lanes);
+        sums.store(&output[simd_count], count - simd_count);
+    }
+}
+
+/**
+ * @brief Apply moving average filter to Q15 signal data
+ * @param input Input Q15 signal array
+ * @param output Filtered Q15 output array, floor((2 sum + n) / (2 n)): rounded to nearest, halves up
+ * @param count Number of elements in signal
+ * @param window_size Size of the moving average window (at most 65535)
+ *
+ * Same edge behaviour as moving_average_filter(): the first window_size - 1
+ * outputs average over the samples seen so far. The window sum is carried
+ * exactly in 32 bits and updated with x[i] - x[i - window_size].
+ *
+ * Full windows divide by multiplying with a Q31 reciprocal of window_size,
+ * which on its own can be one LSB off at exact halves and, for windows of
+ * thousands of samples, next to them. A remainder check corrects it, so
+ * every output is exactly rounded and equal windows give equal outputs.
+ */
+inline void moving_average_filter_q15(const int16_t* input, int16_t* output,
+                                      size_t count, size_t window_size) {
+    if (window_size == 0 || count == 0) return;
+    
+    // Partial windows at the start have a varying divisor, handle them scalar
+    const size_t warmup = window_size < count ? window_size : count;
+    int32_t window_sum = 0;
+    
+    for (size_t i = 0; i < warmup; ++i) {
+        window_sum += input[i];
+        // floor((2 sum + n) / (2 n)) in 64 bits, since 2 sum can exceed int32
+        const int64_t n = static_cast<int64_t>(i + 1);
+        const int64_t numerator = 2 * int64_t{window_sum} + n;
+        const int64_t quotient = numerator / (2 * n);
+        output[i] = static_cast<int16_t>(quotient - (numerator % (2 * n) < 0 ? 1 : 0));
+    }
+    
+    if (window_size == 1) {
+        for (size_t i = warmup; i < count; ++i) output[i] = input[i];
+        return;
+    }
+    
+    // sum / window_size as a rounding doubling multiply by a Q31 reciprocal, within one of the exact quotient
+    const int32x4_t recip = vdupq_n_s32(static_cast<int32_t>(((int64_t{1} << 31) + window_size / 2) / window_size));
+    const int32x4_t n = vdupq_n_s32(static_cast<int32_t>(window_size));
+    const int32x4_t two_n = vdupq_n_s32(static_cast<int32_t>(2 * window_size));
+    int32x4_t carry = vdupq_n_s32(window_sum);
+    
+    // Step q by one wherever r = 2 (sum - q n) + n falls outside [0, 2n). sum - q n is
+    // small, so it is exact even where the wrapping multiply-subtract overflows.
+    auto divide = [recip, n, two_n](int32x4_t sum) {
+        int32x4_t q = vqrdmulhq_s32(sum, recip);
+        const int32x4_t r = vaddq_s32(vshlq_n_s32(vmlsq_s32(sum, q, n), 1), n);
+        q = vaddq_s32(q, vreinterpretq_s32_u32(vcltq_s32(r, vdupq_n_s32(0))));
+        q = vsubq_s32(q, vreinterpretq_s32_u32(vcgeq_s32(r, two_n)));
+        return vqmovn_s32(q);
+    };
+    
+    // Eight window averages from the samples entering and leaving the window
+    auto block = [&carry, divide](int16x8_t enter, int16x8_t leave) {
+        int32x4_t lo = vaddq_s32(prefix_sum_s32x4(vsubl_s16(vget_low_s16(enter), vget_low_s16(leave))), carry);
+        carry = vdupq_laneq_s32(lo, 3);
+        int32x4_t hi = vaddq_s32(prefix_sum_s32x4(vsubl_high_s16(enter, leave)), carry);
+        carry = vdupq_laneq_s32(hi, 3);
+        
+        return vcombine_s16(divide(lo), divide(hi));
+    };
+    
+    size_t i = warmup;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s16(&output[i], block(vld1q_s16(&input[i]), vld1q_s16(&input[i - window_size])));
+    }
+    
+    // Zero-padded last block: padding lanes add nothing and are never stored
+    if (i < count) {
+        simd_tail::Partial<int16_t> enter, leave;
+        enter.load(&input[i], count - i, 0);
+        leave.load(&input[i - window_size], count - i, 0);
+        vst1q_s16(enter.lanes, block(vld1q_s16(enter.lanes), vld1q_s16(leave.lanes)));
+        enter.store(&output[i], count - i);
+    }
+}
+
+/**
+ * @brief Apply a causal FIR filter to Q15 signal data
+ * @param input Input Q15 signal array
+ * @param output Filtered Q15 output array (saturated)
+ * @param count Number of elements in signal
+ * @param taps Q15 filter coefficients, taps[0] applies to the newest sample
+ * @param num_taps Number of coefficients
+ *
+ * Samples before input[0] are treated as zero. Products are accumulated in
+ * 32 bits, which cannot overflow while the sum of |taps| stays below 2.0.
+ */
+inline void fir_filter_q15(const int16_t* input, int16_t* output, size_t count,
+                           const int16_t* taps, size_t num_taps) {
+    if (num_taps == 0) return;
+    
+    // Outputs whose history reaches before input[0]
+    const size_t warmup = num_taps - 1 < count ? num_taps - 1 : count;
+    
+    for (size_t i = 0; i < warmup; ++i) {
+        int32_t acc = 0;
+        for (size_t k = 0; k <= i; ++k) {
+            acc += static_cast<int32_t>(taps[k]) * input[i - k];
+        }
+        int32_t rounded = (acc + (1 << 14)) >> 15;
+        output[i] = static_cast<int16_t>(rounded > INT16_MAX ? INT16_MAX : (rounded < INT16_MIN ? INT16_MIN : rounded));
+    }
+    
+    // Eight outputs ending at newest + 7; load(p) reads the eight samples starting at p
+    auto block = [taps, num_taps](const int16_t* newest, auto load) {
+        int32x4_t acc_lo = vdupq_n_s32(0);
+        int32x4_t acc_hi = vdupq_n_s32(0);
+        
+        for (size_t k = 0; k < num_taps; ++k) {
+            int16x8_t x = load(newest - k);
+            acc_lo = vmlal_n_s16(acc_lo, vget_low_s16(x), taps[k]);
+            acc_hi = vmlal_high_n_s16(acc_hi, x, taps[k]);
+        }
+        
+        return vcombine_s16(vqrshrn_n_s32(acc_lo, 15), vqrshrn_n_s32(acc_hi, 15));
+    };
+    auto load_full = [](const int16_t* p) { return vld1q_s16(p); };
+    
+    size_t i = warmup;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s16(&output[i], block(&input[i], load_full));
+    }
+    
+    if (i < count) {
+        if (count >= warmup + 8) {
+            // Overlapping last vector; the outputs it repeats are recomputed identically
+            vst1q_s16(&output[count - 8], block(&input[count - 8], load_full));
+        } else {
+            const size_t n = count - i;
+            auto load_partial = [n](const int16_t* p) {
+                simd_tail::Partial<int16_t> samples;
+                samples.load(p, n, 0);
+                return vld1q_s16(samples.lanes);
+            };
+            simd_tail::Partial<int16_t> result;
+            vst1q_s16(result.lanes, block(&input[i], load_partial));
+            result.store(&output[i], n);
+        }
+    }
+}
+
+#endif // FIXED_POINT_UTIL_H
@@ -0,0 +1,228 @@
+#ifndef FIXED_SIZE_KERNELS_H
+#define FIXED_SIZE_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "simd.h"
+#include "obj_detection_util.h"
+
+/*
+ * Compile-time sized versions of the kernels in obj_detection_util.h for
+ * call sites whose length is fixed (an 8-tap window, a 16-sample track
+ * history):
+ *
+ *     float avg = weighted_average<16>(history, weights);
+ *     moving_average_filter<16, 8>(history, smoothed);
+ *
+ * Every loop is expanded with a fold expression, so the body is a straight
+ * run of vector instructions: no loop counter, no size checks, and the
+ * count % 4 tail is chosen at compile time (overlapping or masked last
+ * vector, or a constant-size partial copy below four elements).
+ * Results are the same as the runtime kernels, except that the sums use
+ * more accumulators and may round differently in the last bit.
+ */
+
+namespace fixed_detail {
+
+template <typename F, size_t... I>
+inline void unroll(F&& f, std::index_sequence<I...>) {
+    (f(std::integral_constant<size_t, I>{}), ...);
+}
+
+} // namespace fixed_detail
+
+/**
+ * @brief Call f(std::integral_constant<size_t, i>) for i = 0 .. Count - 1, expanded at compile time
+ */
+template <size_t Count, typename F>
+inline void unroll(F&& f) {
+    fixed_detail::unroll(f, std::make_index_sequence<Count>{});
+}
+
+/**
+ * @brief Calculate weighted average of N values
+ * @param values Array of N values
+ * @param weights Array of N weights
+ * @return Weighted average result (0 if the weights sum to 0)
+ */
+template <size_t N>
+inline float weighted_average(const float* values, const float* weights) {
+    static_assert(N > 0, "fixed-size kernels need at least one element");
+    
+    float32x4_t sum_weighted[2] = {vdupq_n_f32(0.0f), vdupq_n_f32(0.0f)};
+    float32x4_t sum_weights[2] = {vdupq_n_f32(0.0f), vdupq_n_f32(0.0f)};
+    
+    unroll<N / 4>([&](auto i) {
+        float32x4_t vals = vld1q_f32(&values[4 * i]);
+        float32x4_t wts = vld1q_f32(&weights[4 * i]);
+        sum_weighted[i % 2] = vfmaq_f32(sum_weighted[i % 2], vals, wts);
+        sum_weights[i % 2] = vaddq_f32(sum_weights[i % 2], wts);
+    });
+    
+    if constexpr (N % 4 != 0) {
+        float32x4_t vals = simd_tail::load_tail_zeroed(values, N);
+        float32x4_t wts = simd_tail::load_tail_zeroed(weights, N);
+        sum_weighted[1] = vfmaq_f32(sum_weighted[1], vals, wts);
+        sum_weights[1] = vaddq_f32(sum_weights[1], wts);
+    }
+    
+    const float weighted_sum = vaddvq_f32(vaddq_f32(sum_weighted[0], sum_weighted[1]));
+    const float weight_sum = vaddvq_f32(vaddq_f32(sum_weights[0], sum_weights[1]));
+    return weight_sum > 0.0f ? weighted_sum / weight_sum : 0.0f;
+}
+
+/**
+ * @brief Calculate cross-correlation between two signals of N samples
+ * @param signal1 First signal array
+ * @param signal2 Second signal array
+ * @return Cross-correlation value
+ */
+template <size_t N>
+inline float cross_correlation(const float* signal1, const float* signal2) {
+    static_assert(N > 0, "fixed-size kernels need at least one element");
+    
+    // Independent accumulators hide the FMA latency
+    float32x4_t sum[4];
+    for (float32x4_t& s : sum) s = vdupq_n_f32(0.0f);
+    
+    unroll<N / 4>([&](auto i) {
+        sum[i % 4] = vfmaq_f32(sum[i % 4], vld1q_f32(&signal1[4 * i]), vld1q_f32(&signal2[4 * i]));
+    });
+    
+    if constexpr (N % 4 != 0) {
+        sum[3] = vfmaq_f32(sum[3], simd_tail::load_tail_zeroed(signal1, N), simd_tail::load_tail_zeroed(signal2, N));
+    }
+    
+    return vaddvq_f32(vaddq_f32(vaddq_f32(sum[0], sum[1]), vaddq_f32(sum[2], sum[3])));
+}
+
+/**
+ * @brief Find index of minimum value in an array of N values
+ * @param array Input array to search
+ * @return Index of the first minimum value
+ */
+template <size_t N>
+inline size_t min_index(const float* array) {
+    static_assert(N > 0, "fixed-size kernels need at least one element");
+    
+    const uint32x4_t lane = {0, 1, 2, 3};
+    float32x4_t min_vec;
+    uint32x4_t min_idx_vec;
+    
+    if constexpr (N < 4) {
+        // Pad with copies of array[0] under index 0, as min_index() does
+        simd_tail::Partial<float> block;
+        block.load(array, N, array[0]);
+        min_vec = vld1q_f32(block.lanes);
+        min_idx_vec = vandq_u32(lane, vcltq_u32(lane, vdupq_n_u32(N)));
+    } else {
+        min_vec = vld1q_f32(array);
+        min_idx_vec = lane;
+        
+        auto visit = [&](size_t start) {
+            float32x4_t data = vld1q_f32(&array[start]);
+            uint32x4_t mask = vcltq_f32(data, min_vec);
+            min_vec = vbslq_f32(mask, data, min_vec);
+            min_idx_vec = vbslq_u32(mask, vaddq_u32(lane, vdupq_n_u32(static_cast<uint32_t>(start))), min_idx_vec);
+        };
+        
+        unroll<N / 4 - 1>([&](auto i) { visit(4 * (i + 1)); });
+        if constexpr (N % 4 != 0) visit(N - 4);
+    }
+    
+    const float min_val = vminnmvq_f32(min_vec);
+    const uint32x4_t candidates = vbslq_u32(vceqq_f32(min_vec, vdupq_n_f32(min_val)),
+                                            min_idx_vec, vdupq_n_u32(UINT32_MAX));
+    const uint32_t min_idx = vminvq_u32(candidates);
+    
+    return min_idx == UINT32_MAX ? 0 : min_idx;
+}
+
+/**
+ * @brief Compute cumulative sum of N values
+ * @param input Input array
+ * @param output Output array to store cumulative sums (may alias input)
+ */
+template <size_t N>
+inline void cumulative_sum(const float* input, float* output) {
+    static_assert(N > 0, "fixed-size kernels need at least one element");
+    
+    float32x4_t carry = vdupq_n_f32(0.0f);
+    
+    unroll<N / 4>([&](auto i) {
+        float32x4_t result = vaddq_f32(prefix_sum_f32x4(vld1q_f32(&input[4 * i])), carry);
+        carry = vdupq_laneq_f32(result, 3);
+        vst1q_f32(&output[4 * i], result);
+    });
+    
+    if constexpr (N % 4 != 0) {
+        constexpr size_t start = N & ~size_t{3};
+        simd_tail::Partial<float> tail;
+        tail.load(&input[start], N - start, 0.0f);
+        vst1q_f32(tail.lanes, vaddq_f32(prefix_sum_f32x4(vld1q_f32(tail.lanes)), carry));
+        tail.store(&output[start], N - start);
+    }
+}
+
+/**
+ * @brief Apply a moving average filter of Window samples to N samples
+ * @param input Input signal array
+ * @param output Filtered output array
+ *
+ * Same edge behaviour as moving_average_filter(): the first Window - 1
+ * outputs average over the samples seen so far.
+ */
+template <size_t N, size_t Window>
+inline void moving_average_filter(const float* input, float* output) {
+    static_assert(N > 0, "fixed-size kernels need at least one element");
+    static_assert(Window > 0, "window must hold at least one sample");
+    
+    constexpr size_t warmup = Window - 1 < N ? Window - 1 : N;
+    
+    // Running mean over the first samples, with the divisors known per block
+    float32x4_t carry = vdupq_n_f32(0.0f);
+    unroll<(warmup + 3) / 4>([&](auto b) {
+        constexpr size_t start = 4 * decltype(b)::value;
+        constexpr size_t n = warmup - start < 4 ? warmup - start : 4;
+        const float32x4_t samples = {start + 1.0f, start + 2.0f, start + 3.0f, start + 4.0f};
+        
+        simd_tail::Partial<float> block;
+        block.load(&input[start], n, 0.0f);
+        float32x4_t sums = vaddq_f32(prefix_sum_f32x4(vld1q_f32(block.lanes)), carry);
+        carry = vdupq_laneq_f32(sums, 3);
+        vst1q_f32(block.lanes, vdivq_f32(sums, samples));
+        block.store(&output[start], n);
+    });
+    
+    const float32x4_t scale_vec = vdupq_n_f32(1.0f / Window);
+    auto window_mean = [&](const float* newest) {
+        float32x4_t sum = vld1q_f32(newest);
+        unroll<Window - 1>([&](auto j) { sum = vaddq_f32(sum, vld1q_f32(newest - (j + 1))); });
+        return vmulq_f32(sum, scale_vec);
+    };
+    
+    constexpr size_t steady = N - warmup;
+    unroll<steady / 4>([&](auto b) {
+        vst1q_f32(&output[warmup + 4 * b], window_mean(&input[warmup + 4 * b]));
+    });
+    
+    if constexpr (steady % 4 != 0) {
+        if constexpr (N >= warmup + 4) {
+            vst1q_f32(&output[N - 4], window_mean(&input[N - 4]));
+        } else {
+            simd_tail::Partial<float> block;
+            float32x4_t sum = vdupq_n_f32(0.0f);
+            unroll<Window>([&](auto j) {
+                block.load(&input[warmup] - j, steady, 0.0f);
+                sum = vaddq_f32(sum, vld1q_f32(block.lanes));
+            });
+            vst1q_f32(block.lanes, vmulq_f32(sum, scale_vec));
+            block.store(&output[warmup], steady);
+        }
+    }
+}
+
+#endif // FIXED_SIZE_KERNELS_H
@@ -0,0 +1,136 @@
+#ifndef KERNEL_PIPELINE_H
+#define KERNEL_PIPELINE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "obj_detection_util.h"
+
+/*
+ * Block-fused kernel pipelines.
+ *
+ * run_pipeline() streams a source through a chain of stages one block at a
+ * time. The block lives on the stack and stays in L1, so a chain such as
+ * speed -> EMA -> threshold touches each input and output array exactly once
+ * and never materializes the intermediate speed or EMA arrays.
+ *
+ * Every stage calls the ordinary kernel on its block, so results are
+ * identical to running the kernels one after another over the full arrays.
+ * Recurrent stages (EmaStage) carry their state from one block to the next.
+ *
+ * A source provides   void produce(float* block, size_t n, size_t offset);
+ * a stage provides    void process(float* block, size_t n, size_t offset);
+ * where offset is the index of block[0] in the full arrays. Stages may
+ * rewrite the block in place or only read it (sinks).
+ */
+
+// Floats per block; 4 KB leaves room in a 32 KB L1D for the streamed inputs and outputs
+constexpr size_t PIPELINE_BLOCK_SIZE = 1024;
+
+/**
+ * @brief Source reading an existing float array
+ */
+struct ArraySource {
+    const float* data;
+    
+    void produce(float* block, size_t n, size_t offset) const {
+        for (size_t i = 0; i < n; ++i) block[i] = data[offset + i];
+    }
+};
+
+/**
+ * @brief Source computing speed() from previous and current positions
+ */
+struct SpeedSource {
+    const float* positions_prev;
+    const float* positions_curr;
+    float time_delta;
+    
+    void produce(float* block, size_t n, size_t offset) const {
+        speed(positions_prev + offset, positions_curr + offset, block, n, time_delta);
+    }
+};
+
+/**
+ * @brief Exponential moving average stage, state carried across blocks
+ */
+struct EmaStage {
+    float alpha;
+    float state = 0.0f;
+    bool primed = false;
+    
+    explicit EmaStage(float smoothing) : alpha(smoothing) {}
+    
+    void process(float* block, size_t n, size_t offset) {
+        if (n == 0) return;
+        if (primed) {
+            exp_moving_average(block, block, n, alpha, state);
+        } else {
+            exp_moving_average(block, block, n, alpha);
+            primed = true;
+        }
+        state = block[n - 1];
+    }
+};
+
+/**
+ * @brief Sink copying the current block to an output array
+ */
+struct StoreStage {
+    float* output;
+    
+    void process(float* block, size_t n, size_t offset) const {
+        for (size_t i = 0; i < n; ++i) output[offset + i] = block[i];
+    }
+};
+
+/**
+ * @brief Sink running threshold_detection() on the current block
+ */
+struct ThresholdStage {
+    uint8_t* detections;
+    float threshold;
+    
+    void process(float* block, size_t n, size_t offset) const {
+        threshold_detection(block, detections + offset, n, threshold);
+    }
+};
+
+/**
+ * @brief Stream a source through a chain of stages in cache-resident blocks
+ * @param count Number of elements to process
+ * @param source Block producer (see file comment)
+ * @param stages Stages applied in order to each block
+ */
+template <typename Source, typename... Stages>
+inline void run_pipeline(size_t count, Source&& source, Stages&&... stages) {
+    alignas(64) float block[PIPELINE_BLOCK_SIZE];
+    
+    for (size_t offset = 0; offset < count; offset += PIPELINE_BLOCK_SIZE) {
+        const size_t n = count - offset < PIPELINE_BLOCK_SIZE ? count - offset : PIPELINE_BLOCK_SIZE;
+        
+        source.produce(block, n, offset);
+        (stages.process(block, n, offset), ...);
+    }
+}
+
+/**
+ * @brief Fused speed -> exponential moving average -> threshold detection
+ * @param positions_prev Previous position values
+ * @param positions_curr Current position values
+ * @param detections Output detection array (1 = smoothed speed above threshold)
+ * @param count Number of elements
+ * @param time_delta Time difference between measurements
+ * @param alpha EMA smoothing factor (0 < alpha < 1)
+ * @param threshold Detection threshold applied to the smoothed speed
+ */
+inline void speed_ema_threshold(const float* positions_prev, const float* positions_curr,
+                                uint8_t* detections, size_t count,
+                                float time_delta, float alpha, float threshold) {
+    run_pipeline(count,
+                 SpeedSource{positions_prev, positions_curr, time_delta},
+                 EmaStage(alpha),
+                 ThresholdStage{detections, threshold});
+}
+
+#endif // KERNEL_PIPELINE_H
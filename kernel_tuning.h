@@ -0,0 +1,388 @@
+#ifndef KERNEL_TUNING_H
+#define KERNEL_TUNING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+/*
+ * Loop shapes of the tuned kernels, per core.
+ *
+ * A tuning gives each kernel in tuned_kernels.h an accumulator count, an
+ * unroll depth and a prefetch distance. startup_tuning() is the tuning for
+ * the core this process runs on. It comes from that core's section of the
+ * tuning file: $OBJ_DETECTION_TUNING, or else kernel_tuning.conf in the
+ * working directory. Cores without a section get the compiled-in defaults
+ * for known cores, or the generic row. `obj_detection_util --autotune`
+ * (autotune.h) measures the running core and writes its section. Sections
+ * for other cores are kept, so one file can serve a mixed fleet of boards.
+ * On big.LITTLE parts the core is the one the process starts on: pin the
+ * process (taskset) when tuning and when running.
+ */
+
+
+// Environment variable naming the tuning file
+constexpr const char* TUNING_FILE_ENV = "OBJ_DETECTION_TUNING";
+
+// Tuning file used when the environment variable is not set
+constexpr const char* TUNING_FILE_DEFAULT = "kernel_tuning.conf";
+
+/**
+ * @brief Kernels with tunable loop shapes
+ */
+enum TunedKernel {
+    TUNED_CROSS_CORRELATION,
+    TUNED_WEIGHTED_AVERAGE,
+    TUNED_SPEED,
+    TUNED_THRESHOLD_DETECTION,
+    TUNED_KERNEL_COUNT
+};
+
+/**
+ * @brief Name of a tuned kernel, as used in the tuning file
+ */
+inline const char* tuned_kernel_name(TunedKernel kernel) {
+    static const char* const names[TUNED_KERNEL_COUNT] = {"cross_correlation", "weighted_average",
+                                                          "speed", "threshold_detection"};
+    return names[kernel];
+}
+
+/**
+ * @brief Loop shape of one kernel
+ */
+struct TuningParams {
+    int accumulators = 1;       // independent partial sums (1 for map kernels)
+    int unroll = 1;             // vectors, or 16-sample blocks for threshold_detection, per iteration
+    size_t prefetch_bytes = 0;  // prefetch distance ahead of the loads, 0 = none
+};
+
+inline bool operator==(const TuningParams& a, const TuningParams& b) {
+    return a.accumulators == b.accumulators && a.unroll == b.unroll && a.prefetch_bytes == b.prefetch_bytes;
+}
+
+/**
+ * @brief Shapes of every tuned kernel for one core, and where they came from
+ */
+struct KernelTuning {
+    std::string core;
+    std::string source;  // tuning file path, "defaults" or "generic defaults"
+    TuningParams params[TUNED_KERNEL_COUNT];
+};
+
+struct TuningShape {
+    int accumulators;
+    int unroll;
+};
+
+// Shapes compiled for the reductions; unroll is a multiple of the accumulator count
+inline constexpr TuningShape REDUCTION_SHAPES[] = {{1, 1}, {1, 2}, {2, 2}, {1, 4}, {2, 4}, {4, 4}, {2, 8}, {4, 8}, {8, 8}};
+
+// Shapes compiled for the element-wise kernels
+inline constexpr TuningShape MAP_SHAPES[] = {{1, 1}, {1, 2}, {1, 4}, {1, 8}};
+
+/**
+ * @brief Accumulator and unroll shapes compiled for a kernel, each with prefetch 0
+ */
+inline std::vector<TuningParams> tuning_shapes(TunedKernel kernel) {
+    const bool reduction = kernel == TUNED_CROSS_CORRELATION || kernel == TUNED_WEIGHTED_AVERAGE;
+    const TuningShape* begin = reduction ? std::begin(REDUCTION_SHAPES) : std::begin(MAP_SHAPES);
+    const TuningShape* end = reduction ? std::end(REDUCTION_SHAPES) : std::end(MAP_SHAPES);
+    
+    std::vector<TuningParams> shapes;
+    for (const TuningShape* s = begin; s != end; ++s) shapes.push_back({s->accumulators, s->unroll, 0});
+    return shapes;
+}
+
+/**
+ * @brief Whether params names a compiled shape of the kernel
+ */
+inline bool valid_tuning(TunedKernel kernel, const TuningParams& params) {
+    for (const TuningParams& shape : tuning_shapes(kernel)) {
+        if (shape.accumulators == params.accumulators && shape.unroll == params.unroll) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Compiled-in shapes for one core
+ */
+struct CoreTuningDefaults {
+    const char* core;
+    TuningParams params[TUNED_KERNEL_COUNT];  // in TunedKernel order
+};
+
+/**
+ * @brief Starting points per known core, replaced by measured winners once --autotune has run
+ *
+ * Chosen from each core's FMA latency, FP pipes and load ports; the
+ * in-order cores also prefetch since their hardware prefetchers are weak.
+ * The first row is the generic fallback.
+ */
+inline const std::vector<CoreTuningDefaults>& core_tuning_defaults() {
+    static const std::vector<CoreTuningDefaults> table = {
+        {"generic",     {{4, 4, 0},   {2, 4, 0},   {1, 2, 0},   {1, 1, 0}}},
+        {"cortex-a53",  {{4, 4, 256}, {2, 4, 256}, {1, 2, 256}, {1, 1, 256}}},
+        {"cortex-a55",  {{4, 4, 256}, {2, 4, 256}, {1, 2, 256}, {1, 1, 256}}},
+        {"cortex-a72",  {{4, 8, 0},   {4, 4, 0},   {1, 4, 0},   {1, 2, 0}}},
+        {"cortex-a73",  {{4, 8, 0},   {4, 4, 0},   {1, 4, 0},   {1, 2, 0}}},
+        {"cortex-a76",  {{4, 8, 0},   {4, 8, 0},   {1, 4, 0},   {1, 2, 0}}},
+        {"neoverse-n1", {{4, 8, 0},   {4, 8, 0},   {1, 4, 0},   {1, 2, 0}}},
+        {"cortex-a78",  {{8, 8, 0},   {4, 8, 0},   {1, 4, 0},   {1, 2, 0}}},
+        {"cortex-x1",   {{8, 8, 0},   {4, 8, 0},   {1, 8, 0},   {1, 2, 0}}},
+        {"apple",       {{8, 8, 0},   {4, 8, 0},   {1, 8, 0},   {1, 4, 0}}},
+        {"x86-64",      {{8, 8, 0},   {4, 8, 0},   {1, 4, 0},   {1, 2, 0}}},
+    };
+    return table;
+}
+
+/**
+ * @brief Compiled-in tuning for a core, or the generic row for unknown cores
+ */
+inline KernelTuning default_tuning(const std::string& core) {
+    const std::vector<CoreTuningDefaults>& table = core_tuning_defaults();
+    const CoreTuningDefaults* row = &table[0];
+    for (const CoreTuningDefaults& entry : table) {
+        if (core == entry.core) row = &entry;
+    }
+    
+    KernelTuning tuning;
+    tuning.core = core;
+    tuning.source = row == &table[0] ? "generic defaults" : "defaults";
+    for (int k = 0; k < TUNED_KERNEL_COUNT; ++k) tuning.params[k] = row->params[k];
+    return tuning;
+}
+
+/**
+ * @brief Name of a core from its MIDR implementer and part numbers, e.g. "cortex-a76"
+ */
+inline std::string arm_core_name(unsigned implementer, unsigned part) {
+    static const struct { unsigned part; const char* name; } arm_parts[] = {
+        {0xd03, "cortex-a53"}, {0xd04, "cortex-a35"}, {0xd05, "cortex-a55"}, {0xd07, "cortex-a57"},
+        {0xd08, "cortex-a72"}, {0xd09, "cortex-a73"}, {0xd0a, "cortex-a75"}, {0xd0b, "cortex-a76"},
+        {0xd0c, "neoverse-n1"}, {0xd0d, "cortex-a77"}, {0xd40, "neoverse-v1"}, {0xd41, "cortex-a78"},
+        {0xd44, "cortex-x1"}, {0xd46, "cortex-a510"}, {0xd47, "cortex-a710"}, {0xd48, "cortex-x2"},
+        {0xd49, "neoverse-n2"},
+    };
+    
+    if (implementer == 0x41) {
+        for (const auto& entry : arm_parts) {
+            if (entry.part == part) return entry.name;
+        }
+    } else if (implementer == 0x61) {
+        return "apple";
+    }
+    
+    std::ostringstream name;
+    name << "cpu-0x" << std::hex << implementer << "-0x" << part;
+    return name.str();
+}
+
+/**
+ * @brief Core name of one processor listed in /proc/cpuinfo text
+ * @param cpuinfo Contents of /proc/cpuinfo
+ * @param cpu Processor number to describe; the first listed is used if it is absent
+ * @return Core name, or an empty string if the text has no CPU implementer/part
+ */
+inline std::string core_name_from_cpuinfo(std::istream& cpuinfo, int cpu) {
+    struct Processor {
+        long number = -1;
+        long implementer = -1;
+        long part = -1;
+    };
+    std::vector<Processor> processors;
+    
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        const size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string key = line.substr(0, colon);
+        key.erase(key.find_last_not_of(" \t") + 1);
+        const long value = std::strtol(line.c_str() + colon + 1, nullptr, 0);
+        
+        if (key == "processor") {
+            processors.push_back(Processor());
+            processors.back().number = value;
+        } else if (processors.empty()) {
+            continue;
+        } else if (key == "CPU implementer") {
+            processors.back().implementer = value;
+        } else if (key == "CPU part") {
+            processors.back().part = value;
+        }
+    }
+    
+    const Processor* chosen = nullptr;
+    for (const Processor& p : processors) {
+        if (p.implementer < 0 || p.part < 0) continue;
+        if (!chosen || p.number == cpu) chosen = &p;
+        if (p.number == cpu) break;
+    }
+    return chosen ? arm_core_name(static_cast<unsigned>(chosen->implementer), static_cast<unsigned>(chosen->part)) : "";
+}
+
+/**
+ * @brief Name of the core this process runs on, used to pick its tuning
+ */
+inline std::string detect_core_name() {
+#if (defined(__aarch64__) || defined(__arm__)) && defined(__linux__)
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    const std::string name = core_name_from_cpuinfo(cpuinfo, sched_getcpu());
+    return name.empty() ? "generic" : name;
+#elif defined(__aarch64__) && defined(__APPLE__)
+    return "apple";
+#elif defined(__x86_64__)
+    return "x86-64";
+#else
+    return "generic";
+#endif
+}
+
+/**
+ * @brief Parse a tuning file into one tuning per core section
+ *
+ * Format, one section per core:
+ *
+ *     [cortex-a76]
+ *     cross_correlation accumulators=4 unroll=8 prefetch=0
+ *
+ * Kernels missing from a section keep the compiled-in defaults of its core.
+ * Comments (#), unknown kernels and shapes that are not compiled in are
+ * ignored.
+ */
+inline std::map<std::string, KernelTuning> read_tuning_file(std::istream& in) {
+    std::map<std::string, KernelTuning> sections;
+    KernelTuning* section = nullptr;
+    
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string name;
+        if (!(fields >> name)) continue;
+        
+        if (name.size() > 2 && name.front() == '[' && name.back() == ']') {
+            const std::string core = name.substr(1, name.size() - 2);
+            section = &sections.emplace(core, default_tuning(core)).first->second;
+            continue;
+        }
+        if (!section) continue;
+        
+        int kernel = 0;
+        while (kernel < TUNED_KERNEL_COUNT && name != tuned_kernel_name(static_cast<TunedKernel>(kernel))) ++kernel;
+        if (kernel == TUNED_KERNEL_COUNT) continue;
+        
+        TuningParams params;
+        std::string setting;
+        while (fields >> setting) {
+            const size_t equals = setting.find('=');
+            if (equals == std::string::npos) continue;
+            const std::string key = setting.substr(0, equals);
+            const long value = std::strtol(setting.c_str() + equals + 1, nullptr, 10);
+            if (value < 0) continue;
+            
+            if (key == "accumulators") {
+                params.accumulators = static_cast<int>(value);
+            } else if (key == "unroll") {
+                params.unroll = static_cast<int>(value);
+            } else if (key == "prefetch") {
+                params.prefetch_bytes = static_cast<size_t>(value);
+            }
+        }
+        if (valid_tuning(static_cast<TunedKernel>(kernel), params)) section->params[kernel] = params;
+    }
+    return sections;
+}
+
+/**
+ * @brief Write tunings in the format read_tuning_file() reads
+ */
+inline void write_tuning_file(std::ostream& out, const std::map<std::string, KernelTuning>& sections) {
+    out << "# Kernel loop shapes per core, written by obj_detection_util --autotune\n";
+    for (const auto& section : sections) {
+        out << "\n[" << section.first << "]\n";
+        for (int k = 0; k < TUNED_KERNEL_COUNT; ++k) {
+            const TuningParams& p = section.second.params[k];
+            out << tuned_kernel_name(static_cast<TunedKernel>(k)) << " accumulators=" << p.accumulators
+                << " unroll=" << p.unroll << " prefetch=" << p.prefetch_bytes << "\n";
+        }
+    }
+}
+
+/**
+ * @brief Path of the tuning file: $OBJ_DETECTION_TUNING, else kernel_tuning.conf
+ */
+inline std::string tuning_file_path() {
+    const char* path = std::getenv(TUNING_FILE_ENV);
+    return path && *path ? path : TUNING_FILE_DEFAULT;
+}
+
+/**
+ * @brief Tuning for this core from the tuning file, or the compiled-in defaults if it has no section
+ */
+inline KernelTuning load_tuning(const std::string& path, const std::string& core) {
+    std::ifstream file(path);
+    if (file) {
+        std::map<std::string, KernelTuning> sections = read_tuning_file(file);
+        auto found = sections.find(core);
+        if (found != sections.end()) {
+            found->second.source = path;
+            return found->second;
+        }
+    }
+    return default_tuning(core);
+}
+
+/**
+ * @brief Replace this core's section of the tuning file, keeping the sections of other cores
+ * @return false if the file cannot be written
+ */
+inline bool save_tuning(const std::string& path, const KernelTuning& tuning) {
+    std::map<std::string, KernelTuning> sections;
+    {
+        std::ifstream existing(path);
+        if (existing) sections = read_tuning_file(existing);
+    }
+    sections[tuning.core] = tuning;
+    
+    std::ofstream file(path);
+    if (!file) return false;
+    write_tuning_file(file, sections);
+    return static_cast<bool>(file);
+}
+
+/**
+ * @brief Selected shape of every kernel, e.g. "cross_correlation=4x8+256,..." (accumulators x unroll + prefetch bytes)
+ */
+inline std::string describe_tuning(const KernelTuning& tuning) {
+    std::string text;
+    for (int k = 0; k < TUNED_KERNEL_COUNT; ++k) {
+        const TuningParams& p = tuning.params[k];
+        if (k > 0) text += ",";
+        text += std::string(tuned_kernel_name(static_cast<TunedKernel>(k))) + "=" + std::to_string(p.accumulators)
+              + "x" + std::to_string(p.unroll) + "+" + std::to_string(p.prefetch_bytes);
+    }
+    return text;
+}
+
+
+/**
+ * @brief Tuning for the core this process runs on, loaded once
+ */
+inline const KernelTuning& startup_tuning() {
+    static const KernelTuning tuning = load_tuning(tuning_file_path(), detect_core_name());
+    return tuning;
+}
+
+#endif // KERNEL_TUNING_H
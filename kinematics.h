@@ -0,0 +1,217 @@
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+#include <cstddef>
+
+#include "simd.h"
+#include "simd_tail.h"
+#include "simd_math.h"
+
+/*
+ * Track kinematics from SoA positions in one pass: velocity vector, speed
+ * magnitude, heading and acceleration of every object, for 2D (x, y) or
+ * 3D (x, y, z) tracks.
+ *
+ * speed() differentiates one channel, so a 2D track used to take two
+ * speed() calls, or three in 3D, plus a scalar loop for the magnitude and
+ * atan2. kinematics() reads each position once and keeps everything in
+ * registers: sqrt is vsqrtq_f32 and the heading is atan2_f32x4 from
+ * simd_math.h.
+ *
+ * Positions come from the three most recent frames, each time_delta apart:
+ *
+ *  - Backward differences estimate the motion at the current frame:
+ *    v = (current - previous) / dt, the same values speed() gives.
+ *  - Central differences estimate it one frame back, at the previous
+ *    frame: v = (current - older) / (2 dt). The error is second order in
+ *    dt instead of first, at the cost of one frame of latency.
+ *
+ * Acceleration is (current - 2 previous + older) / dt^2 in both modes.
+ * Frames a call does not read may be left null: `older` when backward
+ * differences skip acceleration, `previous` when central ones do.
+ */
+
+/**
+ * @brief How velocity is estimated from the three frames
+ */
+enum class DifferenceMode {
+    Backward,  // (current - previous) / dt, at the current frame
+    Central,   // (current - older) / (2 dt), at the previous frame
+};
+
+/**
+ * @brief Positions of every tracked object in one frame
+ */
+struct PositionFrame {
+    const float* x;
+    const float* y;
+    const float* z;  // nullptr for 2D tracks
+};
+
+/**
+ * @brief Output arrays of kinematics(), one element per object
+ */
+struct KinematicsOutput {
+    float* vx;       // velocity
+    float* vy;
+    float* vz;       // unused for 2D tracks
+    float* speed;    // velocity magnitude
+    float* heading;  // atan2(vy, vx), radians in [-pi, pi]
+    float* ax;       // acceleration, or all nullptr to skip it
+    float* ay;
+    float* az;       // unused for 2D tracks
+};
+
+namespace kinematics_detail {
+
+/**
+ * @brief Results for four objects
+ */
+struct KinematicsBlock {
+    float32x4_t vx, vy, vz, speed, heading, ax, ay, az;
+};
+
+/**
+ * @brief One kinematics() call, specialized for the dimension and for whether acceleration is wanted
+ */
+template <bool ThreeD, bool Acceleration>
+struct KinematicsKernel {
+    PositionFrame older, previous, current;
+    const float* const* velocity_from;  // previous or older, by mode
+    float32x4_t velocity_scale;         // 1 / dt or 1 / (2 dt)
+    float32x4_t acceleration_scale;     // 1 / dt^2
+    KinematicsOutput out;
+    
+    /**
+     * @brief d/dt and d2/dt2 of one coordinate for objects [i, i + 4)
+     */
+    void differentiate(const float* older_c, const float* previous_c, const float* current_c, const float* from_c,
+                       size_t i, float32x4_t& velocity, float32x4_t& acceleration) const {
+        const float32x4_t curr = vld1q_f32(&current_c[i]);
+        velocity = vmulq_f32(vsubq_f32(curr, vld1q_f32(&from_c[i])), velocity_scale);
+        if constexpr (Acceleration) {
+            const float32x4_t prev = vld1q_f32(&previous_c[i]);
+            const float32x4_t step = vsubq_f32(curr, prev);
+            const float32x4_t prev_step = vsubq_f32(prev, vld1q_f32(&older_c[i]));
+            acceleration = vmulq_f32(vsubq_f32(step, prev_step), acceleration_scale);
+        }
+    }
+    
+    KinematicsBlock compute(size_t i) const {
+        KinematicsBlock b;
+        b.vz = b.ax = b.ay = b.az = vdupq_n_f32(0.0f);
+        differentiate(older.x, previous.x, current.x, velocity_from[0], i, b.vx, b.ax);
+        differentiate(older.y, previous.y, current.y, velocity_from[1], i, b.vy, b.ay);
+        
+        float32x4_t speed_squared = vfmaq_f32(vmulq_f32(b.vx, b.vx), b.vy, b.vy);
+        if constexpr (ThreeD) {
+            differentiate(older.z, previous.z, current.z, velocity_from[2], i, b.vz, b.az);
+            speed_squared = vfmaq_f32(speed_squared, b.vz, b.vz);
+        }
+        b.speed = vsqrtq_f32(speed_squared);
+        b.heading = atan2_f32x4(b.vy, b.vx);
+        return b;
+    }
+    
+    void store(const KinematicsBlock& b, size_t i) const {
+        vst1q_f32(&out.vx[i], b.vx);
+        vst1q_f32(&out.vy[i], b.vy);
+        vst1q_f32(&out.speed[i], b.speed);
+        vst1q_f32(&out.heading[i], b.heading);
+        if constexpr (ThreeD) vst1q_f32(&out.vz[i], b.vz);
+        if constexpr (Acceleration) {
+            vst1q_f32(&out.ax[i], b.ax);
+            vst1q_f32(&out.ay[i], b.ay);
+            if constexpr (ThreeD) vst1q_f32(&out.az[i], b.az);
+        }
+    }
+};
+
+/**
+ * @brief Run the kernel over `count` objects
+ */
+template <bool ThreeD, bool Acceleration>
+inline void kinematics_run(const PositionFrame& older, const PositionFrame& previous, const PositionFrame& current,
+                           const KinematicsOutput& out, size_t count, float time_delta, DifferenceMode mode) {
+    const bool central = mode == DifferenceMode::Central;
+    const PositionFrame& from = central ? older : previous;
+    const float* velocity_from[3] = {from.x, from.y, from.z};
+    
+    KinematicsKernel<ThreeD, Acceleration> kernel{
+        older, previous, current, velocity_from,
+        vdupq_n_f32((central ? 0.5f : 1.0f) / time_delta),
+        vdupq_n_f32(1.0f / (time_delta * time_delta)), out};
+    
+    if (count < 4) {
+        // Stage the inputs that are read through vector-sized buffers and run one block on them
+        simd_tail::Partial<float> in[4][3];
+        float* staged_in[4][3] = {};
+        const PositionFrame* frames[4] = {&older, &previous, &current, &from};
+        for (int f = 0; f < 4; ++f) {
+            const float* coords[3] = {frames[f]->x, frames[f]->y, frames[f]->z};
+            for (int c = 0; c < 3; ++c) {
+                if (!coords[c]) continue;
+                in[f][c].load(coords[c], count, 0.0f);
+                staged_in[f][c] = in[f][c].lanes;
+            }
+        }
+        const float* staged_from[3] = {staged_in[3][0], staged_in[3][1], staged_in[3][2]};
+        kernel.older = {staged_in[0][0], staged_in[0][1], staged_in[0][2]};
+        kernel.previous = {staged_in[1][0], staged_in[1][1], staged_in[1][2]};
+        kernel.current = {staged_in[2][0], staged_in[2][1], staged_in[2][2]};
+        kernel.velocity_from = staged_from;
+        
+        simd_tail::Partial<float> result[8];
+        kernel.out = {result[0].lanes, result[1].lanes, result[2].lanes, result[3].lanes,
+                      result[4].lanes, result[5].lanes, result[6].lanes, result[7].lanes};
+        kernel.store(kernel.compute(0), 0);
+        
+        float* const outputs[8] = {out.vx, out.vy, out.vz, out.speed, out.heading, out.ax, out.ay, out.az};
+        const bool written[8] = {true, true, ThreeD, true, true, Acceleration, Acceleration, ThreeD && Acceleration};
+        for (int k = 0; k < 8; ++k) {
+            if (written[k]) result[k].store(outputs[k], count);
+        }
+        return;
+    }
+    
+    // Last four objects, computed up front and stored over the overlap at the end
+    const size_t last = count - 4;
+    const KinematicsBlock tail = kernel.compute(last);
+    
+    const size_t simd_count = count & ~3;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        kernel.store(kernel.compute(i), i);
+    }
+    
+    kernel.store(tail, last);
+}
+
+} // namespace kinematics_detail
+
+/**
+ * @brief Velocity, speed, heading and optionally acceleration of every object in one pass
+ * @param older Positions two frames back (only read for acceleration or central differences)
+ * @param previous Positions one frame back (only read for acceleration or backward differences)
+ * @param current Positions in the current frame; z set means 3D tracks
+ * @param out Output arrays; ax, ay, az null to skip acceleration
+ * @param count Number of objects
+ * @param time_delta Time between consecutive frames
+ * @param mode Backward or central differences for the velocity
+ */
+inline void kinematics(const PositionFrame& older, const PositionFrame& previous, const PositionFrame& current,
+                       const KinematicsOutput& out, size_t count, float time_delta,
+                       DifferenceMode mode = DifferenceMode::Backward) {
+    using namespace kinematics_detail;
+    const bool three_d = current.z != nullptr;
+    const bool acceleration = out.ax != nullptr;
+    
+    if (three_d) {
+        if (acceleration) kinematics_run<true, true>(older, previous, current, out, count, time_delta, mode);
+        else kinematics_run<true, false>(older, previous, current, out, count, time_delta, mode);
+    } else {
+        if (acceleration) kinematics_run<false, true>(older, previous, current, out, count, time_delta, mode);
+        else kinematics_run<false, false>(older, previous, current, out, count, time_delta, mode);
+    }
+}
+
+#endif // KINEMATICS_H
@@ -0,0 +1,339 @@
+#ifndef LATENCY_BENCHMARK_H
+#define LATENCY_BENCHMARK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "benchmark.h"
+#include "perf_counters.h"
+
+/*
+ * Per-call latency of the kernels on the tiny arrays they see in practice
+ * (one call per track, 1-64 elements), where the scalar tails and the
+ * horizontal reductions cost more than the vector body.
+ *
+ * Every sample times a single call with the thread's CPU cycle counter
+ * (CycleCounter from perf_counters.h, read with rdpmc or the AArch64 PMU
+ * registers where the kernel allows, else with read()). The thread is
+ * pinned to one core for the run so samples never migrate. Thousands of
+ * samples per kernel and size give p50, p99 and p99.9; the tail shows
+ * interrupts and other interference that a throughput average hides.
+ *
+ * Without perf events the samples fall back to the timer counter: rdtsc
+ * on x86, the generic timer (cntvct_el0, often tens of MHz) on AArch64.
+ * When that cannot resolve one call, each sample becomes the mean of the
+ * smallest batch of calls spanning LATENCY_MIN_SAMPLE_TICKS, and the
+ * table and JSON carry a warning: percentiles of batch means understate
+ * per-call tails.
+ */
+
+// Fallback timer samples coarser than this many ticks are batched
+constexpr uint64_t LATENCY_MIN_SAMPLE_TICKS = 64;
+
+/**
+ * @brief Read the timer counter with ordering against surrounding code
+ */
+inline uint64_t read_timer_counter() {
+#if defined(__aarch64__)
+    uint64_t value;
+    asm volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(value) : : "memory");
+    return value;
+#elif defined(__x86_64__) || defined(__i386__)
+    _mm_lfence();
+    const uint64_t value = __rdtsc();
+    _mm_lfence();
+    return value;
+#else
+    return PerfCounters::monotonic_ns();
+#endif
+}
+
+/**
+ * @brief The counter latency samples are taken with: CPU cycles if perf events allow, else the timer
+ */
+class LatencyClock {
+public:
+    LatencyClock() : cycles_available_(cycles_.available()) {}
+    
+    uint64_t now() const { return cycles_available_ ? cycles_.read() : read_timer_counter(); }
+    
+    /**
+     * @brief True if every tick is a CPU cycle, so single calls are always resolved
+     */
+    bool cycle_accurate() const { return cycles_available_; }
+    
+    const char* name() const {
+        if (cycles_available_) return cycles_.user_read() ? "perf cycles (user read)" : "perf cycles (read syscall)";
+#if defined(__aarch64__)
+        return "cntvct_el0 (perf events unavailable)";
+#elif defined(__x86_64__) || defined(__i386__)
+        return "rdtsc (perf events unavailable)";
+#else
+        return "clock_gettime (perf events unavailable)";
+#endif
+    }
+    
+    /**
+     * @brief Ticks per second
+     *
+     * The AArch64 generic timer reports its own frequency; cycles and the
+     * other counters are calibrated against the monotonic clock over a few
+     * milliseconds of busy waiting.
+     */
+    double ticks_per_second() const {
+#if defined(__aarch64__)
+        if (!cycles_available_) {
+            uint64_t frequency;
+            asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+            return static_cast<double>(frequency);
+        }
+#endif
+        const uint64_t start_ns = PerfCounters::monotonic_ns();
+        const uint64_t start_ticks = now();
+        while (PerfCounters::monotonic_ns() - start_ns < 20000000) {}
+        const uint64_t ticks = now() - start_ticks;
+        const uint64_t elapsed_ns = PerfCounters::monotonic_ns() - start_ns;
+        return static_cast<double>(ticks) * 1e9 / static_cast<double>(elapsed_ns);
+    }
+
+private:
+    CycleCounter cycles_;
+    bool cycles_available_;
+};
+
+/**
+ * @brief Pin the calling thread to one CPU for the lifetime of the object
+ */
+class ScopedCpuPin {
+public:
+    /**
+     * @param cpu CPU to run on, or -1 for the CPU the thread is on now
+     */
+    explicit ScopedCpuPin(int cpu) {
+#if defined(__linux__)
+        if (cpu < 0) cpu = sched_getcpu();
+        if (cpu < 0 || sched_getaffinity(0, sizeof(previous_), &previous_) != 0) return;
+        
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) == 0) cpu_ = cpu;
+#else
+        (void)cpu;
+#endif
+    }
+    
+    ~ScopedCpuPin() {
+#if defined(__linux__)
+        if (cpu_ >= 0) sched_setaffinity(0, sizeof(previous_), &previous_);
+#endif
+    }
+    
+    ScopedCpuPin(const ScopedCpuPin&) = delete;
+    ScopedCpuPin& operator=(const ScopedCpuPin&) = delete;
+    
+    /**
+     * @brief CPU the thread is pinned to, or -1 if pinning failed
+     */
+    int cpu() const { return cpu_; }
+
+private:
+    int cpu_ = -1;
+#if defined(__linux__)
+    cpu_set_t previous_;
+#endif
+};
+
+/**
+ * @brief Small sizes, including every residue modulo 4 and both sides of each vector boundary
+ */
+inline std::vector<size_t> default_latency_sizes() {
+    return {1, 2, 3, 4, 5, 7, 8, 13, 16, 17, 31, 32, 33, 63, 64};
+}
+
+struct LatencyConfig {
+    std::vector<size_t> sizes = default_latency_sizes();
+    int warmup_calls = 1000;
+    int samples = 20000;
+    int cpu = -1;  // -1 pins to the current CPU
+    uint32_t seed = 42;
+    std::string filter;
+};
+
+/**
+ * @brief Per-call latency of one kernel at one size
+ */
+struct LatencyResult {
+    std::string kernel;
+    size_t elements;
+    size_t calls_per_sample;
+    double ns_min;
+    double ns_p50;
+    double ns_p99;
+    double ns_p999;
+};
+
+/**
+ * @brief Results of one latency run and how they were measured
+ */
+struct LatencyReport {
+    std::vector<LatencyResult> results;
+    int pinned_cpu = -1;          // -1 if the thread could not be pinned
+    std::string clock;            // counter the samples were read from
+    bool batched = false;         // some samples are means over several calls
+};
+
+/**
+ * @brief Warning attached to reports with batched samples
+ */
+constexpr const char* LATENCY_BATCH_WARNING =
+    "counter too coarse for single calls: rows with batch > 1 are percentiles of batch means, not per-call tails";
+
+/**
+ * @brief Clock and call overhead of one sample, in ticks (minimum over many reads)
+ */
+inline uint64_t latency_timer_overhead(const LatencyClock& clock) {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 1000; ++i) {
+        const uint64_t start = clock.now();
+        best = std::min(best, clock.now() - start);
+    }
+    return best;
+}
+
+/**
+ * @brief Measure per-call latency of one kernel at one size
+ * @param tick_ns Nanoseconds per clock tick
+ * @param overhead_ticks Clock overhead subtracted from every sample
+ */
+inline LatencyResult run_latency(const BenchmarkKernel& kernel, size_t n, const LatencyConfig& config,
+                                 const LatencyClock& clock, double tick_ns, uint64_t overhead_ticks) {
+    for (int i = 0; i < config.warmup_calls; ++i) kernel.run(n);
+    
+    // Cycles resolve any call; batch only when the fallback timer cannot
+    size_t batch = 1;
+    while (!clock.cycle_accurate()) {
+        uint64_t best = UINT64_MAX;
+        for (int i = 0; i < 16; ++i) {
+            const uint64_t start = clock.now();
+            for (size_t b = 0; b < batch; ++b) kernel.run(n);
+            best = std::min(best, clock.now() - start);
+        }
+        if (best >= LATENCY_MIN_SAMPLE_TICKS || batch >= 4096) break;
+        batch *= 2;
+    }
+    
+    std::vector<double> ns_per_call;
+    ns_per_call.reserve(config.samples);
+    for (int s = 0; s < config.samples; ++s) {
+        const uint64_t start = clock.now();
+        for (size_t b = 0; b < batch; ++b) kernel.run(n);
+        const uint64_t ticks = clock.now() - start;
+        const uint64_t net = ticks > overhead_ticks ? ticks - overhead_ticks : 0;
+        ns_per_call.push_back(static_cast<double>(net) * tick_ns / static_cast<double>(batch));
+    }
+    std::sort(ns_per_call.begin(), ns_per_call.end());
+    
+    LatencyResult result;
+    result.kernel = kernel.name;
+    result.elements = n;
+    result.calls_per_sample = batch;
+    result.ns_min = ns_per_call.empty() ? 0.0 : ns_per_call.front();
+    result.ns_p50 = bench_percentile(ns_per_call, 50.0);
+    result.ns_p99 = bench_percentile(ns_per_call, 99.0);
+    result.ns_p999 = bench_percentile(ns_per_call, 99.9);
+    return result;
+}
+
+/**
+ * @brief Run every kernel (or those matching config.filter) at every size, pinned to one core
+ */
+inline LatencyReport run_latency_benchmarks(const LatencyConfig& config) {
+    ScopedCpuPin pin(config.cpu);
+    const LatencyClock clock;
+    
+    LatencyReport report;
+    report.pinned_cpu = pin.cpu();
+    report.clock = clock.name();
+    
+    const double tick_ns = 1e9 / clock.ticks_per_second();
+    const uint64_t overhead_ticks = latency_timer_overhead(clock);
+    
+    size_t max_elements = 0;
+    for (size_t n : config.sizes) max_elements = std::max(max_elements, n);
+    
+    BenchmarkData data(max_elements, config.seed);
+    for (const BenchmarkKernel& kernel : benchmark_kernels(data)) {
+        if (!config.filter.empty() && kernel.name.find(config.filter) == std::string::npos) continue;
+        for (size_t n : config.sizes) {
+            report.results.push_back(run_latency(kernel, n, config, clock, tick_ns, overhead_ticks));
+            report.batched = report.batched || report.results.back().calls_per_sample > 1;
+        }
+    }
+    return report;
+}
+
+/**
+ * @brief Print latency results as an aligned table
+ */
+inline void print_latency_table(std::ostream& out, const LatencyReport& report) {
+    out << "Clock: " << report.clock << "\n";
+    if (report.batched) out << "WARNING: " << LATENCY_BATCH_WARNING << "\n";
+    out << std::left << std::setw(26) << "kernel" << std::right << std::setw(6) << "n"
+        << std::setw(7) << "batch" << std::setw(10) << "ns min" << std::setw(10) << "p50"
+        << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(10) << "ns/el" << "\n";
+    
+    for (const LatencyResult& r : report.results) {
+        out << std::left << std::setw(26) << r.kernel << std::right << std::setw(6) << r.elements
+            << std::setw(7) << r.calls_per_sample << std::fixed << std::setprecision(1)
+            << std::setw(10) << r.ns_min << std::setw(10) << r.ns_p50
+            << std::setw(10) << r.ns_p99 << std::setw(10) << r.ns_p999
+            << std::setprecision(2) << std::setw(10) << r.ns_p50 / r.elements << "\n";
+    }
+}
+
+/**
+ * @brief Write latency results and run parameters as JSON
+ */
+inline void write_latency_json(std::ostream& out, const LatencyReport& report, const LatencyConfig& config) {
+    const std::vector<LatencyResult>& results = report.results;
+    out << "{\n";
+    out << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+    out << "  \"target\": \"" << benchmark_target() << "\",\n";
+    out << "  \"dispatch\": \"" << describe_dispatch(dispatch_table) << "\",\n";
+    out << "  \"tuning\": \"" << tuned_table.tuning.core << ": " << describe_tuning(tuned_table.tuning) << "\",\n";
+    out << "  \"seed\": " << config.seed << ",\n";
+    out << "  \"samples\": " << config.samples << ",\n";
+    out << "  \"cpu\": " << report.pinned_cpu << ",\n";
+    out << "  \"clock\": \"" << report.clock << "\",\n";
+    out << "  \"warning\": ";
+    if (report.batched) out << "\"" << LATENCY_BATCH_WARNING << "\",\n";
+    else out << "null,\n";
+    out << "  \"latency\": [\n";
+    
+    for (size_t i = 0; i < results.size(); ++i) {
+        const LatencyResult& r = results[i];
+        out << std::setprecision(6) << std::defaultfloat
+            << "    {\"kernel\": \"" << r.kernel << "\", \"elements\": " << r.elements
+            << ", \"calls_per_sample\": " << r.calls_per_sample
+            << ", \"ns_min\": " << r.ns_min << ", \"ns_p50\": " << r.ns_p50
+            << ", \"ns_p99\": " << r.ns_p99 << ", \"ns_p999\": " << r.ns_p999 << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    
+    out << "  ]\n}\n";
+}
+
+#endif // LATENCY_BENCHMARK_H
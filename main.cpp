@@ -1,11 +1,48 @@
 #include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <cstdlib>
+#include <string>
 #include <vector>
 #include <iomanip>
+#include <sstream>
 #include <random>
 #include <chrono>
 #include <cmath>
+#include <thread>
+#include <stdexcept>
+#include <iterator>
 
 #include "obj_detection_util.h"
+#include "fixed_point_util.h"
+#include "kernel_pipeline.h"
+#include "simd_expr.h"
+#include "batch_kernels.h"
+#include "parallel_kernels.h"
+#include "task_scheduler.h"
+#include "aligned_kernels.h"
+#include "recording_reader.h"
+#include "sensor_recording.h"
+#include "ring_buffer.h"
+#include "benchmark.h"
+#include "roofline.h"
+#include "latency_benchmark.h"
+#include "fixed_size_kernels.h"
+#include "cpu_dispatch.h"
+#include "tuned_kernels.h"
+#include "autotune.h"
+#include "point_kernels.h"
+#include "kinematics.h"
+#include "simd_math.h"
+
+// Self-checks that printed "no"; main() exits with an error if there are any
+int failed_checks = 0;
+
+// Label for a self-check line, counting it if it failed
+const char* check_result(bool passed) {
+    if (!passed) ++failed_checks;
+    return passed ? "yes" : "no";
+}
 
 void print_array(const std::string& name, const float* arr, size_t count, int precision = 3) {
     std::cout << name << ": [";
@@ -16,6 +53,15 @@ void print_array(const std::string& name, const float* arr, size_t count, int pr
     std::cout << "]\n";
 }
 
+void print_int16_array(const std::string& name, const int16_t* arr, size_t count) {
+    std::cout << name << ": [";
+    for (size_t i = 0; i < count; ++i) {
+        std::cout << arr[i];
+        if (i < count - 1) std::cout << ", ";
+    }
+    std::cout << "]\n";
+}
+
 void print_uint8_array(const std::string& name, const uint8_t* arr, size_t count) {
     std::cout << name << ": [";
     for (size_t i = 0; i < count; ++i) {
@@ -51,9 +97,7 @@ void test_vector_distance() {
     print_array("Squared distances", result, 4);
     
     // Calculate actual distances
-    for (int i = 0; i < 4; ++i) {
-        result[i] = std::sqrt(result[i]);
-    }
+    vst1q_f32(result, sqrt_f32x4(distances_sq));
     print_array("Actual distances", result, 4);
 }
 
@@ -189,40 +233,1432 @@ void test_threshold_detection() {
     print_uint8_array("Detections (1=above, 0=below)", detections, count);
 }
 
-// Performance benchmark
-void test_performance_benchmark() {
-    std::cout << "\n=== Performance Benchmark ===\n";
+// Test function for native integer inputs
+void test_integer_inputs() {
+    std::cout << "\n=== Native Integer Inputs ===\n";
+    
+    uint8_t pixel_row[] = {12, 40, 200, 180, 35, 90, 250, 17, 3, 128, 64, 220, 9, 33, 199, 240, 77, 5};
+    uint8_t detections[18];
+    size_t count = sizeof(pixel_row) / sizeof(pixel_row[0]);
+    
+    print_uint8_array("Pixel row (uint8)", pixel_row, count);
+    
+    threshold_detection(pixel_row, detections, count, uint8_t{150});
+    print_uint8_array("Detections (> 150)", detections, count);
+    
+    size_t darkest = min_index(pixel_row, count);
+    std::cout << "Darkest pixel index: " << darkest << " (value " << static_cast<int>(pixel_row[darkest]) << ")\n";
+    
+    uint16_t adc_counts[] = {4095, 3900, 1024, 2048, 512, 3000, 4000, 256, 800};
+    size_t adc_count = sizeof(adc_counts) / sizeof(adc_counts[0]);
+    std::cout << "Lowest ADC count index (uint16): " << min_index(adc_counts, adc_count) << "\n";
+}
+
+// Odd and tiny sizes run on the vector path end to end; compare against plain scalar loops
+void test_small_arrays() {
+    std::cout << "\n=== Small and Odd-Sized Arrays ===\n";
+    
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<float> dis(-10.0f, 10.0f);
+    const size_t window = 4;
+    const float alpha = 0.3f;
+    
+    auto near = [](float a, float b) { return std::fabs(a - b) <= 1e-4f * (1.0f + std::fabs(b)); };
+    
+    for (size_t count : {1, 3, 5, 7, 13, 31}) {
+        std::vector<float> a(count), b(count), out(count), ref(count);
+        std::vector<uint8_t> det(count);
+        for (size_t i = 0; i < count; ++i) {
+            a[i] = dis(gen);
+            b[i] = dis(gen);
+        }
+        
+        bool match = true;
+        
+        cumulative_sum(a.data(), out.data(), count);
+        float total = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            total += a[i];
+            match = match && near(out[i], total);
+        }
+        
+        speed(a.data(), b.data(), out.data(), count, 0.5f);
+        for (size_t i = 0; i < count; ++i) match = match && near(out[i], (b[i] - a[i]) / 0.5f);
+        
+        moving_average_filter(a.data(), out.data(), count, window);
+        for (size_t i = 0; i < count; ++i) {
+            const size_t start = i + 1 >= window ? i + 1 - window : 0;
+            float sum = 0.0f;
+            for (size_t j = start; j <= i; ++j) sum += a[j];
+            match = match && near(out[i], sum / (i + 1 - start));
+        }
+        
+        exp_moving_average(a.data(), out.data(), count, alpha);
+        ref[0] = a[0];
+        for (size_t i = 1; i < count; ++i) ref[i] = alpha * a[i] + (1.0f - alpha) * ref[i - 1];
+        for (size_t i = 0; i < count; ++i) match = match && near(out[i], ref[i]);
+        
+        threshold_detection(a.data(), det.data(), count, 0.0f);
+        size_t min_idx = 0;
+        for (size_t i = 0; i < count; ++i) {
+            match = match && det[i] == (a[i] > 0.0f ? 1 : 0);
+            if (a[i] < a[min_idx]) min_idx = i;
+        }
+        match = match && min_index(a.data(), count) == min_idx;
+        
+        std::cout << "count " << std::setw(2) << count << ": matches scalar reference: " << check_result(match) << "\n";
+    }
+}
+
+// Test function for compile-time sized kernels
+void test_fixed_size_kernels() {
+    std::cout << "\n=== Fixed-Size Kernels (16-sample history, 8-tap window) ===\n";
     
-    const size_t test_size = 1e6;
-    std::vector<float> large_array(test_size);
-    std::vector<float> weights(test_size);
+    float history[16], weights[16], fixed_out[16], general_out[16];
+    for (size_t i = 0; i < 16; ++i) {
+        history[i] = 10.0f + 0.5f * i + ((i * 7) % 5) - 2.0f;
+        weights[i] = 1.0f + i / 16.0f;
+    }
+    history[11] = 1.5f;
+    
+    std::cout << "weighted_average<16>: " << weighted_average<16>(history, weights)
+              << " (general: " << weighted_average(history, weights, 16) << ")\n";
+    std::cout << "cross_correlation<16>: " << cross_correlation<16>(history, weights)
+              << " (general: " << cross_correlation(history, weights, 16) << ")\n";
+    std::cout << "min_index<16>: " << min_index<16>(history)
+              << " (general: " << min_index(history, 16) << ")\n";
+    
+    // Constant divisors may become reciprocal multiplies under -ffast-math
+    auto near = [](float a, float b) { return std::fabs(a - b) <= 1e-5f * (1.0f + std::fabs(b)); };
     
-    // Fill with random data
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    bool match = true;
+    moving_average_filter<16, 8>(history, fixed_out);
+    moving_average_filter(history, general_out, 16, 8);
+    for (size_t i = 0; i < 16; ++i) match = match && near(fixed_out[i], general_out[i]);
+    print_array("moving_average_filter<16, 8>", fixed_out, 16);
+    
+    cumulative_sum<13>(history, fixed_out);
+    cumulative_sum(history, general_out, 13);
+    for (size_t i = 0; i < 13; ++i) match = match && near(fixed_out[i], general_out[i]);
+    std::cout << "Filter and prefix sums match general kernels: " << check_result(match) << "\n";
+}
+
+// Test function for runtime CPU feature detection and kernel dispatch
+void test_cpu_dispatch() {
+    std::cout << "\n=== Runtime CPU Dispatch ===\n";
+    std::cout << "Detected features: " << describe_cpu_features(cpu_features()) << "\n";
+    std::cout << "Selected variants: " << describe_dispatch(dispatch_table) << "\n";
+    
+    // Every selected variant must agree with the baseline build of the kernel
+    const KernelTable baseline = select_kernels(CpuFeatures{});
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> byte(-128, 127);
+    std::uniform_real_distribution<float> level(0.0f, 100.0f);
+    
+    bool match = true;
+    for (size_t count : {5, 16, 37, 1000}) {
+        std::vector<int8_t> a(count), b(count);
+        std::vector<float16_t> samples(count);
+        std::vector<uint8_t> fast(count), reference(count);
+        for (size_t i = 0; i < count; ++i) {
+            a[i] = static_cast<int8_t>(byte(gen));
+            b[i] = static_cast<int8_t>(byte(gen));
+            samples[i] = static_cast<float16_t>(level(gen));
+        }
+        
+        match = match && dispatch::dot_product_q7(a.data(), b.data(), count) ==
+                         baseline.dot_product_q7(a.data(), b.data(), count);
+        
+        dispatch::threshold_detection(samples.data(), fast.data(), count, 50.0f);
+        baseline.threshold_detection_f16(samples.data(), reference.data(), count, 50.0f);
+        match = match && fast == reference;
+    }
+    std::cout << "Selected variants match baseline: " << check_result(match) << "\n";
+}
+
+// Test function for per-core kernel tuning
+void test_kernel_tuning() {
+    std::cout << "\n=== Per-Core Kernel Tuning ===\n";
+    std::cout << "Core: " << tuned_table.tuning.core << " (shapes from " << tuned_table.tuning.source << ")\n";
+    std::cout << "Selected shapes: " << describe_tuning(tuned_table.tuning) << "\n";
+    
+    // Every compiled shape, with and without prefetch, must agree with the untuned kernels
+    std::mt19937 gen(9);
     std::uniform_real_distribution<float> dis(0.0f, 100.0f);
+    auto near = [](float a, float b) { return std::fabs(a - b) <= 1e-5f * std::fabs(b); };
+    
+    bool match = true;
+    for (size_t count : {1, 3, 4, 17, 37, 100, 1000}) {
+        std::vector<float> a(count), b(count), speeds(count), expected_speeds(count);
+        std::vector<uint8_t> detections(count), expected_detections(count);
+        for (size_t i = 0; i < count; ++i) {
+            a[i] = dis(gen);
+            b[i] = dis(gen) / 100.0f;
+        }
+        
+        const float expected_xcorr = cross_correlation(a.data(), b.data(), count);
+        float expected_weighted, expected_weights;
+        weighted_sums(a.data(), b.data(), count, expected_weighted, expected_weights);
+        speed(b.data(), a.data(), expected_speeds.data(), count, 0.1f);
+        threshold_detection(a.data(), expected_detections.data(), count, 50.0f);
+        
+        for (int k = 0; k < TUNED_KERNEL_COUNT; ++k) {
+            for (const TuningParams& shape : tuning_shapes(static_cast<TunedKernel>(k))) {
+                for (size_t prefetch : {0, 64}) {
+                    KernelTuning tuning = default_tuning("generic");
+                    tuning.params[k] = {shape.accumulators, shape.unroll, prefetch};
+                    const TunedKernelTable table = select_tuned_kernels(tuning);
+                    
+                    float weighted, weights;
+                    table.weighted_sums(a.data(), b.data(), count, weighted, weights, prefetch);
+                    table.speed(b.data(), a.data(), speeds.data(), count, 0.1f, prefetch);
+                    table.threshold_detection(a.data(), detections.data(), count, 50.0f, prefetch);
+                    match = match && near(table.cross_correlation(a.data(), b.data(), count, prefetch), expected_xcorr) &&
+                            near(weighted, expected_weighted) && near(weights, expected_weights) &&
+                            speeds == expected_speeds && detections == expected_detections;
+                }
+            }
+        }
+    }
+    std::cout << "Every shape matches the untuned kernels: " << check_result(match) << "\n";
+    
+    // One file can hold the shapes of several board types
+    KernelTuning a53 = default_tuning("cortex-a53");
+    a53.params[TUNED_SPEED] = {1, 8, 512};
+    std::stringstream file;
+    write_tuning_file(file, {{"cortex-a53", a53}, {"cortex-a76", default_tuning("cortex-a76")}});
+    std::map<std::string, KernelTuning> sections = read_tuning_file(file);
+    bool round_trip = sections.size() == 2;
+    for (int k = 0; k < TUNED_KERNEL_COUNT && round_trip; ++k) {
+        round_trip = sections["cortex-a53"].params[k] == a53.params[k] &&
+                     sections["cortex-a76"].params[k] == default_tuning("cortex-a76").params[k];
+    }
+    std::cout << "Tuning file round trip: " << check_result(round_trip) << "\n";
+    
+    std::istringstream cpuinfo("processor\t: 0\nCPU implementer\t: 0x41\nCPU part\t: 0xd05\n\n"
+                               "processor\t: 4\nCPU implementer\t: 0x41\nCPU part\t: 0xd0b\n");
+    std::cout << "CPU 4 of a DynamIQ cluster identified as: " << core_name_from_cpuinfo(cpuinfo, 4) << "\n";
+    
+    AutotuneConfig config;
+    config.compute_elements = 1024;
+    config.memory_elements = 65536;
+    config.prefetch_distances = {0, 256};
+    config.warmup_trials = 1;
+    config.trials = 3;
+    std::cout << "Quick autotune winners: " << describe_tuning(run_autotune(config).tuning) << "\n";
+}
+
+// Test function for the non-temporal streaming mode
+void test_streaming_stores() {
+    std::cout << "\n=== Streaming Stores ===\n";
+    std::cout << "Last-level cache: " << detect_llc_bytes() / 1024 << " KB, calls stream from "
+              << streaming_config().threshold_bytes / 1024 << " KB, input prefetch "
+              << streaming_config().prefetch_bytes << " bytes\n";
+    
+    // Forced streaming must match the cached path bit for bit at every cache line offset
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<float> dis(-10.0f, 10.0f);
+    const size_t window = 8;
+    
+    bool match = true;
+    for (size_t count : {5, 100, 1000, 4099}) {
+        std::vector<float> prev(count), curr(count), expected(count), streamed(count + 12);
+        for (size_t i = 0; i < count; ++i) {
+            prev[i] = dis(gen);
+            curr[i] = dis(gen);
+        }
+        
+        for (size_t offset : {0, 4, 8, 12}) {
+            float* out = streamed.data() + offset;
+            
+            speed(prev.data(), curr.data(), expected.data(), count, 0.1f);
+            speed_streaming(prev.data(), curr.data(), out, count, 0.1f);
+            match = match && std::equal(expected.begin(), expected.end(), out);
+            
+            cumulative_sum(curr.data(), expected.data(), count);
+            cumulative_sum_streaming(curr.data(), out, count, 0.0f);
+            match = match && std::equal(expected.begin(), expected.end(), out);
+            
+            moving_average_filter(curr.data(), expected.data(), count, window);
+            moving_average_filter_streaming(curr.data(), out, count, window, 0);
+            match = match && std::equal(expected.begin(), expected.end(), out);
+        }
+    }
+    std::cout << "Streaming results match cached results: " << check_result(match) << "\n";
+    std::cout << "Streaming prefetch follows the speed() tuning: "
+              << check_result(streaming_config().prefetch_bytes == tuned_table.tuning.params[TUNED_SPEED].prefetch_bytes) << "\n";
+}
+
+// Test function for interleaved (AoS) point kernels
+void test_aos_points() {
+    std::cout << "\n=== Interleaved Point Kernels ===\n";
+    
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<float> dis(-100.0f, 100.0f);
+    
+    bool distances_match = true;
+    bool transposes_match = true;
+    for (size_t count : {1, 3, 4, 7, 64, 1001}) {
+        // SoA coordinates padded to whole vectors, as the reference path needs
+        const size_t padded = (count + 3) & ~size_t(3);
+        std::vector<float> ax(padded), ay(padded), az(padded), bx(padded), by(padded), bz(padded);
+        for (size_t i = 0; i < count; ++i) {
+            ax[i] = dis(gen); ay[i] = dis(gen); az[i] = dis(gen);
+            bx[i] = dis(gen); by[i] = dis(gen); bz[i] = dis(gen);
+        }
+        
+        std::vector<float> a_xy(count * 2), b_xy(count * 2), a_xyz(count * 3), b_xyz(count * 3);
+        interleave_xy(ax.data(), ay.data(), a_xy.data(), count);
+        interleave_xy(bx.data(), by.data(), b_xy.data(), count);
+        interleave_xyz(ax.data(), ay.data(), az.data(), a_xyz.data(), count);
+        interleave_xyz(bx.data(), by.data(), bz.data(), b_xyz.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            transposes_match = transposes_match && a_xy[i * 2] == ax[i] && a_xy[i * 2 + 1] == ay[i] &&
+                               a_xyz[i * 3] == ax[i] && a_xyz[i * 3 + 1] == ay[i] && a_xyz[i * 3 + 2] == az[i];
+        }
+        
+        std::vector<float> x(count), y(count), z(count);
+        deinterleave_xy(a_xy.data(), x.data(), y.data(), count);
+        transposes_match = transposes_match && std::equal(x.begin(), x.end(), ax.begin()) &&
+                           std::equal(y.begin(), y.end(), ay.begin());
+        deinterleave_xyz(b_xyz.data(), x.data(), y.data(), z.data(), count);
+        transposes_match = transposes_match && std::equal(x.begin(), x.end(), bx.begin()) &&
+                           std::equal(y.begin(), y.end(), by.begin()) && std::equal(z.begin(), z.end(), bz.begin());
+        
+        // Every AoS distance must equal the SoA computation bit for bit
+        std::vector<float> pair_xy(count), query_xy(count), pair_xyz(count), query_xyz(count);
+        distance_squared_xy(a_xy.data(), b_xy.data(), pair_xy.data(), count);
+        distance_squared_to_point_xy(a_xy.data(), 1.5f, -2.5f, query_xy.data(), count);
+        distance_squared_xyz(a_xyz.data(), b_xyz.data(), pair_xyz.data(), count);
+        distance_squared_to_point_xyz(a_xyz.data(), 1.5f, -2.5f, 3.0f, query_xyz.data(), count);
+        
+        const float32x4_t qx = vdupq_n_f32(1.5f), qy = vdupq_n_f32(-2.5f), qz = vdupq_n_f32(3.0f);
+        for (size_t i = 0; i < count; i += 4) {
+            float32x4_t vax = vld1q_f32(&ax[i]), vay = vld1q_f32(&ay[i]), vaz = vld1q_f32(&az[i]);
+            float32x4_t vbx = vld1q_f32(&bx[i]), vby = vld1q_f32(&by[i]), vbz = vld1q_f32(&bz[i]);
+            float expected[4][4];
+            vst1q_f32(expected[0], vector_distance_squared(vax, vay, vbx, vby));
+            vst1q_f32(expected[1], vector_distance_squared(qx, qy, vax, vay));
+            vst1q_f32(expected[2], vector_distance_squared_xyz(vax, vay, vaz, vbx, vby, vbz));
+            vst1q_f32(expected[3], vector_distance_squared_xyz(qx, qy, qz, vax, vay, vaz));
+            for (size_t k = 0; k < 4 && i + k < count; ++k) {
+                distances_match = distances_match && pair_xy[i + k] == expected[0][k] &&
+                                  query_xy[i + k] == expected[1][k] && pair_xyz[i + k] == expected[2][k] &&
+                                  query_xyz[i + k] == expected[3][k];
+            }
+        }
+    }
+    
+    float points[] = {0.0f, 0.0f, 3.0f, 4.0f, -6.0f, 8.0f};
+    float distances[3];
+    distance_squared_to_point_xy(points, 0.0f, 0.0f, distances, 3);
+    std::cout << "Squared distances of (0,0), (3,4), (-6,8) from the origin: "
+              << distances[0] << ", " << distances[1] << ", " << distances[2] << "\n";
+    std::cout << "AoS/SoA transposes round trip: " << check_result(transposes_match) << "\n";
+    std::cout << "AoS distances match SoA distances: " << check_result(distances_match) << "\n";
+}
+
+// Test function for the fused nearest-point queries
+void test_nearest_point() {
+    std::cout << "\n=== Nearest Point Queries ===\n";
+    
+    // Integer grid coordinates, so equal distances (ties) are common
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<int> dis(-20, 20);
+    
+    bool single_match = true;
+    bool batch_match = true;
+    for (size_t count : {1, 3, 4, 7, 64, 1001}) {
+        std::vector<float> x(count), y(count), xy(count * 2), distances(count);
+        for (size_t i = 0; i < count; ++i) {
+            x[i] = static_cast<float>(dis(gen));
+            y[i] = static_cast<float>(dis(gen));
+        }
+        interleave_xy(x.data(), y.data(), xy.data(), count);
+        
+        for (size_t num_queries : {1, 3, 4, 5, 8, 13}) {
+            std::vector<float> qx(num_queries), qy(num_queries), q_xy(num_queries * 2);
+            for (size_t q = 0; q < num_queries; ++q) {
+                qx[q] = static_cast<float>(dis(gen));
+                qy[q] = static_cast<float>(dis(gen));
+            }
+            interleave_xy(qx.data(), qy.data(), q_xy.data(), num_queries);
+            
+            std::vector<NearestPoint> soa(num_queries), aos(num_queries);
+            nearest_points(x.data(), y.data(), count, qx.data(), qy.data(), num_queries, soa.data());
+            nearest_points_xy(xy.data(), count, q_xy.data(), num_queries, aos.data());
+            
+            // Reference: write every distance, then min_index over them
+            for (size_t q = 0; q < num_queries; ++q) {
+                distance_squared_to_point_xy(xy.data(), qx[q], qy[q], distances.data(), count);
+                const size_t expected = min_index(distances.data(), count);
+                
+                const NearestPoint a = nearest_point(x.data(), y.data(), count, qx[q], qy[q]);
+                const NearestPoint b = nearest_point_xy(xy.data(), count, qx[q], qy[q]);
+                single_match = single_match && a.index == expected && b.index == expected &&
+                               a.distance_squared == distances[expected] && b.distance_squared == distances[expected];
+                batch_match = batch_match && soa[q].index == expected && aos[q].index == expected &&
+                              soa[q].distance_squared == distances[expected] &&
+                              aos[q].distance_squared == distances[expected];
+            }
+        }
+    }
+    
+    float track_x[] = {4.0f, -3.0f};
+    float track_y[] = {4.0f, 1.0f};
+    float detections[] = {0.0f, 0.0f, 3.0f, 5.0f, -2.0f, 1.0f, 10.0f, 10.0f, 4.0f, 4.5f};
+    float detection_x[5], detection_y[5];
+    deinterleave_xy(detections, detection_x, detection_y, 5);
+    NearestPoint matches[2];
+    nearest_points(detection_x, detection_y, 5, track_x, track_y, 2, matches);
+    std::cout << "Track (4,4) nearest detection: " << matches[0].index << " (distance^2 " << matches[0].distance_squared
+              << "), track (-3,1): " << matches[1].index << " (distance^2 " << matches[1].distance_squared << ")\n";
+    std::cout << "Single-query nearest point matches distances + min_index: " << check_result(single_match) << "\n";
+    std::cout << "Batched nearest points match distances + min_index: " << check_result(batch_match) << "\n";
+    
+    // No points: the index says so, with no infinity for -ffast-math to fold away
+    NearestPoint none[5];
+    nearest_points(detection_x, detection_y, 0, track_x, track_y, 1, none);
+    nearest_points_xy(detections, 0, detections, 4, none + 1);
+    bool empty_match = nearest_point(detection_x, detection_y, 0, 1.0f, 2.0f).index == NEAREST_POINT_NONE &&
+                       nearest_point_xy(detections, 0, 1.0f, 2.0f).index == NEAREST_POINT_NONE;
+    for (const NearestPoint& result : none) empty_match = empty_match && result.index == NEAREST_POINT_NONE;
+    std::cout << "Empty point sets report no nearest point: " << check_result(empty_match) << "\n";
+}
+
+// Test function for the 2D/3D kinematics kernel
+void test_kinematics() {
+    std::cout << "\n=== Track Kinematics ===\n";
+    
+    // Object on a circle of radius 10 at 1 rad/s, sampled at 10 Hz, one frame per angle
+    const float dt = 0.1f;
+    float cx[3], cy[3];
+    for (int f = 0; f < 3; ++f) {
+        cx[f] = 10.0f * std::cos(0.5f + f * dt);
+        cy[f] = 10.0f * std::sin(0.5f + f * dt);
+    }
+    float vx, vy, speed_out, heading, ax, ay;
+    KinematicsOutput circle = {&vx, &vy, nullptr, &speed_out, &heading, &ax, &ay, nullptr};
+    kinematics({&cx[0], &cy[0], nullptr}, {&cx[1], &cy[1], nullptr}, {&cx[2], &cy[2], nullptr},
+               circle, 1, dt, DifferenceMode::Central);
+    std::cout << "Circle (central): speed " << speed_out << " (exact 10), heading " << heading
+              << " (exact " << 0.6f + 1.5707963f << "), |a| " << std::sqrt(ax * ax + ay * ay) << " (exact 10)\n";
+    
+    std::mt19937 gen(19);
+    std::uniform_real_distribution<float> dis(-50.0f, 50.0f);
+    
+    bool velocity_match = true;
+    bool derived_match = true;
+    for (size_t count : {1, 3, 4, 7, 1001}) {
+        std::vector<float> pos[3][3];
+        for (auto& frame : pos) {
+            for (auto& coord : frame) {
+                coord.resize(count);
+                for (float& v : coord) v = dis(gen);
+            }
+        }
+        std::vector<float> out[8], reference(count);
+        for (auto& o : out) o.resize(count);
+        
+        for (bool three_d : {false, true}) {
+            for (DifferenceMode mode : {DifferenceMode::Backward, DifferenceMode::Central}) {
+                PositionFrame frames[3];
+                for (int f = 0; f < 3; ++f) {
+                    frames[f] = {pos[f][0].data(), pos[f][1].data(), three_d ? pos[f][2].data() : nullptr};
+                }
+                KinematicsOutput result = {out[0].data(), out[1].data(), out[2].data(), out[3].data(),
+                                           out[4].data(), out[5].data(), out[6].data(), out[7].data()};
+                kinematics(frames[0], frames[1], frames[2], result, count, dt, mode);
+                
+                // Backward velocities are exactly speed() per coordinate
+                const bool central = mode == DifferenceMode::Central;
+                for (int c = 0; c < (three_d ? 3 : 2); ++c) {
+                    if (central) continue;
+                    speed(pos[1][c].data(), pos[2][c].data(), reference.data(), count, dt);
+                    velocity_match = velocity_match && std::equal(reference.begin(), reference.end(), out[c].begin());
+                }
+                
+                for (size_t i = 0; i < count; ++i) {
+                    double v[3], a[3], speed_sq = 0.0;
+                    for (int c = 0; c < 3; ++c) {
+                        const double o = pos[0][c][i], p = pos[1][c][i], n = pos[2][c][i];
+                        v[c] = central ? (n - o) / (2.0 * dt) : (n - p) / dt;
+                        a[c] = (n - 2.0 * p + o) / (static_cast<double>(dt) * dt);
+                        if (c < 2 || three_d) speed_sq += v[c] * v[c];
+                    }
+                    auto close = [](double got, double want, double tol) {
+                        return std::fabs(got - want) <= tol * std::max(1.0, std::fabs(want));
+                    };
+                    derived_match = derived_match && close(out[0][i], v[0], 1e-5) && close(out[1][i], v[1], 1e-5) &&
+                                    close(out[3][i], std::sqrt(speed_sq), 1e-5) &&
+                                    close(out[4][i], std::atan2(out[1][i], out[0][i]), 1e-6) &&
+                                    close(out[5][i], a[0], 1e-4) && close(out[6][i], a[1], 1e-4) &&
+                                    (!three_d || (close(out[2][i], v[2], 1e-5) && close(out[7][i], a[2], 1e-4)));
+                }
+            }
+        }
+    }
+    std::cout << "Backward velocities match speed(): " << check_result(velocity_match) << "\n";
+    std::cout << "Speed, heading and acceleration match scalar reference: " << check_result(derived_match) << "\n";
+}
+
+// Test function for the vector math library
+void test_simd_math() {
+    std::cout << "\n=== Vector Math (simd_math.h) ===\n";
+    
+    float angles[] = {0.0f, 0.5235988f, -1.0471976f, 2.3561945f};
+    float result[4];
+    vst1q_f32(result, sin_f32x4(vld1q_f32(angles)));
+    print_array("sin(0, pi/6, -pi/3, 3pi/4)", result, 4);
+    vst1q_f32(result, exp_f32x4(vld1q_f32(angles)));
+    print_array("exp(0, pi/6, -pi/3, 3pi/4)", result, 4);
+    
+    // Largest error against double-precision libm over a sweep, relative to max(1, |f(x)|)
+    using Vector = float32x4_t (*)(float32x4_t);
+    using Scalar = double (*)(double);
+    struct Case {
+        const char* name;
+        Vector precise, fast;
+        Scalar reference;
+        float lo, hi;
+    };
+    const Case cases[] = {
+        {"rsqrt", rsqrt_f32x4<MathAccuracy::Precise>, rsqrt_f32x4<MathAccuracy::Fast>,
+         [](double x) { return 1.0 / std::sqrt(x); }, 0.01f, 1000.0f},
+        {"sqrt", sqrt_f32x4<MathAccuracy::Precise>, sqrt_f32x4<MathAccuracy::Fast>,
+         [](double x) { return std::sqrt(x); }, 0.0f, 1000.0f},
+        {"exp", exp_f32x4<MathAccuracy::Precise>, exp_f32x4<MathAccuracy::Fast>,
+         [](double x) { return std::exp(x); }, -80.0f, 80.0f},
+        {"log", log_f32x4<MathAccuracy::Precise>, log_f32x4<MathAccuracy::Fast>,
+         [](double x) { return std::log(x); }, 1e-6f, 1e6f},
+        {"sin", sin_f32x4<MathAccuracy::Precise>, sin_f32x4<MathAccuracy::Fast>,
+         [](double x) { return std::sin(x); }, -100.0f, 100.0f},
+        {"cos", cos_f32x4<MathAccuracy::Precise>, cos_f32x4<MathAccuracy::Fast>,
+         [](double x) { return std::cos(x); }, -100.0f, 100.0f},
+    };
+    
+    std::mt19937 rng(50);
+    bool precise_ok = true, fast_ok = true;
+    for (const Case& c : cases) {
+        std::uniform_real_distribution<float> dist(c.lo, c.hi);
+        double precise_err = 0.0, fast_err = 0.0;
+        for (int iter = 0; iter < 20000; ++iter) {
+            float x[4], p[4], f[4];
+            for (float& v : x) v = dist(rng);
+            vst1q_f32(p, c.precise(vld1q_f32(x)));
+            vst1q_f32(f, c.fast(vld1q_f32(x)));
+            for (int k = 0; k < 4; ++k) {
+                const double want = c.reference(x[k]);
+                const double scale = std::max(1.0, std::fabs(want));
+                precise_err = std::max(precise_err, std::fabs(p[k] - want) / scale);
+                fast_err = std::max(fast_err, std::fabs(f[k] - want) / scale);
+            }
+        }
+        std::cout << c.name << ": precise error " << std::scientific << std::setprecision(1) << precise_err
+                  << ", fast error " << fast_err << std::fixed << std::setprecision(3) << "\n";
+        precise_ok = precise_ok && precise_err < 4e-7;
+        fast_ok = fast_ok && fast_err < 2e-5;
+    }
+    
+    // atan2 over the full circle, including the axes and the origin
+    double atan2_err = 0.0;
+    for (int i = 0; i < 4096; i += 4) {
+        float y[4], x[4], a[4];
+        for (int k = 0; k < 4; ++k) {
+            const double angle = (i + k) * (2.0 * M_PI / 4096) - M_PI;
+            y[k] = static_cast<float>(3.0 * std::sin(angle));
+            x[k] = static_cast<float>(3.0 * std::cos(angle));
+        }
+        vst1q_f32(a, atan2_f32x4(vld1q_f32(y), vld1q_f32(x)));
+        for (int k = 0; k < 4; ++k) atan2_err = std::max(atan2_err, std::fabs(a[k] - std::atan2(static_cast<double>(y[k]), x[k])));
+    }
+    const float zeros[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    vst1q_f32(result, atan2_f32x4(vld1q_f32(zeros), vld1q_f32(zeros)));
+    std::cout << "atan2: error " << std::scientific << std::setprecision(1) << atan2_err
+              << std::fixed << std::setprecision(3) << ", atan2(0, 0) = " << result[0] << "\n";
+    precise_ok = precise_ok && atan2_err < 4e-7 && result[0] == 0.0f;
+    
+    // Special cases, checked on the bit patterns since -ffast-math folds isinf() and isnan() to false
+    const float exp_in[4] = {100.0f, -200.0f, 0.0f, 1.0f};
+    const float log_in[4] = {0.0f, -1.0f, 1.0f, 2.0f};
+    uint32_t exp_bits[4], log_bits[4];
+    vst1q_u32(exp_bits, vreinterpretq_u32_f32(exp_f32x4(vld1q_f32(exp_in))));
+    vst1q_u32(log_bits, vreinterpretq_u32_f32(log_f32x4(vld1q_f32(log_in))));
+    const bool specials_ok = exp_bits[0] == 0x7f800000u && exp_bits[1] == 0u && exp_bits[2] == 0x3f800000u &&
+                             log_bits[0] == 0xff800000u && (log_bits[1] & 0x7fffffffu) > 0x7f800000u &&
+                             log_bits[2] == 0u;
+    
+    std::cout << "Precise level within bounds: " << check_result(precise_ok) << "\n";
+    std::cout << "Fast level within bounds: " << check_result(fast_ok) << "\n";
+    std::cout << "Overflow, underflow, log(0) and log(-1) handled: " << check_result(specials_ok) << "\n";
+}
+
+// Test function for Q15/Q7 fixed-point kernels
+void test_fixed_point_kernels() {
+    std::cout << "\n=== Fixed-Point (Q15/Q7) Kernels ===\n";
+    
+    int16_t adc[] = {1200, -800, 3400, 2900, -150, 4100, 600, -2200, 3000, 1800, -900, 2500};
+    int16_t gains[] = {16384, 16384, 16384, 16384, 8192, 8192, 8192, 8192, 4096, 4096, 4096, 4096};
+    int16_t filtered[12];
+    int64_t running[12];
+    uint8_t detections[12];
+    size_t count = sizeof(adc) / sizeof(adc[0]);
+    
+    print_int16_array("ADC samples", adc, count);
+    
+    int64_t dot = dot_product_q15(adc, gains, count);
+    std::cout << "Q15 dot product (Q30): " << dot << " (" << std::fixed << std::setprecision(3)
+              << std::ldexp(static_cast<double>(dot), -15) << " in sample units)\n";
+    
+    moving_average_filter_q15(adc, filtered, count, 3);
+    print_int16_array("Q15 moving average (window 3)", filtered, count);
+    
+    // Equal windows must round alike in the warm-up and the vector part: every pair here averages -1.5
+    int16_t alternating[] = {-1, -2, -1, -2, -1, -2, -1, -2, -1, -2, -1, -2};
+    moving_average_filter_q15(alternating, filtered, count, 2);
+    bool rounding_consistent = std::all_of(filtered + 1, filtered + count, [](int16_t v) { return v == -1; });
+    
+    // Exact rounding against a 64-bit reference, including ties and windows large enough to stress the reciprocal
+    std::mt19937 rng(26);
+    bool average_exact = true;
+    for (size_t window : {2, 6, 7, 100, 4096, 65535}) {
+        std::vector<int16_t> signal(window + 300), averaged(signal.size());
+        std::uniform_int_distribution<int> sample(window > 1000 ? 32000 : -32768, 32767);
+        for (int16_t& v : signal) v = static_cast<int16_t>(sample(rng));
+        moving_average_filter_q15(signal.data(), averaged.data(), signal.size(), window);
+        
+        int64_t sum = 0;
+        for (size_t i = 0; i < signal.size(); ++i) {
+            sum += signal[i] - (i >= window ? signal[i - window] : 0);
+            const int64_t n = static_cast<int64_t>(std::min(i + 1, window));
+            const int64_t numerator = 2 * sum + n;
+            const int64_t want = numerator / (2 * n) - (numerator % (2 * n) < 0 ? 1 : 0);
+            average_exact = average_exact && averaged[i] == want;
+        }
+    }
+    std::cout << "Q15 moving average rounds halves up consistently: " << check_result(rounding_consistent) << "\n";
+    std::cout << "Q15 moving average matches exact rounding: " << check_result(average_exact) << "\n";
+    
+    int16_t taps[] = {16384, 8192, 8192};
+    fir_filter_q15(adc, filtered, count, taps, 3);
+    print_int16_array("Q15 FIR {0.5, 0.25, 0.25}", filtered, count);
+    
+    cumulative_sum_q15(adc, running, count);
+    std::cout << "Q15 cumulative sum (last): " << running[count - 1] << "\n";
+    
+    // Full-scale samples well past 2^16, where a 32-bit running sum would wrap
+    std::vector<int16_t> full_scale(3 * 65536 + 5, INT16_MAX);
+    full_scale[70000] = INT16_MIN;
+    std::vector<int64_t> long_sums(full_scale.size());
+    cumulative_sum_q15(full_scale.data(), long_sums.data(), full_scale.size());
+    bool long_sums_exact = true;
+    int64_t expected_sum = 0;
+    for (size_t i = 0; i < full_scale.size(); ++i) {
+        expected_sum += full_scale[i];
+        long_sums_exact = long_sums_exact && long_sums[i] == expected_sum;
+    }
+    std::cout << "Q15 cumulative sum exact past 2^16 full-scale samples: " << check_result(long_sums_exact) << "\n";
+    
+    threshold_detection(adc, detections, count, int16_t{2000});
+    print_uint8_array("Q15 detections (> 2000)", detections, count);
+    
+    size_t min_idx = min_index(adc, count);
+    std::cout << "Q15 minimum index: " << min_idx << " (value " << adc[min_idx] << ")\n";
+    
+    int8_t pixels[] = {12, -40, 90, 33, -128, 7, 64, -5, 18, 100, -60, 2, 45, -9, 77, 30, -1};
+    size_t pixel_count = sizeof(pixels) / sizeof(pixels[0]);
+    std::cout << "Q7 dot product with itself (Q14): " << dot_product_q7(pixels, pixels, pixel_count) << "\n";
+    std::cout << "Q7 minimum index: " << min_index(pixels, pixel_count) << "\n";
+}
+
+// Test function for the expression-template layer
+void test_expression_templates() {
+    std::cout << "\n=== Expression Templates ===\n";
+    
+    float prev_positions[] = {0.0f, 10.0f, 25.0f, 45.0f, 70.0f, 100.0f, 130.0f};
+    float curr_positions[] = {5.0f, 20.0f, 40.0f, 65.0f, 95.0f, 130.0f, 170.0f};
+    size_t count = sizeof(prev_positions) / sizeof(prev_positions[0]);
+    const float inv_dt = 1.0f / 0.1f;
+    
+    expr::Span prev(prev_positions, count);
+    expr::Span curr(curr_positions, count);
+    
+    // One fused loop: difference, scale and clamp
+    float clamped[7];
+    expr::eval(clamped, expr::clamp((curr - prev) * inv_dt, 0.0f, 250.0f));
+    print_array("Clamped speeds", clamped, count);
+    
+    uint8_t fast[7];
+    expr::eval(fast, (curr - prev) * inv_dt > 200.0f);
+    print_uint8_array("Speed > 200", fast, count);
+    
+    expr::Vec speeds(count);
+    speeds = (curr - prev) * inv_dt;
+    std::cout << "Mean speed: " << expr::sum(speeds) / count << "\n";
+    std::cout << "Max speed: " << expr::max_value(speeds) << "\n";
+    std::cout << "Tracks over 200: " << expr::count(speeds > 200.0f) << "\n";
+    
+    // Operands of different sizes are an error, not a silent truncation
+    bool mismatch_rejected = false;
+    try {
+        expr::eval(clamped, curr - expr::Span(prev_positions, count - 1));
+    } catch (const std::invalid_argument&) {
+        mismatch_rejected = true;
+    }
+    std::cout << "Mismatched operand sizes rejected: " << check_result(mismatch_rejected) << "\n";
+    
+    // Shrinking a Vec from an expression over its own elements
+    expr::Vec doubled(count);
+    doubled = curr;
+    doubled = expr::Span(doubled.data() + 1, count - 2) * 2.0f;
+    bool self_assign_ok = doubled.size() == count - 2;
+    for (size_t i = 0; self_assign_ok && i < count - 2; ++i) {
+        self_assign_ok = doubled[i] == curr_positions[i + 1] * 2.0f;
+    }
+    std::cout << "Vec assignment from its own elements: " << check_result(self_assign_ok) << "\n";
+}
+
+// Test function for ragged batch kernels
+void test_batch_kernels() {
+    std::cout << "\n=== Ragged Batch Kernels ===\n";
+    
+    // Three tracks of 5, 7 and 3 samples concatenated into one buffer
+    float values[] = {4.0f, 2.0f, 9.0f, 1.0f, 6.0f,
+                      3.0f, 8.0f, 0.5f, 7.0f, 2.5f, 5.0f, 0.5f,
+                      10.0f, 11.0f, 9.5f};
+    float weights[] = {1.0f, 1.0f, 2.0f, 0.5f, 0.5f,
+                       0.2f, 0.2f, 0.2f, 0.2f, 0.2f, 0.2f, 0.2f,
+                       1.0f, 0.0f, 3.0f};
+    size_t offsets[] = {0, 5, 12, 15};
+    const size_t num_tracks = 3;
     
-    for (size_t i = 0; i < test_size; ++i) {
-        large_array[i] = dis(gen);
+    float averages[num_tracks];
+    float correlations[num_tracks];
+    size_t minima[num_tracks];
+    
+    weighted_average_batch(values, weights, offsets, num_tracks, averages);
+    cross_correlation_batch(values, weights, offsets, num_tracks, correlations);
+    min_index_batch(values, offsets, num_tracks, minima);
+    
+    for (size_t t = 0; t < num_tracks; ++t) {
+        const size_t begin = offsets[t];
+        const size_t length = offsets[t + 1] - begin;
+        std::cout << "Track " << t << " (" << length << " samples): weighted avg "
+                  << std::fixed << std::setprecision(3) << averages[t]
+                  << " (single: " << weighted_average(&values[begin], &weights[begin], length) << ")"
+                  << ", correlation " << correlations[t]
+                  << ", min index " << minima[t] << "\n";
+    }
+    
+    // Ragged lengths including empty segments, with repeated values so that ties are common
+    std::mt19937 rng(30);
+    std::uniform_int_distribution<int> length_dist(0, 40), value_dist(-20, 20);
+    std::vector<size_t> ragged_offsets = {0};
+    for (int t = 0; t < 37; ++t) ragged_offsets.push_back(ragged_offsets.back() + length_dist(rng));
+    std::vector<float> ragged(ragged_offsets.back());
+    for (float& v : ragged) v = static_cast<float>(value_dist(rng));
+    
+    const size_t ragged_tracks = ragged_offsets.size() - 1;
+    std::vector<size_t> ragged_minima(ragged_tracks);
+    min_index_batch(ragged.data(), ragged_offsets.data(), ragged_tracks, ragged_minima.data());
+    bool match = true;
+    for (size_t t = 0; t < ragged_tracks; ++t) {
+        const size_t length = ragged_offsets[t + 1] - ragged_offsets[t];
+        match = match && ragged_minima[t] == min_index(&ragged[ragged_offsets[t]], length);
+    }
+    std::cout << "Batched min indices match min_index: " << check_result(match) << "\n";
+}
+
+// Test function for the fused speed -> EMA -> threshold pipeline
+void test_fused_pipeline() {
+    std::cout << "\n=== Fused Speed -> EMA -> Threshold Pipeline ===\n";
+    
+    const size_t count = 5000;
+    const float time_delta = 0.1f;
+    const float alpha = 0.3f;
+    const float threshold = 12.0f;
+    
+    std::vector<float> prev(count), curr(count);
+    for (size_t i = 0; i < count; ++i) {
+        prev[i] = static_cast<float>(i);
+        curr[i] = prev[i] + 1.0f + 0.5f * std::sin(0.01f * i);
+    }
+    
+    // Separate passes with intermediate arrays
+    std::vector<float> speeds(count), smoothed(count);
+    std::vector<uint8_t> expected(count), fused(count);
+    speed(prev.data(), curr.data(), speeds.data(), count, time_delta);
+    exp_moving_average(speeds.data(), smoothed.data(), count, alpha);
+    threshold_detection(smoothed.data(), expected.data(), count, threshold);
+    
+    // Single blocked pass
+    speed_ema_threshold(prev.data(), curr.data(), fused.data(), count, time_delta, alpha, threshold);
+    
+    size_t detections = 0;
+    bool match = true;
+    for (size_t i = 0; i < count; ++i) {
+        detections += fused[i];
+        match = match && fused[i] == expected[i];
+    }
+    
+    std::cout << "Elements: " << count << ", block size: " << PIPELINE_BLOCK_SIZE << "\n";
+    std::cout << "Detections: " << detections << "\n";
+    std::cout << "Matches separate kernels: " << check_result(match) << "\n";
+}
+
+// Test function for the thread-pool parallel kernels
+void test_parallel_kernels() {
+    std::cout << "\n=== Parallel Kernels ===\n";
+    
+    const size_t count = 1 << 21;
+    std::vector<float> values(count), weights(count);
+    std::vector<uint8_t> detections(count);
+    
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dis(0.0f, 100.0f);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = dis(gen);
         weights[i] = dis(gen) / 100.0f;
     }
     
-    std::cout << "Testing with " << test_size << " elements...\n";
+    ThreadPool& pool = default_thread_pool();
+    std::cout << "Threads: " << pool.concurrency() << ", elements: " << count << "\n";
+    
+    float avg = weighted_average_parallel(values.data(), weights.data(), count);
+    float corr = cross_correlation_parallel(values.data(), weights.data(), count);
+    size_t min_idx = min_index_parallel(values.data(), count);
+    threshold_detection_parallel(values.data(), detections.data(), count, 99.0f);
     
+    size_t hits = 0;
+    for (uint8_t d : detections) hits += d;
+    
+    std::cout << "Weighted average: " << std::fixed << std::setprecision(4) << avg
+              << " (serial " << weighted_average(values.data(), weights.data(), count) << ")\n";
+    std::cout << "Cross-correlation: " << std::setprecision(1) << corr
+              << " (serial " << cross_correlation(values.data(), weights.data(), count) << ")\n";
+    std::cout << "Minimum index: " << min_idx << " (serial " << min_index(values.data(), count) << ")\n";
+    std::cout << "Values above 99: " << hits << "\n";
+    
+    // Fork-join round trip with trivial tasks
+    const int rounds = 10000;
     auto start = std::chrono::high_resolution_clock::now();
-    float result = weighted_average(large_array.data(), weights.data(), test_size);
+    for (int r = 0; r < rounds; ++r) {
+        pool.parallel_for(pool.concurrency(), [](size_t) {});
+    }
     auto end = std::chrono::high_resolution_clock::now();
+    double per_round = std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+    std::cout << "Fork-join latency: " << std::setprecision(2) << per_round << " microseconds\n";
+}
+
+// Test function for the work-stealing task graph
+void test_task_scheduler() {
+    std::cout << "\n=== Work-Stealing Task Graph ===\n";
+    
+    // Uneven per-track lengths, as in a real frame
+    const size_t num_tracks = 64;
+    const float time_delta = 0.1f;
+    std::vector<std::vector<float>> prev(num_tracks), curr(num_tracks), speeds(num_tracks), smoothed(num_tracks);
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> dis(0.0f, 10.0f);
+    for (size_t t = 0; t < num_tracks; ++t) {
+        const size_t len = 16 + (t * 37 % 61) * 64;
+        prev[t].resize(len);
+        curr[t].resize(len);
+        speeds[t].resize(len);
+        smoothed[t].resize(len);
+        for (size_t i = 0; i < len; ++i) {
+            prev[t][i] = dis(gen);
+            curr[t][i] = prev[t][i] + dis(gen) * 0.1f;
+        }
+    }
+    
+    // speed -> filter per track, then one weighted average per cluster of 8 tracks
+    const size_t cluster_size = 8;
+    std::vector<float> cluster_avg(num_tracks / cluster_size);
+    float frame_avg = 0.0f;
+    
+    TaskGraph graph;
+    std::vector<TaskGraph::TaskId> filters;
+    for (size_t t = 0; t < num_tracks; ++t) {
+        TaskGraph::TaskId s = graph.add([&, t] {
+            speed(prev[t].data(), curr[t].data(), speeds[t].data(), speeds[t].size(), time_delta);
+        });
+        TaskGraph::TaskId f = graph.add([&, t] {
+            moving_average_filter(speeds[t].data(), smoothed[t].data(), speeds[t].size(), 4);
+        });
+        graph.precede(s, f);
+        filters.push_back(f);
+    }
+    
+    TaskGraph::TaskId frame = graph.add([&] {
+        frame_avg = weighted_average(cluster_avg.data(), cluster_avg.data(), cluster_avg.size());
+    });
+    for (size_t c = 0; c < cluster_avg.size(); ++c) {
+        TaskGraph::TaskId w = graph.add([&, c] {
+            float sum = 0.0f;
+            for (size_t t = c * cluster_size; t < (c + 1) * cluster_size; ++t) {
+                sum += weighted_average(smoothed[t].data(), curr[t].data(), smoothed[t].size());
+            }
+            cluster_avg[c] = sum / cluster_size;
+        });
+        for (size_t t = c * cluster_size; t < (c + 1) * cluster_size; ++t) {
+            graph.precede(filters[t], w);
+        }
+        graph.precede(w, frame);
+    }
+    
+    WorkStealingScheduler scheduler(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+    const int frames = 20;
+    for (int f = 0; f < frames; ++f) {
+        scheduler.run(graph);
+    }
+    
+    // Serial reference
+    std::vector<float> expected_clusters(cluster_avg.size());
+    for (size_t c = 0; c < expected_clusters.size(); ++c) {
+        float sum = 0.0f;
+        for (size_t t = c * cluster_size; t < (c + 1) * cluster_size; ++t) {
+            std::vector<float> s(speeds[t].size()), m(speeds[t].size());
+            speed(prev[t].data(), curr[t].data(), s.data(), s.size(), time_delta);
+            moving_average_filter(s.data(), m.data(), s.size(), 4);
+            sum += weighted_average(m.data(), curr[t].data(), m.size());
+        }
+        expected_clusters[c] = sum / cluster_size;
+    }
+    float expected = weighted_average(expected_clusters.data(), expected_clusters.data(), expected_clusters.size());
+    
+    const SchedulerStats& stats = scheduler.last_run_stats();
+    std::cout << "Tasks per frame: " << graph.size() << ", participants: " << scheduler.concurrency() << "\n";
+    std::cout << "Frame average: " << std::fixed << std::setprecision(4) << frame_avg
+              << " (serial " << expected << ")\n";
+    std::cout << "Last frame wall time: " << std::setprecision(1) << stats.wall_ns / 1000.0 << " microseconds\n";
+    for (size_t w = 0; w < stats.workers.size(); ++w) {
+        std::cout << "  Worker " << w << ": " << stats.workers[w].tasks << " tasks, "
+                  << stats.workers[w].steals << " steals, "
+                  << std::setprecision(1) << 100.0 * stats.utilization(w) << "% busy\n";
+    }
+}
+
+// Test function for the frame arena and the aligned kernel overloads
+void test_aligned_arena() {
+    std::cout << "\n=== Frame Arena and Aligned Kernels ===\n";
+    
+    const size_t count = 1000;  // deliberately not a multiple of 16
+    const float time_delta = 0.1f;
+    const float threshold = 15.0f;
+    FrameArena arena(1 << 20);
+    
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<float> dis(0.0f, 2.0f);
+    
+    float avg = 0.0f;
+    size_t min_idx = 0, hits = 0;
+    bool match = true;
+    const int frames = 100;
+    for (int f = 0; f < frames; ++f) {
+        // Per-frame scratch comes from the arena, not malloc
+        arena.reset();
+        AlignedSpan<float> prev = arena.allocate_span<float>(count);
+        AlignedSpan<float> curr = arena.allocate_span<float>(count);
+        AlignedSpan<float> speeds = arena.allocate_span<float>(count);
+        AlignedSpan<uint8_t> detections = arena.allocate_span<uint8_t>(count);
+        
+        for (size_t i = 0; i < count; ++i) {
+            prev[i] = static_cast<float>(i);
+            curr[i] = prev[i] + dis(gen);
+        }
+        
+        speed(aligned, prev.data(), curr.data(), speeds.data(), count, time_delta);
+        threshold_detection(aligned, speeds.data(), detections.data(), count, threshold);
+        avg = weighted_average(aligned, speeds.data(), curr.data(), count);
+        min_idx = min_index(aligned, speeds.data(), count);
+        
+        hits = 0;
+        for (uint8_t d : detections) hits += d;
+        
+        if (f == frames - 1) {
+            std::vector<float> expected(count);
+            std::vector<uint8_t> expected_det(count);
+            speed(prev.data(), curr.data(), expected.data(), count, time_delta);
+            threshold_detection(expected.data(), expected_det.data(), count, threshold);
+            for (size_t i = 0; i < count; ++i) {
+                match = match && speeds[i] == expected[i] && detections[i] == expected_det[i];
+            }
+            match = match && min_idx == min_index(expected.data(), count);
+            
+            // Recurrence and window kernels, with windows that end the warm-up mid-line and past it
+            AlignedSpan<float> sums = arena.allocate_span<float>(count);
+            cumulative_sum(aligned, speeds.data(), sums.data(), count);
+            cumulative_sum(expected.data(), expected.data(), count);
+            for (size_t i = 0; i < count; ++i) match = match && sums[i] == expected[i];
+            for (size_t window : {1, 5, 16, 23}) {
+                moving_average_filter(aligned, speeds.data(), sums.data(), count, window);
+                moving_average_filter(speeds.data(), expected.data(), count, window);
+                for (size_t i = 0; i < count; ++i) match = match && sums[i] == expected[i];
+            }
+            std::cout << "Weighted average: " << std::fixed << std::setprecision(4) << avg
+                      << " (unaligned " << weighted_average(expected.data(), curr.data(), count) << ")\n";
+        }
+    }
+    
+    std::cout << "Frames: " << frames << ", arena high water: " << arena.high_water() << " bytes\n";
+    std::cout << "Minimum speed index: " << min_idx << ", detections: " << hits << "\n";
+    std::cout << "Matches unaligned kernels: " << check_result(match) << "\n";
+}
+
+// Test function for kernels running over a memory-mapped recording
+void test_mapped_recording() {
+    std::cout << "\n=== Memory-Mapped Recording Replay ===\n";
+    
+    const size_t num_channels = 4;
+    const size_t num_samples = 100000;
+    const size_t chunk_samples = 4096;
+    const size_t window = 8;
+    const float alpha = 0.2f;
+    const float threshold = 0.9f;
+    const std::string path = "/tmp/armsimd_recording_demo.bin";
+    
+    std::vector<std::vector<float>> columns(num_channels, std::vector<float>(num_samples));
+    for (size_t c = 0; c < num_channels; ++c) {
+        for (size_t i = 0; i < num_samples; ++i) {
+            columns[c][i] = std::sin(0.001f * i * (c + 1)) + 0.1f * std::cos(0.37f * i);
+        }
+    }
+    const float* pointers[num_channels] = {columns[0].data(), columns[1].data(), columns[2].data(), columns[3].data()};
+    write_recording(path, pointers, num_channels, num_samples);
+    
+    MappedRecording recording(path);
+    
+    // Stream channel 2 through moving average -> EMA -> threshold, one chunk at a time
+    std::vector<float> filtered(num_samples), smoothed(num_samples);
+    std::vector<uint8_t> detections(num_samples);
+    StreamingMovingAverage moving_average{window};
+    StreamingEma ema(alpha);
+    recording.for_each_chunk(2, chunk_samples, [&](const float* chunk, size_t n, size_t offset) {
+        moving_average.process(chunk, &filtered[offset], n, offset);
+        ema.process(&filtered[offset], &smoothed[offset], n);
+        threshold_detection(&smoothed[offset], &detections[offset], n, threshold);
+    });
+    
+    // Whole-array reference
+    std::vector<float> expected_filtered(num_samples), expected_smoothed(num_samples);
+    std::vector<uint8_t> expected_detections(num_samples);
+    moving_average_filter(columns[2].data(), expected_filtered.data(), num_samples, window);
+    exp_moving_average(expected_filtered.data(), expected_smoothed.data(), num_samples, alpha);
+    threshold_detection(expected_smoothed.data(), expected_detections.data(), num_samples, threshold);
+    
+    size_t hits = 0;
+    bool match = true;
+    for (size_t i = 0; i < num_samples; ++i) {
+        hits += detections[i];
+        match = match && smoothed[i] == expected_smoothed[i] && detections[i] == expected_detections[i];
+    }
+    
+    // Mapped columns are cache-line aligned and padded, so the aligned overloads apply directly
+    float corr = cross_correlation(aligned, recording.channel(0), recording.channel(1), num_samples);
     
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    std::cout << "Channels: " << recording.num_channels() << ", samples: " << recording.num_samples()
+              << ", chunk: " << chunk_samples << "\n";
+    std::cout << "Channel 2 detections: " << hits << "\n";
+    std::cout << "Matches whole-array kernels: " << check_result(match) << "\n";
+    std::cout << "Channel 0/1 cross-correlation: " << std::fixed << std::setprecision(2) << corr
+              << " (in-memory " << cross_correlation(columns[0].data(), columns[1].data(), num_samples) << ")\n";
     
-    std::cout << "Weighted average result: " << std::fixed << std::setprecision(6) << result << "\n";
-    std::cout << "Processing time: " << duration.count() << " microseconds\n";
-    std::cout << "Throughput: " << (test_size / (duration.count() / 1000000.0)) / 1000000.0 << " million elements/second\n";
+    // Headers whose sizes wrap when multiplied must be rejected, not mapped
+    bool wrapped_rejected = true;
+    for (int crafted = 0; crafted < 2; ++crafted) {
+        RecordingHeader header;
+        std::memcpy(&header, recording.channel(0) - RECORDING_HEADER_SIZE / sizeof(float), sizeof(header));
+        if (crafted == 0) {
+            header.num_samples = (uint64_t{1} << 62) + 16;  // * sizeof(float) wraps to 64
+            header.column_stride = 64;
+        } else {
+            header.num_channels = 1u << 31;
+            header.column_stride = uint64_t{1} << 33;       // * num_channels wraps to 0
+        }
+        const std::string crafted_path = path + ".crafted";
+        // Header plus one padded line of samples, enough for the wrapped sizes to look valid
+        const char line[64] = {};
+        std::ofstream(crafted_path, std::ios::binary)
+            .write(reinterpret_cast<const char*>(&header), sizeof(header)).write(line, sizeof(line));
+        try {
+            MappedRecording bad(crafted_path);
+            wrapped_rejected = false;
+        } catch (const std::runtime_error&) {
+        }
+        std::remove(crafted_path.c_str());
+    }
+    std::cout << "Headers with wrapping sizes rejected: " << check_result(wrapped_rejected) << "\n";
+    
+    std::remove(path.c_str());
 }
 
-int main() {
+// Test function for the chunk-indexed recording format
+void test_sensor_recording() {
+    std::cout << "\n=== Chunk-Indexed Sensor Recording ===\n";
+    
+    const size_t num_channels = 8;
+    const size_t num_rows = 200000;
+    const size_t chunk_samples = 4096;
+    const float threshold = 5.0f;
+    const std::string path = "/tmp/armsimd_sensor_demo.bin";
+    
+    // Channel 7 is noise around zero with three short bursts above the threshold
+    std::vector<int64_t> timestamps(num_rows);
+    std::vector<std::vector<float>> columns(num_channels, std::vector<float>(num_rows));
+    std::mt19937 gen(11);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    for (size_t i = 0; i < num_rows; ++i) {
+        timestamps[i] = static_cast<int64_t>(i) * 1000000;  // 1 kHz, nanoseconds
+        for (size_t c = 0; c < num_channels; ++c) {
+            columns[c][i] = noise(gen) * 0.5f + static_cast<float>(c);
+        }
+        columns[7][i] -= 7.0f;
+        if ((i >= 30000 && i < 30050) || (i >= 120000 && i < 120010) || (i >= 199990)) {
+            columns[7][i] += 10.0f;
+        }
+    }
+    
+    {
+        SensorRecordingWriter writer(path, num_channels, chunk_samples);
+        std::vector<const float*> pointers(num_channels);
+        // Append in uneven blocks, as rows would arrive from a sensor
+        for (size_t row = 0; row < num_rows; row += 1500) {
+            const size_t n = num_rows - row < 1500 ? num_rows - row : 1500;
+            for (size_t c = 0; c < num_channels; ++c) pointers[c] = columns[c].data() + row;
+            writer.append(timestamps.data() + row, pointers.data(), n);
+        }
+        writer.finish();
+    }
+    
+    SensorRecordingReader reader(path);
+    ThresholdQueryResult hits = reader.find_above(7, threshold);
+    
+    std::vector<uint64_t> expected;
+    for (size_t i = 0; i < num_rows; ++i) {
+        if (columns[7][i] > threshold) expected.push_back(i);
+    }
+    
+    const SensorChunkStats& first = reader.stats(0, 3);
+    std::cout << "Rows: " << reader.num_samples() << ", channels: " << reader.num_channels()
+              << ", chunks: " << reader.num_chunks() << "\n";
+    std::cout << "Chunk 0, channel 3: min " << std::fixed << std::setprecision(3) << first.min
+              << ", max " << first.max << ", mean " << first.sum / first.count << "\n";
+    std::cout << "Channel 7 above " << std::setprecision(1) << threshold << ": " << hits.samples.size() << " rows, "
+              << hits.chunks_scanned << " chunks scanned, " << hits.chunks_skipped << " skipped\n";
+    std::cout << "First hit at t = " << reader.timestamps(hits.samples[0] / chunk_samples)[hits.samples[0] % chunk_samples] / 1000000
+              << " ms\n";
+    std::cout << "Matches full scan: " << check_result(hits.samples == expected) << "\n";
+    
+    // Footers whose sizes wrap when multiplied or added must be rejected, not loaded
+    std::ifstream original(path, std::ios::binary);
+    const std::string bytes((std::istreambuf_iterator<char>(original)), std::istreambuf_iterator<char>());
+    SensorFileTrailer trailer;
+    std::memcpy(&trailer, bytes.data() + bytes.size() - sizeof(trailer), sizeof(trailer));
+    bool wrapped_rejected = true;
+    for (int crafted = 0; crafted < 2; ++crafted) {
+        std::string patched = bytes;
+        if (crafted == 0) {
+            // 2^58 more chunks of 192 footer bytes wrap back to the real footer size
+            const uint64_t num_chunks = trailer.num_chunks + (uint64_t{1} << 58);
+            std::memcpy(&patched[bytes.size() - sizeof(trailer) + offsetof(SensorFileTrailer, num_chunks)],
+                        &num_chunks, sizeof(num_chunks));
+        } else {
+            // A chunk offset just below 2^64 wraps past the footer bound
+            const uint64_t offset = ~uint64_t{63};
+            std::memcpy(&patched[trailer.footer_offset + offsetof(SensorChunkEntry, offset)], &offset, sizeof(offset));
+        }
+        const std::string crafted_path = path + ".crafted";
+        std::ofstream(crafted_path, std::ios::binary).write(patched.data(), patched.size());
+        try {
+            SensorRecordingReader bad(crafted_path);
+            wrapped_rejected = false;
+        } catch (const std::runtime_error&) {
+        }
+        std::remove(crafted_path.c_str());
+    }
+    std::cout << "Footers with wrapping sizes rejected: " << check_result(wrapped_rejected) << "\n";
+    
+    std::remove(path.c_str());
+}
+
+// Test function for kernels running in place on ring buffer memory
+void test_ring_buffers() {
+    std::cout << "\n=== Lock-Free Ring Buffers ===\n";
+    
+    const size_t num_samples = 200000;
+    const float alpha = 0.25f;
+    const float threshold = 0.8f;
+    
+    std::vector<float> signal(num_samples);
+    for (size_t i = 0; i < num_samples; ++i) {
+        signal[i] = std::sin(0.002f * i) + 0.2f * std::sin(0.9f * i);
+    }
+    
+    // Acquisition thread -> SPSC ring -> EMA and threshold run in place on the ring spans
+    SpscRing<float> ring(4096);
+    std::vector<float> smoothed(num_samples);
+    std::vector<uint8_t> detections(num_samples);
+    
+    std::thread producer([&] {
+        size_t sent = 0;
+        while (sent < num_samples) {
+            const size_t burst = num_samples - sent < 333 ? num_samples - sent : 333;
+            const size_t written = ring.push(&signal[sent], burst);
+            sent += written;
+            if (written == 0) std::this_thread::yield();
+        }
+    });
+    
+    StreamingEma ema(alpha);
+    size_t received = 0;
+    while (received < num_samples) {
+        RingSpans<float> spans = ring.read_spans();
+        if (spans.empty()) {
+            std::this_thread::yield();
+            continue;
+        }
+        spans.for_each([&](float* data, size_t n, size_t offset) {
+            ema.process(data, data, n);
+            threshold_detection(data, &detections[received + offset], n, threshold);
+            std::copy(data, data + n, &smoothed[received + offset]);
+        });
+        received += spans.size();
+        ring.commit_read(spans.size());
+    }
+    producer.join();
+    
+    std::vector<float> expected(num_samples);
+    std::vector<uint8_t> expected_detections(num_samples);
+    exp_moving_average(signal.data(), expected.data(), num_samples, alpha);
+    threshold_detection(expected.data(), expected_detections.data(), num_samples, threshold);
+    
+    size_t hits = 0;
+    bool match = true;
+    for (size_t i = 0; i < num_samples; ++i) {
+        hits += detections[i];
+        match = match && smoothed[i] == expected[i] && detections[i] == expected_detections[i];
+    }
+    
+    std::cout << "SPSC capacity: " << ring.capacity() << ", samples: " << num_samples
+              << ", detections: " << hits << "\n";
+    std::cout << "Matches whole-array kernels: " << check_result(match) << "\n";
+    
+    // Several acquisition threads -> MPSC ring, blocks stay intact and in per-producer order
+    const size_t num_producers = 3;
+    const size_t blocks_per_producer = 2000;
+    const size_t block_size = 16;
+    MpscRing<float> shared(1024);
+    
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&, p] {
+            float block[block_size];
+            for (size_t b = 0; b < blocks_per_producer; ++b) {
+                for (size_t k = 0; k < block_size; ++k) block[k] = static_cast<float>(p);
+                while (shared.push(block, block_size) == 0) std::this_thread::yield();
+            }
+        });
+    }
+    
+    size_t consumed = 0;
+    bool intact = true;
+    const size_t expected_total = num_producers * blocks_per_producer * block_size;
+    while (consumed < expected_total) {
+        RingSpans<float> spans = shared.read_spans(block_size);
+        if (spans.size() < block_size) {
+            std::this_thread::yield();
+            continue;
+        }
+        float block[block_size];
+        std::copy(spans.first, spans.first + spans.first_size, block);
+        std::copy(spans.second, spans.second + spans.second_size, block + spans.first_size);
+        for (size_t k = 1; k < block_size; ++k) {
+            intact = intact && block[k] == block[0];
+        }
+        consumed += block_size;
+        shared.commit_read(block_size);
+    }
+    for (std::thread& t : producers) t.join();
+    
+    std::cout << "MPSC producers: " << num_producers << ", samples: " << consumed
+              << ", blocks intact: " << check_result(intact) << "\n";
+}
+
+// Quick pass of the benchmark suite at cache-resident sizes (run with --benchmark for the full sweep)
+void test_performance_benchmark() {
+    std::cout << "\n=== Performance Benchmark ===\n";
+    
+    BenchmarkConfig config;
+    config.sizes = {{"L1", 2048}, {"L2", 32768}};
+    config.warmup_trials = 1;
+    config.trials = 5;
+    
+    print_benchmark_table(std::cout, run_benchmarks(config));
+    
+    // Per-call latency on tiny arrays, where tails and reductions dominate
+    LatencyConfig latency;
+    latency.sizes = {3, 17, 64};
+    latency.samples = 1000;
+    latency.filter = "min_index";
+    std::cout << "\n";
+    print_latency_table(std::cout, run_latency_benchmarks(latency));
+}
+
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [--benchmark] [--json FILE] [--sizes N,N,...] [--trials N]\n"
+              << "       [--warmup N] [--seed N] [--kernel NAME] [--roofline]\n"
+              << "       " << program << " --latency [--sizes N,N,...] [--samples N] [--cpu N] [--kernel NAME] [--json FILE]\n"
+              << "       " << program << " --autotune [--tuning-file FILE] [--trials N] [--warmup N] [--seed N]\n\n"
+              << "Without --benchmark the functional demo runs. --roofline also measures the\n"
+              << "machine's bandwidth and FMA ceilings and reports each kernel against them.\n"
+              << "--latency measures per-call p50/p99/p99.9 at small sizes (default 1-64) on one pinned core.\n"
+              << "--autotune picks the fastest loop shape of each tuned kernel on this core and saves it to the\n"
+              << "tuning file (default $" << TUNING_FILE_ENV << ", else " << TUNING_FILE_DEFAULT << "), loaded at startup.\n";
+}
+
+// Full benchmark sweep from the command line; returns the process exit code
+int run_benchmark_cli(int argc, char** argv) {
+    BenchmarkConfig config;
+    std::string json_path;
+    bool roofline = false;
+    bool latency = false;
+    bool autotune = false;
+    std::string tuning_path = tuning_file_path();
+    bool sizes_given = false;
+    LatencyConfig latency_config;
+    AutotuneConfig autotune_config;
+    
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--benchmark") {
+            continue;
+        } else if (arg == "--roofline") {
+            roofline = true;
+        } else if (arg == "--latency") {
+            latency = true;
+        } else if (arg == "--autotune") {
+            autotune = true;
+        } else if (arg == "--tuning-file" && has_value) {
+            tuning_path = argv[++i];
+        } else if (arg == "--samples" && has_value) {
+            latency_config.samples = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--cpu" && has_value) {
+            latency_config.cpu = std::atoi(argv[++i]);
+        } else if (arg == "--json" && has_value) {
+            json_path = argv[++i];
+        } else if (arg == "--trials" && has_value) {
+            config.trials = std::max(1, std::atoi(argv[++i]));
+            autotune_config.trials = config.trials;
+        } else if (arg == "--warmup" && has_value) {
+            config.warmup_trials = std::max(0, std::atoi(argv[++i]));
+            autotune_config.warmup_trials = config.warmup_trials;
+        } else if (arg == "--seed" && has_value) {
+            config.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--kernel" && has_value) {
+            config.filter = argv[++i];
+        } else if (arg == "--sizes" && has_value) {
+            config.sizes.clear();
+            sizes_given = true;
+            std::string list = argv[++i];
+            for (size_t pos = 0; pos < list.size();) {
+                size_t comma = list.find(',', pos);
+                if (comma == std::string::npos) comma = list.size();
+                const size_t n = std::strtoull(list.substr(pos, comma - pos).c_str(), nullptr, 10);
+                if (n > 0) config.sizes.push_back({"custom", n});
+                pos = comma + 1;
+            }
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (autotune) {
+        autotune_config.seed = config.seed;
+        std::cout << "Autotuning on " << detect_core_name() << "\n";
+        AutotuneResult result = run_autotune(autotune_config);
+        print_autotune_table(std::cout, result);
+        std::cout << "Selected: " << describe_tuning(result.tuning) << "\n";
+        
+        if (!save_tuning(tuning_path, result.tuning)) {
+            std::cerr << "Error: cannot write " << tuning_path << std::endl;
+            return 1;
+        }
+        std::cout << "Tuning for " << result.tuning.core << " written to " << tuning_path << "\n";
+        return 0;
+    }
+    
+    if (latency) {
+        if (sizes_given) {
+            latency_config.sizes.clear();
+            for (const BenchmarkSize& size : config.sizes) latency_config.sizes.push_back(size.elements);
+        }
+        latency_config.seed = config.seed;
+        latency_config.filter = config.filter;
+        
+        const LatencyReport report = run_latency_benchmarks(latency_config);
+        std::cout << "Per-call latency, "
+                  << (report.pinned_cpu >= 0 ? "pinned to CPU " + std::to_string(report.pinned_cpu) : "unpinned")
+                  << ", " << latency_config.samples << " samples\n";
+        print_latency_table(std::cout, report);
+        
+        if (!json_path.empty()) {
+            std::ofstream json(json_path);
+            if (!json) {
+                std::cerr << "Error: cannot write " << json_path << std::endl;
+                return 1;
+            }
+            write_latency_json(json, report, latency_config);
+            std::cout << "Results written to " << json_path << "\n";
+        }
+        return 0;
+    }
+    
+#ifdef BENCHMARK_MODE
+    std::cout << "Hardware counters: " << (PerfCounters().available() ? "perf_event_open" : "unavailable, timing only") << "\n\n";
+#endif
+    
+    std::vector<BenchmarkResult> results = run_benchmarks(config);
+    print_benchmark_table(std::cout, results);
+    
+    MachineCeilings machine;
+    std::vector<RooflineEntry> entries;
+    if (roofline) {
+        BenchmarkData no_data(0, config.seed);  // kernels are only consulted for their traffic and FLOP counts
+        machine = calibrate_machine(config);
+        entries = build_roofline(results, benchmark_kernels(no_data), machine);
+        std::cout << "\nRoofline (single core)\n";
+        print_roofline_table(std::cout, machine, entries);
+    }
+    
+    if (!json_path.empty()) {
+        std::ofstream json(json_path);
+        if (!json) {
+            std::cerr << "Error: cannot write " << json_path << std::endl;
+            return 1;
+        }
+        if (roofline) {
+            write_roofline_json(json, results, config, machine, entries);
+        } else {
+            write_benchmark_json(json, results, config);
+        }
+        std::cout << "Results written to " << json_path << "\n";
+    }
+    
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // Streaming kernels prefetch at the distance tuned for this core, in the demo and the benchmarks alike
+    apply_streaming_tuning(tuned_table.tuning);
+    
+    if (argc > 1) return run_benchmark_cli(argc, argv);
+    
     std::cout << "ARM NEON Signal Processing Functions Demo\n";
     std::cout << "=========================================\n";
+    std::cout << "SIMD backend: " << SIMD_BACKEND << "\n";
     
     try {
         test_vector_distance();
@@ -234,9 +1670,33 @@ int main() {
         test_cross_correlation();
         test_exp_moving_average();
         test_threshold_detection();
+        test_integer_inputs();
+        test_small_arrays();
+        test_fixed_size_kernels();
+        test_cpu_dispatch();
+        test_kernel_tuning();
+        test_streaming_stores();
+        test_aos_points();
+        test_nearest_point();
+        test_kinematics();
+        test_simd_math();
+        test_fixed_point_kernels();
+        test_expression_templates();
+        test_fused_pipeline();
+        test_batch_kernels();
+        test_parallel_kernels();
+        test_task_scheduler();
+        test_aligned_arena();
+        test_mapped_recording();
+        test_sensor_recording();
+        test_ring_buffers();
         test_performance_benchmark();
         
         std::cout << "\n=== Demo Complete ===\n";
+        if (failed_checks > 0) {
+            std::cerr << failed_checks << " self-check(s) failed\n";
+            return 1;
+        }
         std::cout << "All functions executed successfully!\n";
         
     } catch (const std::exception& e) {
@@ -1,10 +1,22 @@
 #ifndef OBJ_DETECTION_UTIL_H
 #define OBJ_DETECTION_UTIL_H
 
-#include <arm_neon.h>
+#include <cstddef>
 #include <cstdint>
 #include <cmath>
 
+#include "simd.h"
+#include "simd_tail.h"
+#include "simd_wide.h"
+#include "streaming_stores.h"
+
+// Streaming variants (defined below), selected by the kernels above streaming_config().threshold_bytes
+inline void speed_streaming(const float* positions_prev, const float* positions_curr,
+                            float* speeds, size_t count, float time_delta);
+inline void cumulative_sum_streaming(const float* input, float* output, size_t count, float carry);
+inline void moving_average_filter_streaming(const float* input, float* output, size_t count,
+                                            size_t window_size, size_t history);
+
 /**
  * @brief Calculate squared distance between two 2D points using NEON vectors
  * @param x1 X coordinates of first points (4 points per vector)
@@ -21,19 +33,35 @@ inline float32x4_t vector_distance_squared(float32x4_t x1, float32x4_t y1,
 }
 
 /**
- * @brief Calculate weighted average of an array of values
- * @param values Array of values to average
+ * @brief Accumulate the weighted sum and the weight sum of an array of values
+ * @param values Array of values
  * @param weights Array of weights corresponding to each value
  * @param count Number of elements in both arrays
- * @return Weighted average result
+ * @param weighted_sum Output sum of values[i] * weights[i]
+ * @param weight_sum Output sum of weights[i]
  */
-inline float weighted_average(const float* values, const float* weights, size_t count) {
+inline void weighted_sums(const float* values, const float* weights, size_t count,
+                          float& weighted_sum, float& weight_sum) {
     float32x4_t sum_weighted = vdupq_n_f32(0.0f);
     float32x4_t sum_weights = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    
+    if constexpr (simd_wide::NATIVE) {
+        simd_wide::f32x8 wide_weighted = simd_wide::dup(0.0f);
+        simd_wide::f32x8 wide_weights = simd_wide::dup(0.0f);
+        
+        for (; i + 8 <= count; i += 8) {
+            simd_wide::f32x8 wts = simd_wide::load(&weights[i]);
+            wide_weighted = simd_wide::fma(wide_weighted, simd_wide::load(&values[i]), wts);
+            wide_weights = simd_wide::add(wide_weights, wts);
+        }
+        sum_weighted = simd_wide::fold(wide_weighted);
+        sum_weights = simd_wide::fold(wide_weights);
+    }
     
     const size_t simd_count = count & ~3;
     
-    for (size_t i = 0; i < simd_count; i += 4) {
+    for (; i < simd_count; i += 4) {
         float32x4_t vals = vld1q_f32(&values[i]);
         float32x4_t wts = vld1q_f32(&weights[i]);
         
@@ -41,57 +69,110 @@ inline float weighted_average(const float* values, const float* weights, size_t
         sum_weights = vaddq_f32(sum_weights, wts);
     }
     
+    // Last count % 4 elements as one vector, the lanes already summed zeroed
+    if (simd_count < count) {
+        float32x4_t vals = simd_tail::load_tail_zeroed(values, count);
+        float32x4_t wts = simd_tail::load_tail_zeroed(weights, count);
+        
+        sum_weighted = vfmaq_f32(sum_weighted, vals, wts);
+        sum_weights = vaddq_f32(sum_weights, wts);
+    }
+    
     float32x2_t sum_weighted_pair = vadd_f32(vget_low_f32(sum_weighted), vget_high_f32(sum_weighted));
     float32x2_t sum_weights_pair = vadd_f32(vget_low_f32(sum_weights), vget_high_f32(sum_weights));
     
-    float weighted_sum = vget_lane_f32(vpadd_f32(sum_weighted_pair, sum_weighted_pair), 0);
-    float weight_sum = vget_lane_f32(vpadd_f32(sum_weights_pair, sum_weights_pair), 0);
-    
-    for (size_t i = simd_count; i < count; ++i) {
-        weighted_sum += values[i] * weights[i];
-        weight_sum += weights[i];
-    }
+    weighted_sum = vget_lane_f32(vpadd_f32(sum_weighted_pair, sum_weighted_pair), 0);
+    weight_sum = vget_lane_f32(vpadd_f32(sum_weights_pair, sum_weights_pair), 0);
+}
+
+/**
+ * @brief Calculate weighted average of an array of values
+ * @param values Array of values to average
+ * @param weights Array of weights corresponding to each value
+ * @param count Number of elements in both arrays
+ * @return Weighted average result
+ */
+inline float weighted_average(const float* values, const float* weights, size_t count) {
+    float weighted_sum, weight_sum;
+    weighted_sums(values, weights, count, weighted_sum, weight_sum);
     
     return weight_sum > 0.0f ? weighted_sum / weight_sum : 0.0f;
 }
 
 /**
- * @brief Compute cumulative sum of an array
+ * @brief Returns v unchanged, but stops -ffast-math from reassociating the sums it feeds
+ *
+ * For sums that must round the same whatever the inlining context, such as
+ * streamed results that have to match whole-array ones bit for bit. It emits
+ * no instructions.
+ */
+inline float32x4_t keep_sum_order(float32x4_t v) {
+#if defined(__aarch64__) || defined(__arm__)
+    __asm__("" : "+w"(v));
+#elif defined(__x86_64__) || defined(__i386__)
+    __asm__("" : "+x"(v));
+#endif
+    return v;
+}
+
+/**
+ * @brief Inclusive prefix sum of the four lanes of a float vector
+ * @param v Input lanes {a, b, c, d}
+ * @return {a, a+b, a+b+c, a+b+c+d}
+ */
+inline float32x4_t prefix_sum_f32x4(float32x4_t v) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    v = vaddq_f32(v, vextq_f32(zero, v, 3));
+    v = vaddq_f32(v, vextq_f32(zero, v, 2));
+    
+    // Sums continued from a carry must round alike in every loop that computes them
+    return keep_sum_order(v);
+}
+
+/**
+ * @brief Continue a cumulative sum across block boundaries
  * @param input Input array
- * @param output Output array to store cumulative sums
+ * @param output Output array to store cumulative sums (may alias input)
  * @param count Number of elements
+ * @param carry_in Last output of the preceding block
+ *
+ * Blocks that start at multiples of four elements give the same sums as
+ * one call over the whole array.
  */
-inline void cumulative_sum(const float* input, float* output, size_t count) {
-    if (count == 0) return;
+inline void cumulative_sum(const float* input, float* output, size_t count, float carry_in) {
+    if (use_streaming_stores(output, count * 2 * sizeof(float))) {
+        cumulative_sum_streaming(input, output, count, carry_in);
+        return;
+    }
     
-    output[0] = input[0];
+    float32x4_t carry = vdupq_n_f32(carry_in);
+    const size_t simd_count = count & ~3;
     
-    const size_t simd_count = ((count - 1) & ~3) + 1;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        float32x4_t result = vaddq_f32(prefix_sum_f32x4(vld1q_f32(&input[i])), carry);
+        carry = vdupq_laneq_f32(result, 3);
+        vst1q_f32(&output[i], result);
+    }
     
-    for (size_t i = 1; i < simd_count; i += 4) {
-        size_t remaining = count - i;
-        if (remaining >= 4) {
-            float32x4_t input_vec = vld1q_f32(&input[i]);
-            float32x4_t prev_sum = {output[i-1], output[i-1], output[i-1], output[i-1]};
-            
-            // Prefix sum within the vector
-            float32x4_t result = input_vec;
-            result = vaddq_f32(result, vextq_f32(vdupq_n_f32(0), result, 3));
-            result = vaddq_f32(result, vextq_f32(vdupq_n_f32(0), result, 2));
-            result = vaddq_f32(result, vextq_f32(vdupq_n_f32(0), result, 1));
-            result = vaddq_f32(result, prev_sum);
-            
-            vst1q_f32(&output[i], result);
-        } else {
-            // Handle remaining elements
-            for (size_t j = i; j < count; ++j) {
-                output[j] = output[j-1] + input[j];
-            }
-            break;
-        }
+    // Zero-padded last vector; the padding lanes are never stored
+    if (simd_count < count) {
+        simd_tail::Partial<float> tail;
+        tail.load(&input[simd_count], count - simd_count, 0.0f);
+        vst1q_f32(tail.lanes, vaddq_f32(prefix_sum_f32x4(vld1q_f32(tail.lanes)), carry));
+        tail.store(&output[simd_count], count - simd_count);
     }
 }
 
+/**
+ * @brief Compute cumulative sum of an array
+ * @param input Input array
+ * @param output Output array to store cumulative sums (may alias input)
+ * @param count Number of elements
+ */
+inline void cumulative_sum(const float* input, float* output, size_t count) {
+    cumulative_sum(input, output, count, 0.0f);
+}
+
 /**
  * @brief Calculate speed from position differences over time
  * @param positions_prev Previous position values
@@ -102,9 +183,47 @@ inline void cumulative_sum(const float* input, float* output, size_t count) {
  */
 inline void speed(const float* positions_prev, const float* positions_curr,
                                  float* speeds, size_t count, float time_delta) {
+    if (use_streaming_stores(speeds, count * 3 * sizeof(float))) {
+        speed_streaming(positions_prev, positions_curr, speeds, count, time_delta);
+        return;
+    }
+    
     const float32x4_t time_inv = vdupq_n_f32(1.0f / time_delta);
-    const size_t simd_count = count & ~3;
     
+    if (count < 4) {
+        simd_tail::Partial<float> prev, curr;
+        prev.load(positions_prev, count, 0.0f);
+        curr.load(positions_curr, count, 0.0f);
+        vst1q_f32(curr.lanes, vmulq_f32(vsubq_f32(vld1q_f32(curr.lanes), vld1q_f32(prev.lanes)), time_inv));
+        curr.store(speeds, count);
+        return;
+    }
+    
+    if constexpr (simd_wide::NATIVE) {
+        if (count >= 8) {
+            const simd_wide::f32x8 wide_time_inv = simd_wide::dup(1.0f / time_delta);
+            auto speeds_at = [&](size_t i) {
+                return simd_wide::mul(simd_wide::sub(simd_wide::load(&positions_curr[i]),
+                                                     simd_wide::load(&positions_prev[i])), wide_time_inv);
+            };
+            
+            // Last eight speeds, computed up front and stored over the overlap at the end
+            const size_t wide_last = count - 8;
+            const simd_wide::f32x8 wide_tail = speeds_at(wide_last);
+            
+            for (size_t i = 0; i < wide_last; i += 8) {
+                simd_wide::store(&speeds[i], speeds_at(i));
+            }
+            simd_wide::store(&speeds[wide_last], wide_tail);
+            return;
+        }
+    }
+    
+    // Last four speeds, computed up front and stored over the overlap at the end
+    const size_t last = count - 4;
+    const float32x4_t tail = vmulq_f32(vsubq_f32(vld1q_f32(&positions_curr[last]), vld1q_f32(&positions_prev[last])), time_inv);
+    
+    const size_t simd_count = count & ~3;
     for (size_t i = 0; i < simd_count; i += 4) {
         float32x4_t prev = vld1q_f32(&positions_prev[i]);
         float32x4_t curr = vld1q_f32(&positions_curr[i]);
@@ -113,8 +232,120 @@ inline void speed(const float* positions_prev, const float* positions_curr,
         vst1q_f32(&speeds[i], speed);
     }
     
-    for (size_t i = simd_count; i < count; ++i) {
-        speeds[i] = (positions_curr[i] - positions_prev[i]) / time_delta;
+    vst1q_f32(&speeds[last], tail);
+}
+
+/**
+ * @brief Sum of an array
+ * @param values Input array
+ * @param count Number of elements
+ * @return Sum of all elements (0 if the array is empty)
+ */
+inline float array_sum(const float* values, size_t count) {
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    
+    if constexpr (simd_wide::NATIVE) {
+        simd_wide::f32x8 wide_sum = simd_wide::dup(0.0f);
+        for (; i + 8 <= count; i += 8) {
+            wide_sum = simd_wide::add(wide_sum, simd_wide::load(&values[i]));
+        }
+        sum = simd_wide::fold(wide_sum);
+    }
+    
+    const size_t simd_count = count & ~3;
+    for (; i < simd_count; i += 4) {
+        sum = vaddq_f32(sum, vld1q_f32(&values[i]));
+    }
+    if (simd_count < count) {
+        sum = vaddq_f32(sum, simd_tail::load_tail_zeroed(values, count));
+    }
+    
+    return vaddvq_f32(sum);
+}
+
+/**
+ * @brief Means of the four windows ending at newest[0..3]
+ * @param newest Newest samples of the windows; the window_size - 1 samples before must be readable
+ * @param window_size Size of the moving average window
+ * @param scale_vec 1 / window_size in every lane
+ *
+ * Lane k adds newest[k - j] for j < window_size, always in the same order.
+ */
+inline float32x4_t moving_window_mean(const float* newest, size_t window_size, float32x4_t scale_vec) {
+    float32x4_t sum = vld1q_f32(newest);
+    for (size_t j = 1; j < window_size; ++j) {
+        sum = keep_sum_order(vaddq_f32(sum, vld1q_f32(newest - j)));
+    }
+    return vmulq_f32(sum, scale_vec);
+}
+
+/**
+ * @brief Continue a moving average filter across chunk boundaries
+ * @param input Input signal array; the `history` samples before input[0] must be readable
+ * @param output Filtered output array
+ * @param count Number of elements to filter
+ * @param window_size Size of the moving average window
+ * @param history Number of valid samples preceding input[0] (window_size - 1 is enough)
+ *
+ * Four outputs are computed per vector, each lane summing its own window,
+ * so no output needs a horizontal reduction.
+ */
+inline void moving_average_filter(const float* input, float* output, size_t count,
+                                  size_t window_size, size_t history) {
+    if (window_size == 0 || count == 0) return;
+    
+    const size_t usable_history = history < window_size - 1 ? history : window_size - 1;
+    const size_t warmup_needed = window_size - 1 - usable_history;
+    const size_t warmup = warmup_needed < count ? warmup_needed : count;
+    
+    if (count >= warmup + 4 * STREAMING_LINE_FLOATS && use_streaming_stores(output, count * 2 * sizeof(float))) {
+        moving_average_filter_streaming(input, output, count, window_size, history);
+        return;
+    }
+    
+    // Outputs whose window reaches past the history: running mean of every sample so far
+    if (warmup > 0) {
+        float32x4_t carry = vdupq_n_f32(array_sum(input - usable_history, usable_history));
+        const float first = static_cast<float>(usable_history + 1);
+        float32x4_t samples = {first, first + 1.0f, first + 2.0f, first + 3.0f};
+        
+        for (size_t i = 0; i < warmup; i += 4) {
+            const size_t n = warmup - i < 4 ? warmup - i : 4;
+            simd_tail::Partial<float> block;
+            block.load(&input[i], n, 0.0f);
+            
+            float32x4_t sums = vaddq_f32(prefix_sum_f32x4(vld1q_f32(block.lanes)), carry);
+            carry = vdupq_laneq_f32(sums, 3);
+            vst1q_f32(block.lanes, vdivq_f32(sums, samples));
+            block.store(&output[i], n);
+            samples = vaddq_f32(samples, vdupq_n_f32(4.0f));
+        }
+    }
+    
+    const float32x4_t scale_vec = vdupq_n_f32(1.0f / window_size);
+    auto window_mean = [&](const float* newest) { return moving_window_mean(newest, window_size, scale_vec); };
+    
+    size_t i = warmup;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(&output[i], window_mean(&input[i]));
+    }
+    
+    if (i < count) {
+        if (count >= warmup + 4) {
+            // Overlapping last vector; the outputs it repeats are recomputed identically
+            vst1q_f32(&output[count - 4], window_mean(&input[count - 4]));
+        } else {
+            const size_t n = count - i;
+            simd_tail::Partial<float> block;
+            float32x4_t sum = vdupq_n_f32(0.0f);
+            for (size_t j = 0; j < window_size; ++j) {
+                block.load(&input[i] - j, n, 0.0f);
+                sum = keep_sum_order(vaddq_f32(sum, vld1q_f32(block.lanes)));
+            }
+            vst1q_f32(block.lanes, vmulq_f32(sum, scale_vec));
+            block.store(&output[i], n);
+        }
     }
 }
 
@@ -127,34 +358,127 @@ inline void speed(const float* positions_prev, const float* positions_curr,
  */
 inline void moving_average_filter(const float* input, float* output, 
                                       size_t count, size_t window_size) {
+    moving_average_filter(input, output, count, window_size, 0);
+}
+
+/**
+ * @brief speed() with non-temporal stores, for arrays larger than the last-level cache
+ * @param positions_prev Previous position values
+ * @param positions_curr Current position values
+ * @param speeds Output array for calculated speeds (16-byte aligned)
+ * @param count Number of elements
+ * @param time_delta Time difference between measurements
+ *
+ * speed() switches to this above streaming_config().threshold_bytes.
+ */
+inline void speed_streaming(const float* positions_prev, const float* positions_curr,
+                            float* speeds, size_t count, float time_delta) {
+    const float32x4_t time_inv = vdupq_n_f32(1.0f / time_delta);
+    auto speed4 = [&](size_t i) {
+        return vmulq_f32(vsubq_f32(vld1q_f32(&positions_curr[i]), vld1q_f32(&positions_prev[i])), time_inv);
+    };
+    auto line = [&](size_t i) {
+        store_streaming(&speeds[i], speed4(i), speed4(i + 4));
+        store_streaming(&speeds[i + 8], speed4(i + 8), speed4(i + 12));
+    };
+    
+    // Normal stores up to the first cache line boundary, then whole lines
+    const size_t head = streaming_head(speeds, count);
+    speed(positions_prev, positions_curr, speeds, head, time_delta);
+    
+    const size_t ahead = streaming_config().prefetch_bytes / sizeof(float);
+    size_t i = head;
+    for (; ahead > 0 && i + ahead + STREAMING_LINE_FLOATS <= count; i += STREAMING_LINE_FLOATS) {
+        __builtin_prefetch(&positions_prev[i + ahead]);
+        __builtin_prefetch(&positions_curr[i + ahead]);
+        line(i);
+    }
+    for (; i + STREAMING_LINE_FLOATS <= count; i += STREAMING_LINE_FLOATS) line(i);
+    
+    speed(positions_prev + i, positions_curr + i, speeds + i, count - i, time_delta);
+    streaming_fence();
+}
+
+/**
+ * @brief cumulative_sum() with non-temporal stores, for arrays larger than the last-level cache
+ * @param input Input array
+ * @param output Output array to store cumulative sums (16-byte aligned, may alias input)
+ * @param count Number of elements
+ * @param carry Last output of the preceding block
+ *
+ * cumulative_sum() switches to this above streaming_config().threshold_bytes.
+ */
+inline void cumulative_sum_streaming(const float* input, float* output, size_t count, float carry) {
+    // With a 16-byte aligned output the head is whole vectors, so the sums group as in cumulative_sum()
+    const size_t head = streaming_head(output, count);
+    cumulative_sum(input, output, head, carry);
+    
+    float32x4_t running = vdupq_n_f32(head > 0 ? output[head - 1] : carry);
+    auto block = [&](size_t i) {
+        float32x4_t result = vaddq_f32(prefix_sum_f32x4(vld1q_f32(&input[i])), running);
+        running = vdupq_laneq_f32(result, 3);
+        return result;
+    };
+    auto line = [&](size_t i) {
+        const float32x4_t r0 = block(i);
+        const float32x4_t r1 = block(i + 4);
+        store_streaming(&output[i], r0, r1);
+        const float32x4_t r2 = block(i + 8);
+        const float32x4_t r3 = block(i + 12);
+        store_streaming(&output[i + 8], r2, r3);
+    };
+    
+    const size_t ahead = streaming_config().prefetch_bytes / sizeof(float);
+    size_t i = head;
+    for (; ahead > 0 && i + ahead + STREAMING_LINE_FLOATS <= count; i += STREAMING_LINE_FLOATS) {
+        __builtin_prefetch(&input[i + ahead]);
+        line(i);
+    }
+    for (; i + STREAMING_LINE_FLOATS <= count; i += STREAMING_LINE_FLOATS) line(i);
+    
+    cumulative_sum(input + i, output + i, count - i, vgetq_lane_f32(running, 0));
+    streaming_fence();
+}
+
+/**
+ * @brief moving_average_filter() with non-temporal stores, for arrays larger than the last-level cache
+ * @param input Input signal array; the `history` samples before input[0] must be readable
+ * @param output Filtered output array (16-byte aligned)
+ * @param count Number of elements to filter
+ * @param window_size Size of the moving average window
+ * @param history Number of valid samples preceding input[0]
+ *
+ * moving_average_filter() switches to this above streaming_config().threshold_bytes.
+ */
+inline void moving_average_filter_streaming(const float* input, float* output, size_t count,
+                                            size_t window_size, size_t history) {
     if (window_size == 0 || count == 0) return;
     
-    const float scale = 1.0f / window_size;
-    const float32x4_t scale_vec = vdupq_n_f32(scale);
+    // Warm-up outputs and the rest of their cache line take the normal path
+    const size_t usable_history = history < window_size - 1 ? history : window_size - 1;
+    const size_t warmup_needed = window_size - 1 - usable_history;
+    const size_t warmup = warmup_needed < count ? warmup_needed : count;
+    const size_t head = warmup + streaming_head(output + warmup, count - warmup);
+    moving_average_filter(input, output, head, window_size, history);
     
-    for (size_t i = 0; i < count; ++i) {
-        size_t start = i >= window_size ? i - window_size + 1 : 0;
-        size_t end = i + 1;
-        size_t actual_window = end - start;
-        
-        float32x4_t sum = vdupq_n_f32(0.0f);
-        size_t j = start;
-        const size_t simd_end = start + ((actual_window) & ~3);
-        
-        for (; j < simd_end; j += 4) {
-            float32x4_t data = vld1q_f32(&input[j]);
-            sum = vaddq_f32(sum, data);
-        }
-        
-        float32x2_t sum_pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
-        float total = vget_lane_f32(vpadd_f32(sum_pair, sum_pair), 0);
-        
-        for (; j < end; ++j) {
-            total += input[j];
-        }
-        
-        output[i] = total / actual_window;
+    const float32x4_t scale_vec = vdupq_n_f32(1.0f / window_size);
+    auto line = [&](size_t i) {
+        store_streaming(&output[i], moving_window_mean(&input[i], window_size, scale_vec),
+                        moving_window_mean(&input[i + 4], window_size, scale_vec));
+        store_streaming(&output[i + 8], moving_window_mean(&input[i + 8], window_size, scale_vec),
+                        moving_window_mean(&input[i + 12], window_size, scale_vec));
+    };
+    
+    const size_t ahead = streaming_config().prefetch_bytes / sizeof(float);
+    size_t i = head;
+    for (; ahead > 0 && i + ahead + STREAMING_LINE_FLOATS <= count; i += STREAMING_LINE_FLOATS) {
+        __builtin_prefetch(&input[i + ahead]);
+        line(i);
     }
+    for (; i + STREAMING_LINE_FLOATS <= count; i += STREAMING_LINE_FLOATS) line(i);
+    
+    moving_average_filter(input + i, output + i, count - i, window_size, history + i);
+    streaming_fence();
 }
 
 /**
@@ -166,15 +490,46 @@ inline void moving_average_filter(const float* input, float* output,
 inline size_t min_index(const float* array, size_t count) {
     if (count == 0) return 0;
     
-    float min_val = array[0];
-    size_t min_idx = 0;
-    
-    const size_t simd_count = count & ~3;
+    const uint32x4_t lane = {0, 1, 2, 3};
+    float32x4_t min_vec;
+    uint32x4_t min_idx_vec;
     
-    if (simd_count >= 4) {
-        float32x4_t min_vec = vld1q_f32(array);
-        uint32x4_t idx_vec = {0, 1, 2, 3};
-        uint32x4_t min_idx_vec = idx_vec;
+    if (count < 4) {
+        // Pad with copies of array[0] under index 0, which can never beat the real first element
+        simd_tail::Partial<float> block;
+        block.load(array, count, array[0]);
+        min_vec = vld1q_f32(block.lanes);
+        min_idx_vec = vandq_u32(lane, vcltq_u32(lane, vdupq_n_u32(static_cast<uint32_t>(count))));
+    } else if (simd_wide::NATIVE && count >= 8) {
+        simd_wide::f32x8 wide_min = simd_wide::load(array);
+        simd_wide::u32x8 wide_idx = simd_wide::iota(0);
+        auto update = [&](size_t i) {
+            simd_wide::f32x8 data = simd_wide::load(&array[i]);
+            simd_wide::u32x8 mask = simd_wide::less(data, wide_min);
+            wide_min = simd_wide::select(mask, data, wide_min);
+            wide_idx = simd_wide::select(mask, simd_wide::iota(static_cast<uint32_t>(i)), wide_idx);
+        };
+        
+        const size_t wide_count = count & ~7;
+        for (size_t i = 8; i < wide_count; i += 8) {
+            update(i);
+        }
+        // Overlapping last vector, as below
+        if (wide_count < count) {
+            update(count - 8);
+        }
+        
+        // Fold the halves; on equal values the lower index wins, as in the final reduction
+        const float32x4_t lo = simd_wide::low(wide_min), hi = simd_wide::high(wide_min);
+        const uint32x4_t lo_idx = simd_wide::low(wide_idx), hi_idx = simd_wide::high(wide_idx);
+        const uint32x4_t take_hi = vorrq_u32(vcltq_f32(hi, lo), vandq_u32(vceqq_f32(hi, lo), vcltq_u32(hi_idx, lo_idx)));
+        min_vec = vbslq_f32(take_hi, hi, lo);
+        min_idx_vec = vbslq_u32(take_hi, hi_idx, lo_idx);
+    } else {
+        min_vec = vld1q_f32(array);
+        min_idx_vec = lane;
+        
+        const size_t simd_count = count & ~3;
         
         for (size_t i = 4; i < simd_count; i += 4) {
             float32x4_t data = vld1q_f32(&array[i]);
@@ -186,27 +541,172 @@ inline size_t min_index(const float* array, size_t count) {
             min_idx_vec = vbslq_u32(mask, curr_idx, min_idx_vec);
         }
         
-        float values[4];
-        uint32_t indices[4];
-        vst1q_f32(values, min_vec);
-        vst1q_u32(indices, min_idx_vec);
-        
-        for (int i = 0; i < 4; ++i) {
-            if (values[i] < min_val) {
-                min_val = values[i];
-                min_idx = indices[i];
-            }
+        // Overlapping last vector: elements seen twice keep their index, so they cannot move the result
+        if (simd_count < count) {
+            float32x4_t data = vld1q_f32(&array[count - 4]);
+            uint32x4_t curr_idx = vaddq_u32(lane, vdupq_n_u32(static_cast<uint32_t>(count - 4)));
+            
+            uint32x4_t mask = vcltq_f32(data, min_vec);
+            min_vec = vbslq_f32(mask, data, min_vec);
+            min_idx_vec = vbslq_u32(mask, curr_idx, min_idx_vec);
         }
     }
     
-    for (size_t i = simd_count; i < count; ++i) {
-        if (array[i] < min_val) {
-            min_val = array[i];
-            min_idx = i;
-        }
+    // Smallest value across lanes, and the lowest index among lanes holding it
+    const float min_val = vminnmvq_f32(min_vec);
+    const uint32x4_t candidates = vbslq_u32(vceqq_f32(min_vec, vdupq_n_f32(min_val)),
+                                            min_idx_vec, vdupq_n_u32(UINT32_MAX));
+    const uint32_t min_idx = vminvq_u32(candidates);
+    
+    return min_idx == UINT32_MAX ? 0 : min_idx;
+}
+
+/**
+ * @brief Find index of minimum value in uint8 array
+ * @param array Input array to search
+ * @param count Number of elements in array
+ * @return Index of first minimum value (0 if array is empty)
+ */
+inline size_t min_index(const uint8_t* array, size_t count) {
+    if (count == 0) return 0;
+    
+    uint8x16_t min_vec;
+    if (count < 16) {
+        // Pad with copies of array[0]; padding lies after every real element, so it is never the first hit
+        simd_tail::Partial<uint8_t> block;
+        block.load(array, count, array[0]);
+        min_vec = vld1q_u8(block.lanes);
+        const uint8_t min_val = vminvq_u8(min_vec);
+        return simd_tail::first_set_lane(vceqq_u8(min_vec, vdupq_n_u8(min_val)));
+    }
+    
+    min_vec = vld1q_u8(array);
+    for (size_t i = 16; i + 16 <= count; i += 16) {
+        min_vec = vminq_u8(min_vec, vld1q_u8(&array[i]));
+    }
+    // Overlapping last vector; min is unaffected by elements seen twice
+    min_vec = vminq_u8(min_vec, vld1q_u8(&array[count - 16]));
+    const uint8_t min_val = vminvq_u8(min_vec);
+    
+    // Narrow lanes cannot carry indices, so locate the first occurrence in an early-exit pass
+    const uint8x16_t target = vdupq_n_u8(min_val);
+    for (size_t i = 0; i + 16 <= count; i += 16) {
+        const uint8x16_t hits = vceqq_u8(vld1q_u8(&array[i]), target);
+        if (vmaxvq_u8(hits) != 0) return i + simd_tail::first_set_lane(hits);
+    }
+    
+    return count - 16 + simd_tail::first_set_lane(vceqq_u8(vld1q_u8(&array[count - 16]), target));
+}
+
+/**
+ * @brief Find index of minimum value in int8 array
+ * @param array Input array to search
+ * @param count Number of elements in array
+ * @return Index of first minimum value (0 if array is empty)
+ */
+inline size_t min_index(const int8_t* array, size_t count) {
+    if (count == 0) return 0;
+    
+    int8x16_t min_vec;
+    if (count < 16) {
+        // Pad with copies of array[0]; padding lies after every real element, so it is never the first hit
+        simd_tail::Partial<int8_t> block;
+        block.load(array, count, array[0]);
+        min_vec = vld1q_s8(block.lanes);
+        const int8_t min_val = vminvq_s8(min_vec);
+        return simd_tail::first_set_lane(vceqq_s8(min_vec, vdupq_n_s8(min_val)));
+    }
+    
+    min_vec = vld1q_s8(array);
+    for (size_t i = 16; i + 16 <= count; i += 16) {
+        min_vec = vminq_s8(min_vec, vld1q_s8(&array[i]));
+    }
+    // Overlapping last vector; min is unaffected by elements seen twice
+    min_vec = vminq_s8(min_vec, vld1q_s8(&array[count - 16]));
+    const int8_t min_val = vminvq_s8(min_vec);
+    
+    // Narrow lanes cannot carry indices, so locate the first occurrence in an early-exit pass
+    const int8x16_t target = vdupq_n_s8(min_val);
+    for (size_t i = 0; i + 16 <= count; i += 16) {
+        const uint8x16_t hits = vceqq_s8(vld1q_s8(&array[i]), target);
+        if (vmaxvq_u8(hits) != 0) return i + simd_tail::first_set_lane(hits);
+    }
+    
+    return count - 16 + simd_tail::first_set_lane(vceqq_s8(vld1q_s8(&array[count - 16]), target));
+}
+
+/**
+ * @brief Find index of minimum value in uint16 array
+ * @param array Input array to search
+ * @param count Number of elements in array
+ * @return Index of first minimum value (0 if array is empty)
+ */
+inline size_t min_index(const uint16_t* array, size_t count) {
+    if (count == 0) return 0;
+    
+    uint16x8_t min_vec;
+    if (count < 8) {
+        // Pad with copies of array[0]; padding lies after every real element, so it is never the first hit
+        simd_tail::Partial<uint16_t> block;
+        block.load(array, count, array[0]);
+        min_vec = vld1q_u16(block.lanes);
+        const uint16_t min_val = vminvq_u16(min_vec);
+        return simd_tail::first_set_lane(vceqq_u16(min_vec, vdupq_n_u16(min_val)));
     }
     
-    return min_idx;
+    min_vec = vld1q_u16(array);
+    for (size_t i = 8; i + 8 <= count; i += 8) {
+        min_vec = vminq_u16(min_vec, vld1q_u16(&array[i]));
+    }
+    // Overlapping last vector; min is unaffected by elements seen twice
+    min_vec = vminq_u16(min_vec, vld1q_u16(&array[count - 8]));
+    const uint16_t min_val = vminvq_u16(min_vec);
+    
+    // Narrow lanes cannot carry indices, so locate the first occurrence in an early-exit pass
+    const uint16x8_t target = vdupq_n_u16(min_val);
+    for (size_t i = 0; i + 8 <= count; i += 8) {
+        const uint16x8_t hits = vceqq_u16(vld1q_u16(&array[i]), target);
+        if (vmaxvq_u16(hits) != 0) return i + simd_tail::first_set_lane(hits);
+    }
+    
+    return count - 8 + simd_tail::first_set_lane(vceqq_u16(vld1q_u16(&array[count - 8]), target));
+}
+
+/**
+ * @brief Find index of minimum value in int16 array
+ * @param array Input array to search
+ * @param count Number of elements in array
+ * @return Index of first minimum value (0 if array is empty)
+ */
+inline size_t min_index(const int16_t* array, size_t count) {
+    if (count == 0) return 0;
+    
+    int16x8_t min_vec;
+    if (count < 8) {
+        // Pad with copies of array[0]; padding lies after every real element, so it is never the first hit
+        simd_tail::Partial<int16_t> block;
+        block.load(array, count, array[0]);
+        min_vec = vld1q_s16(block.lanes);
+        const int16_t min_val = vminvq_s16(min_vec);
+        return simd_tail::first_set_lane(vceqq_s16(min_vec, vdupq_n_s16(min_val)));
+    }
+    
+    min_vec = vld1q_s16(array);
+    for (size_t i = 8; i + 8 <= count; i += 8) {
+        min_vec = vminq_s16(min_vec, vld1q_s16(&array[i]));
+    }
+    // Overlapping last vector; min is unaffected by elements seen twice
+    min_vec = vminq_s16(min_vec, vld1q_s16(&array[count - 8]));
+    const int16_t min_val = vminvq_s16(min_vec);
+    
+    // Narrow lanes cannot carry indices, so locate the first occurrence in an early-exit pass
+    const int16x8_t target = vdupq_n_s16(min_val);
+    for (size_t i = 0; i + 8 <= count; i += 8) {
+        const uint16x8_t hits = vceqq_s16(vld1q_s16(&array[i]), target);
+        if (vmaxvq_u16(hits) != 0) return i + simd_tail::first_set_lane(hits);
+    }
+    
+    return count - 8 + simd_tail::first_set_lane(vceqq_s16(vld1q_s16(&array[count - 8]), target));
 }
 
 /**
@@ -218,22 +718,52 @@ inline size_t min_index(const float* array, size_t count) {
  */
 inline float cross_correlation(const float* signal1, const float* signal2, size_t length) {
     float32x4_t sum = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    
+    if constexpr (simd_wide::NATIVE) {
+        simd_wide::f32x8 wide_sum = simd_wide::dup(0.0f);
+        for (; i + 8 <= length; i += 8) {
+            wide_sum = simd_wide::fma(wide_sum, simd_wide::load(&signal1[i]), simd_wide::load(&signal2[i]));
+        }
+        sum = simd_wide::fold(wide_sum);
+    }
+    
     const size_t simd_count = length & ~3;
     
-    for (size_t i = 0; i < simd_count; i += 4) {
+    for (; i < simd_count; i += 4) {
         float32x4_t s1 = vld1q_f32(&signal1[i]);
         float32x4_t s2 = vld1q_f32(&signal2[i]);
         sum = vfmaq_f32(sum, s1, s2);
     }
     
-    float32x2_t sum_pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
-    float result = vget_lane_f32(vpadd_f32(sum_pair, sum_pair), 0);
-    
-    for (size_t i = simd_count; i < length; ++i) {
-        result += signal1[i] * signal2[i];
+    // Last length % 4 elements as one vector, the lanes already summed zeroed
+    if (simd_count < length) {
+        sum = vfmaq_f32(sum, simd_tail::load_tail_zeroed(signal1, length), simd_tail::load_tail_zeroed(signal2, length));
     }
     
-    return result;
+    float32x2_t sum_pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+    return vget_lane_f32(vpadd_f32(sum_pair, sum_pair), 0);
+}
+
+/**
+ * @brief Continue an exponential moving average across block boundaries
+ * @param input Input signal array
+ * @param output Filtered output array (may alias input)
+ * @param count Number of elements
+ * @param alpha Smoothing factor (0 < alpha < 1)
+ * @param prev_output Last output of the preceding block
+ *
+ * Evaluated strictly in order: a vector scan would regroup the rounding by
+ * block position, and streamed results must match the whole-array ones bit
+ * for bit whatever the chunk boundaries.
+ */
+inline void exp_moving_average(const float* input, float* output, size_t count,
+                               float alpha, float prev_output) {
+    const float one_minus_alpha = 1.0f - alpha;
+    for (size_t i = 0; i < count; ++i) {
+        prev_output = alpha * input[i] + one_minus_alpha * prev_output;
+        output[i] = prev_output;
+    }
 }
 
 /**
@@ -246,14 +776,29 @@ inline float cross_correlation(const float* signal1, const float* signal2, size_
 inline void exp_moving_average(const float* input, float* output, size_t count, float alpha) {
     if (count == 0) return;
     
-    const float32x4_t alpha_vec = vdupq_n_f32(alpha);
-    const float32x4_t one_minus_alpha = vdupq_n_f32(1.0f - alpha);
-    
-    output[0] = input[0];
-    
-    for (size_t i = 1; i < count; ++i) {
-        output[i] = alpha * input[i] + (1.0f - alpha) * output[i-1];
+    const float first = input[0];
+    output[0] = first;
+    exp_moving_average(input + 1, output + 1, count - 1, alpha, first);
+}
+
+/**
+ * @brief Sixteen threshold comparisons narrowed into one byte vector of 0/1
+ * @param data Sixteen input samples
+ * @param thresh_vec Threshold in every lane
+ */
+inline uint8x16_t threshold_block_f32(const float* data, float32x4_t thresh_vec) {
+    if constexpr (simd_wide::NATIVE) {
+        const simd_wide::f32x8 wide_thresh = simd_wide::dup(vgetq_lane_f32(thresh_vec, 0));
+        return vandq_u8(simd_wide::narrow_masks(simd_wide::greater(simd_wide::load(data), wide_thresh),
+                                                simd_wide::greater(simd_wide::load(data + 8), wide_thresh)),
+                        vdupq_n_u8(1));
     }
+    
+    uint16x8_t lo = vcombine_u16(vmovn_u32(vcgtq_f32(vld1q_f32(data), thresh_vec)),
+                                 vmovn_u32(vcgtq_f32(vld1q_f32(data + 4), thresh_vec)));
+    uint16x8_t hi = vcombine_u16(vmovn_u32(vcgtq_f32(vld1q_f32(data + 8), thresh_vec)),
+                                 vmovn_u32(vcgtq_f32(vld1q_f32(data + 12), thresh_vec)));
+    return vandq_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)), vdupq_n_u8(1));
 }
 
 /**
@@ -266,23 +811,199 @@ inline void exp_moving_average(const float* input, float* output, size_t count,
 inline void threshold_detection(const float* sensor_data, uint8_t* detections,
                                    size_t count, float threshold) {
     const float32x4_t thresh_vec = vdupq_n_f32(threshold);
-    const size_t simd_count = count & ~3;
+    auto detect = [&](const float* data) { return threshold_block_f32(data, thresh_vec); };
     
-    for (size_t i = 0; i < simd_count; i += 4) {
-        float32x4_t data = vld1q_f32(&sensor_data[i]);
-        uint32x4_t mask = vcgtq_f32(data, thresh_vec);
-        uint16x4_t mask16 = vmovn_u32(mask);
-        uint8x8_t mask8 = vmovn_u16(vcombine_u16(mask16, vdup_n_u16(0)));
-        
-        detections[i] = vget_lane_u8(mask8, 0) ? 1 : 0;
-        detections[i+1] = vget_lane_u8(mask8, 1) ? 1 : 0;
-        detections[i+2] = vget_lane_u8(mask8, 2) ? 1 : 0;
-        detections[i+3] = vget_lane_u8(mask8, 3) ? 1 : 0;
+    if (count < 16) {
+        simd_tail::Partial<float, 16> data;
+        simd_tail::Partial<uint8_t> result;
+        data.load(sensor_data, count, 0.0f);
+        vst1q_u8(result.lanes, detect(data.lanes));
+        result.store(detections, count);
+        return;
+    }
+    
+    // Last 16 detections, stored over the overlap at the end
+    const uint8x16_t tail = detect(&sensor_data[count - 16]);
+    
+    const size_t simd_count = count & ~15;
+    for (size_t i = 0; i < simd_count; i += 16) {
+        vst1q_u8(&detections[i], detect(&sensor_data[i]));
+    }
+    
+    vst1q_u8(&detections[count - 16], tail);
+}
+
+
+/**
+ * @brief Detect values above threshold in uint8 sensor data
+ * @param sensor_data Input sensor data array
+ * @param detections Output boolean detection array (1 = above threshold, 0 = below)
+ * @param count Number of elements
+ * @param threshold Detection threshold value
+ */
+inline void threshold_detection(const uint8_t* sensor_data, uint8_t* detections,
+                                size_t count, uint8_t threshold) {
+    const uint8x16_t thresh_vec = vdupq_n_u8(threshold);
+    const uint8x16_t one = vdupq_n_u8(1);
+    
+    if (count < 16) {
+        simd_tail::Partial<uint8_t> data;
+        simd_tail::Partial<uint8_t, 16> result;
+        data.load(sensor_data, count, 0);
+        vst1q_u8(result.lanes, vandq_u8(vcgtq_u8(vld1q_u8(data.lanes), thresh_vec), one));
+        result.store(detections, count);
+        return;
+    }
+    
+    // Last 16 detections, stored over the overlap at the end
+    const uint8x16_t tail = vandq_u8(vcgtq_u8(vld1q_u8(&sensor_data[count - 16]), thresh_vec), one);
+    
+    const size_t simd_count = count & ~15;
+    for (size_t i = 0; i < simd_count; i += 16) {
+        vst1q_u8(&detections[i], vandq_u8(vcgtq_u8(vld1q_u8(&sensor_data[i]), thresh_vec), one));
+    }
+    
+    vst1q_u8(&detections[count - 16], tail);
+}
+
+/**
+ * @brief Detect values above threshold in int8 sensor data
+ * @param sensor_data Input sensor data array
+ * @param detections Output boolean detection array (1 = above threshold, 0 = below)
+ * @param count Number of elements
+ * @param threshold Detection threshold value
+ */
+inline void threshold_detection(const int8_t* sensor_data, uint8_t* detections,
+                                size_t count, int8_t threshold) {
+    const int8x16_t thresh_vec = vdupq_n_s8(threshold);
+    const uint8x16_t one = vdupq_n_u8(1);
+    
+    if (count < 16) {
+        simd_tail::Partial<int8_t> data;
+        simd_tail::Partial<uint8_t, 16> result;
+        data.load(sensor_data, count, 0);
+        vst1q_u8(result.lanes, vandq_u8(vcgtq_s8(vld1q_s8(data.lanes), thresh_vec), one));
+        result.store(detections, count);
+        return;
+    }
+    
+    // Last 16 detections, stored over the overlap at the end
+    const uint8x16_t tail = vandq_u8(vcgtq_s8(vld1q_s8(&sensor_data[count - 16]), thresh_vec), one);
+    
+    const size_t simd_count = count & ~15;
+    for (size_t i = 0; i < simd_count; i += 16) {
+        vst1q_u8(&detections[i], vandq_u8(vcgtq_s8(vld1q_s8(&sensor_data[i]), thresh_vec), one));
+    }
+    
+    vst1q_u8(&detections[count - 16], tail);
+}
+
+/**
+ * @brief Detect values above threshold in uint16 sensor data
+ * @param sensor_data Input sensor data array
+ * @param detections Output boolean detection array (1 = above threshold, 0 = below)
+ * @param count Number of elements
+ * @param threshold Detection threshold value
+ */
+inline void threshold_detection(const uint16_t* sensor_data, uint8_t* detections,
+                                size_t count, uint16_t threshold) {
+    const uint16x8_t thresh_vec = vdupq_n_u16(threshold);
+    const uint8x8_t one = vdup_n_u8(1);
+    
+    if (count < 8) {
+        simd_tail::Partial<uint16_t> data;
+        simd_tail::Partial<uint8_t, 8> result;
+        data.load(sensor_data, count, 0);
+        vst1_u8(result.lanes, vand_u8(vmovn_u16(vcgtq_u16(vld1q_u16(data.lanes), thresh_vec)), one));
+        result.store(detections, count);
+        return;
+    }
+    
+    // Last 8 detections, stored over the overlap at the end
+    const uint8x8_t tail = vand_u8(vmovn_u16(vcgtq_u16(vld1q_u16(&sensor_data[count - 8]), thresh_vec)), one);
+    
+    const size_t simd_count = count & ~7;
+    for (size_t i = 0; i < simd_count; i += 8) {
+        vst1_u8(&detections[i], vand_u8(vmovn_u16(vcgtq_u16(vld1q_u16(&sensor_data[i]), thresh_vec)), one));
+    }
+    
+    vst1_u8(&detections[count - 8], tail);
+}
+
+/**
+ * @brief Detect values above threshold in int16 sensor data
+ * @param sensor_data Input sensor data array
+ * @param detections Output boolean detection array (1 = above threshold, 0 = below)
+ * @param count Number of elements
+ * @param threshold Detection threshold value
+ */
+inline void threshold_detection(const int16_t* sensor_data, uint8_t* detections,
+                                size_t count, int16_t threshold) {
+    const int16x8_t thresh_vec = vdupq_n_s16(threshold);
+    const uint8x8_t one = vdup_n_u8(1);
+    
+    if (count < 8) {
+        simd_tail::Partial<int16_t> data;
+        simd_tail::Partial<uint8_t, 8> result;
+        data.load(sensor_data, count, 0);
+        vst1_u8(result.lanes, vand_u8(vmovn_u16(vcgtq_s16(vld1q_s16(data.lanes), thresh_vec)), one));
+        result.store(detections, count);
+        return;
+    }
+    
+    // Last 8 detections, stored over the overlap at the end
+    const uint8x8_t tail = vand_u8(vmovn_u16(vcgtq_s16(vld1q_s16(&sensor_data[count - 8]), thresh_vec)), one);
+    
+    const size_t simd_count = count & ~7;
+    for (size_t i = 0; i < simd_count; i += 8) {
+        vst1_u8(&detections[i], vand_u8(vmovn_u16(vcgtq_s16(vld1q_s16(&sensor_data[i]), thresh_vec)), one));
+    }
+    
+    vst1_u8(&detections[count - 8], tail);
+}
+
+/**
+ * @brief Detect values above threshold in half-precision sensor data
+ * @param sensor_data Input sensor data array
+ * @param detections Output boolean detection array (1 = above threshold, 0 = below)
+ * @param count Number of elements
+ * @param threshold Detection threshold value
+ *
+ * Samples are widened to single precision before the comparison, which
+ * needs no fp16 arithmetic; cpu_dispatch.h selects a native fp16 version
+ * where the CPU has one.
+ */
+inline void threshold_detection(const float16_t* sensor_data, uint8_t* detections,
+                                size_t count, float threshold) {
+    const float32x4_t thresh_vec = vdupq_n_f32(threshold);
+    const uint8x8_t one = vdup_n_u8(1);
+    
+    // Eight comparisons narrowed into one byte vector of 0/1
+    auto detect = [&](const float16_t* data) {
+        const float16x8_t half = vld1q_f16(data);
+        const uint16x8_t above = vcombine_u16(vmovn_u32(vcgtq_f32(vcvt_f32_f16(vget_low_f16(half)), thresh_vec)),
+                                              vmovn_u32(vcgtq_f32(vcvt_high_f32_f16(half), thresh_vec)));
+        return vand_u8(vmovn_u16(above), one);
+    };
+    
+    if (count < 8) {
+        simd_tail::Partial<float16_t> data;
+        simd_tail::Partial<uint8_t, 8> result;
+        data.load(sensor_data, count, 0);
+        vst1_u8(result.lanes, detect(data.lanes));
+        result.store(detections, count);
+        return;
     }
     
-    for (size_t i = simd_count; i < count; ++i) {
-        detections[i] = sensor_data[i] > threshold ? 1 : 0;
+    // Last 8 detections, stored over the overlap at the end
+    const uint8x8_t tail = detect(&sensor_data[count - 8]);
+    
+    const size_t simd_count = count & ~7;
+    for (size_t i = 0; i < simd_count; i += 8) {
+        vst1_u8(&detections[i], detect(&sensor_data[i]));
     }
+    
+    vst1_u8(&detections[count - 8], tail);
 }
 
 
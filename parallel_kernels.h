@@ -0,0 +1,162 @@
+#ifndef PARALLEL_KERNELS_H
+#define PARALLEL_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "obj_detection_util.h"
+#include "thread_pool.h"
+
+/*
+ * Multi-core versions of the large-array kernels.
+ *
+ * The input is cut into chunks whose boundaries depend only on the element
+ * count, never on the pool size or on which thread ran which chunk. Each
+ * chunk writes its partial result to its own slot and the slots are
+ * combined in chunk order, so a given input always produces the same
+ * result bits. Below PARALLEL_CUTOFF elements the serial kernel is called
+ * directly, as fork-join would cost more than it saves.
+ */
+
+// Elements below which the parallel entry points stay serial
+constexpr size_t PARALLEL_CUTOFF = 1 << 18;
+
+// Smallest chunk handed to one task
+constexpr size_t PARALLEL_MIN_CHUNK = 1 << 16;
+
+// Upper bound on chunks per call (partials live on the stack)
+constexpr size_t PARALLEL_MAX_CHUNKS = 256;
+
+/**
+ * @brief Number of chunks used for a given element count
+ */
+inline size_t parallel_chunk_count(size_t count) {
+    size_t chunks = (count + PARALLEL_MIN_CHUNK - 1) / PARALLEL_MIN_CHUNK;
+    return chunks < PARALLEL_MAX_CHUNKS ? chunks : PARALLEL_MAX_CHUNKS;
+}
+
+/**
+ * @brief First element of a chunk; chunk c covers [chunk_begin(c), chunk_begin(c + 1))
+ */
+inline size_t parallel_chunk_begin(size_t count, size_t chunks, size_t chunk) {
+    // Multiples of 16 keep every chunk start vector- and cache-line aligned relative to the base
+    const size_t base = (count / chunks) & ~size_t{15};
+    return chunk == chunks ? count : chunk * base;
+}
+
+/**
+ * @brief Calculate weighted average of an array of values on multiple cores
+ * @param values Array of values to average
+ * @param weights Array of weights corresponding to each value
+ * @param count Number of elements in both arrays
+ * @param pool Thread pool to run on
+ * @return Weighted average result
+ */
+inline float weighted_average_parallel(const float* values, const float* weights, size_t count,
+                                       ThreadPool& pool = default_thread_pool()) {
+    if (count < PARALLEL_CUTOFF) return weighted_average(values, weights, count);
+    
+    const size_t chunks = parallel_chunk_count(count);
+    float partial_weighted[PARALLEL_MAX_CHUNKS];
+    float partial_weights[PARALLEL_MAX_CHUNKS];
+    
+    pool.parallel_for(chunks, [&](size_t c) {
+        const size_t begin = parallel_chunk_begin(count, chunks, c);
+        const size_t end = parallel_chunk_begin(count, chunks, c + 1);
+        weighted_sums(values + begin, weights + begin, end - begin, partial_weighted[c], partial_weights[c]);
+    });
+    
+    float weighted_sum = 0.0f;
+    float weight_sum = 0.0f;
+    for (size_t c = 0; c < chunks; ++c) {
+        weighted_sum += partial_weighted[c];
+        weight_sum += partial_weights[c];
+    }
+    
+    return weight_sum > 0.0f ? weighted_sum / weight_sum : 0.0f;
+}
+
+/**
+ * @brief Calculate cross-correlation between two signals on multiple cores
+ * @param signal1 First signal array
+ * @param signal2 Second signal array
+ * @param length Length of both signals
+ * @param pool Thread pool to run on
+ * @return Cross-correlation value
+ */
+inline float cross_correlation_parallel(const float* signal1, const float* signal2, size_t length,
+                                        ThreadPool& pool = default_thread_pool()) {
+    if (length < PARALLEL_CUTOFF) return cross_correlation(signal1, signal2, length);
+    
+    const size_t chunks = parallel_chunk_count(length);
+    float partial[PARALLEL_MAX_CHUNKS];
+    
+    pool.parallel_for(chunks, [&](size_t c) {
+        const size_t begin = parallel_chunk_begin(length, chunks, c);
+        const size_t end = parallel_chunk_begin(length, chunks, c + 1);
+        partial[c] = cross_correlation(signal1 + begin, signal2 + begin, end - begin);
+    });
+    
+    float result = 0.0f;
+    for (size_t c = 0; c < chunks; ++c) {
+        result += partial[c];
+    }
+    
+    return result;
+}
+
+/**
+ * @brief Find index of minimum value in array on multiple cores
+ * @param array Input array to search
+ * @param count Number of elements in array
+ * @param pool Thread pool to run on
+ * @return Index of the first minimum value (0 if array is empty)
+ */
+inline size_t min_index_parallel(const float* array, size_t count,
+                                 ThreadPool& pool = default_thread_pool()) {
+    if (count < PARALLEL_CUTOFF) return min_index(array, count);
+    
+    const size_t chunks = parallel_chunk_count(count);
+    size_t partial[PARALLEL_MAX_CHUNKS];
+    
+    pool.parallel_for(chunks, [&](size_t c) {
+        const size_t begin = parallel_chunk_begin(count, chunks, c);
+        const size_t end = parallel_chunk_begin(count, chunks, c + 1);
+        partial[c] = begin + min_index(array + begin, end - begin);
+    });
+    
+    // Chunks are visited in order with a strict comparison, so ties keep the earliest index
+    size_t min_idx = partial[0];
+    for (size_t c = 1; c < chunks; ++c) {
+        if (array[partial[c]] < array[min_idx]) min_idx = partial[c];
+    }
+    
+    return min_idx;
+}
+
+/**
+ * @brief Detect values above threshold in sensor data on multiple cores
+ * @param sensor_data Input sensor data array
+ * @param detections Output boolean detection array (1 = above threshold, 0 = below)
+ * @param count Number of elements
+ * @param threshold Detection threshold value
+ * @param pool Thread pool to run on
+ */
+inline void threshold_detection_parallel(const float* sensor_data, uint8_t* detections,
+                                         size_t count, float threshold,
+                                         ThreadPool& pool = default_thread_pool()) {
+    if (count < PARALLEL_CUTOFF) {
+        threshold_detection(sensor_data, detections, count, threshold);
+        return;
+    }
+    
+    const size_t chunks = parallel_chunk_count(count);
+    
+    pool.parallel_for(chunks, [&](size_t c) {
+        const size_t begin = parallel_chunk_begin(count, chunks, c);
+        const size_t end = parallel_chunk_begin(count, chunks, c + 1);
+        threshold_detection(sensor_data + begin, detections + begin, end - begin, threshold);
+    });
+}
+
+#endif // PARALLEL_KERNELS_H
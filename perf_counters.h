@@ -0,0 +1,276 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * Hardware performance counters around a region of code, via perf_event_open.
+ *
+ * Each event is opened on its own for the calling thread, user space only,
+ * so one event the PMU or kernel refuses (common in containers and VMs, or
+ * with perf_event_paranoid > 2) does not disable the others. Counts are
+ * scaled by enabled/running time in case the kernel multiplexes them. When
+ * nothing can be opened, available() is false and callers report wall time
+ * from clock_gettime alone.
+ *
+ * CycleCounter is the same cycles event for timing single short calls: it
+ * is read without stopping it, from user space where the kernel allows.
+ */
+
+enum PerfEvent {
+    PERF_EVENT_CYCLES,
+    PERF_EVENT_INSTRUCTIONS,
+    PERF_EVENT_L1D_MISSES,
+    PERF_EVENT_LLC_MISSES,
+    PERF_EVENT_BRANCH_MISSES,
+    PERF_EVENT_COUNT
+};
+
+/**
+ * @brief Counter values and wall time of one measured region
+ */
+struct PerfSample {
+    uint64_t values[PERF_EVENT_COUNT] = {};
+    bool valid[PERF_EVENT_COUNT] = {};
+    uint64_t wall_ns = 0;
+};
+
+class PerfCounters {
+public:
+    PerfCounters() {
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) fds_[e] = -1;
+#if defined(__linux__)
+        const uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const uint64_t llc_read_miss = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        
+        fds_[PERF_EVENT_CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds_[PERF_EVENT_INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds_[PERF_EVENT_L1D_MISSES] = open_event(PERF_TYPE_HW_CACHE, l1d_read_miss);
+        fds_[PERF_EVENT_LLC_MISSES] = open_event(PERF_TYPE_HW_CACHE, llc_read_miss);
+        fds_[PERF_EVENT_BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    }
+    
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (fds_[e] >= 0) ::close(fds_[e]);
+        }
+#endif
+    }
+    
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    
+    /**
+     * @brief True if at least cycles could be opened
+     */
+    bool available() const { return fds_[PERF_EVENT_CYCLES] >= 0; }
+    
+    /**
+     * @brief True if a specific event could be opened
+     */
+    bool available(PerfEvent event) const { return fds_[event] >= 0; }
+    
+    /**
+     * @brief Reset and start every open counter
+     */
+    void start() {
+#if defined(__linux__)
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (fds_[e] < 0) continue;
+            ::ioctl(fds_[e], PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fds_[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+        start_ns_ = monotonic_ns();
+    }
+    
+    /**
+     * @brief Stop the counters and read them
+     */
+    PerfSample stop() {
+        PerfSample sample;
+        sample.wall_ns = monotonic_ns() - start_ns_;
+#if defined(__linux__)
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (fds_[e] >= 0) ::ioctl(fds_[e], PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (fds_[e] < 0) continue;
+            
+            uint64_t data[3];  // value, time enabled, time running
+            if (::read(fds_[e], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0) continue;
+            
+            sample.values[e] = data[2] < data[1]
+                ? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+                : data[0];
+            sample.valid[e] = true;
+        }
+#endif
+        return sample;
+    }
+    
+    static uint64_t monotonic_ns() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+private:
+#if defined(__linux__)
+    static int open_event(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        
+        const long fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        return fd < 0 ? -1 : static_cast<int>(fd);
+    }
+#endif
+
+    int fds_[PERF_EVENT_COUNT];
+    uint64_t start_ns_ = 0;
+};
+
+/**
+ * @brief Free-running CPU cycle count of the calling thread
+ *
+ * The event's mmap page tells whether the kernel lets user space read the
+ * counter (cap_user_rdpmc): then read() takes it with rdpmc on x86, or
+ * PMCCNTR_EL0/PMXEVCNTR_EL0 on AArch64, in a few cycles. Otherwise read()
+ * falls back to the read() system call, which costs more but is just as
+ * exact. Nothing here traps: the instructions are only used when the
+ * kernel has enabled them.
+ */
+class CycleCounter {
+public:
+    CycleCounter() {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+#if defined(__aarch64__)
+        attr.config1 = 0x3;  // 64-bit counter, user access requested
+#endif
+        
+        const long fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd < 0) return;
+        fd_ = static_cast<int>(fd);
+        
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+        void* page = ::mmap(nullptr, static_cast<size_t>(::sysconf(_SC_PAGESIZE)), PROT_READ, MAP_SHARED, fd_, 0);
+        if (page != MAP_FAILED) {
+            page_ = static_cast<const volatile perf_event_mmap_page*>(page);
+            user_read_ = page_->cap_user_rdpmc;
+        }
+#endif
+#endif
+    }
+    
+    ~CycleCounter() {
+#if defined(__linux__)
+        if (page_) ::munmap(const_cast<perf_event_mmap_page*>(page_), static_cast<size_t>(::sysconf(_SC_PAGESIZE)));
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+    
+    CycleCounter(const CycleCounter&) = delete;
+    CycleCounter& operator=(const CycleCounter&) = delete;
+    
+    /**
+     * @brief True if the cycles event could be opened
+     */
+    bool available() const { return fd_ >= 0; }
+    
+    /**
+     * @brief True if read() reads the counter from user space rather than with a system call
+     */
+    bool user_read() const { return user_read_; }
+    
+    /**
+     * @brief Cycles of this thread so far, ordered against the surrounding code (0 if unavailable)
+     */
+    uint64_t read() const {
+#if defined(__linux__)
+        // Retry while the kernel updates the page (the lock is a sequence count)
+        while (user_read_) {
+            const uint32_t sequence = page_->lock;
+            __atomic_signal_fence(__ATOMIC_SEQ_CST);
+            const uint32_t index = page_->index;
+            const int64_t offset = page_->offset;
+            if (index == 0) break;  // not on the PMU right now
+            
+            const uint32_t width = page_->pmc_width ? page_->pmc_width : 64;
+            const int64_t count = static_cast<int64_t>(read_pmc(index - 1) << (64 - width)) >> (64 - width);
+            __atomic_signal_fence(__ATOMIC_SEQ_CST);
+            if (page_->lock == sequence) return static_cast<uint64_t>(offset + count);
+        }
+        
+        uint64_t value = 0;
+        if (fd_ < 0 || ::read(fd_, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value))) return 0;
+        return value;
+#else
+        return 0;
+#endif
+    }
+
+private:
+    /**
+     * @brief Raw value of hardware counter `index`, as numbered in the mmap page
+     */
+    static uint64_t read_pmc(uint32_t index) {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_lfence();
+        const uint64_t value = __rdpmc(static_cast<int>(index));
+        _mm_lfence();
+        return value;
+#elif defined(__aarch64__)
+        uint64_t value;
+        if (index == 31) {
+            asm volatile("isb\n\tmrs %0, pmccntr_el0" : "=r"(value) : : "memory");
+        } else {
+            asm volatile("msr pmselr_el0, %1\n\tisb\n\tmrs %0, pmxevcntr_el0"
+                         : "=r"(value) : "r"(static_cast<uint64_t>(index)) : "memory");
+        }
+        return value;
+#else
+        (void)index;
+        return 0;
+#endif
+    }
+    
+    int fd_ = -1;
+    bool user_read_ = false;
+#if defined(__linux__)
+    const volatile perf_event_mmap_page* page_ = nullptr;
+#endif
+};
+
+#endif // PERF_COUNTERS_H
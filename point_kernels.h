@@ -0,0 +1,581 @@
+#ifndef POINT_KERNELS_H
+#define POINT_KERNELS_H
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "simd.h"
+#include "simd_tail.h"
+#include "obj_detection_util.h"
+
+/*
+ * Distance kernels and layout transposes for interleaved (array of
+ * structs) point buffers, the layout detections arrive in:
+ *
+ *   xy:  {x0, y0, x1, y1, ...}           e.g. an array of struct { float x, y; }
+ *   xyz: {x0, y0, z0, x1, y1, z1, ...}   e.g. an array of struct { float x, y, z; }
+ *
+ * The distance kernels read these buffers directly. vld2q_f32/vld3q_f32
+ * split four points into one vector per coordinate as they load, which is
+ * the SoA form vector_distance_squared() works on, so no transposed copy of
+ * the point cloud is made. When the same points go through many SoA
+ * kernels, deinterleave_xy()/deinterleave_xyz() convert them once instead,
+ * and interleave_xy()/interleave_xyz() convert back.
+ *
+ * Counts are in points, not floats. Tails follow simd_tail.h: the last four
+ * points are recomputed and stored over the overlap, and arrays shorter than
+ * four points are staged through simd_tail::Partial.
+ *
+ * nearest_point() and nearest_points() fuse the distance computation with
+ * min_index(): they keep the running minimum and its index in registers
+ * and never write the distances out, so a query reads each point once and
+ * writes nothing. They return what min_index() would over the distance
+ * array, including the lowest index on ties, and take SoA or interleaved
+ * xy points. With no points the index is NEAREST_POINT_NONE; the running
+ * minimum starts at FLT_MAX rather than infinity, which -ffast-math
+ * assumes away, so squared distances must stay finite.
+ */
+
+/**
+ * @brief Calculate squared distance between two 3D points using NEON vectors
+ * @param x1 X coordinates of first points
+ * @param y1 Y coordinates of first points
+ * @param z1 Z coordinates of first points
+ * @param x2 X coordinates of second points
+ * @param y2 Y coordinates of second points
+ * @param z2 Z coordinates of second points
+ * @return Squared distances for each point pair
+ */
+inline float32x4_t vector_distance_squared_xyz(float32x4_t x1, float32x4_t y1, float32x4_t z1,
+                                              float32x4_t x2, float32x4_t y2, float32x4_t z2) {
+    float32x4_t dx = vsubq_f32(x2, x1);
+    float32x4_t dy = vsubq_f32(y2, y1);
+    float32x4_t dz = vsubq_f32(z2, z1);
+    
+    // Same rounding whether the caller loaded the points interleaved or not
+    return vaddq_f32(keep_sum_order(vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy))), vmulq_f32(dz, dz));
+}
+
+namespace point_detail {
+
+/**
+ * @brief De-interleave fewer than four xy points, zero-filling the missing ones
+ */
+inline float32x4x2_t load_xy_partial(const float* xy, size_t count) {
+    simd_tail::Partial<float, 8> p;
+    p.load(xy, count * 2, 0.0f);
+    return vld2q_f32(p.lanes);
+}
+
+/**
+ * @brief De-interleave fewer than four xyz points, zero-filling the missing ones
+ */
+inline float32x4x3_t load_xyz_partial(const float* xyz, size_t count) {
+    simd_tail::Partial<float, 12> p;
+    p.load(xyz, count * 3, 0.0f);
+    return vld3q_f32(p.lanes);
+}
+
+/**
+ * @brief Store the first `count` (< 4) lanes of v
+ */
+inline void store_partial(float* dst, float32x4_t v, size_t count) {
+    simd_tail::Partial<float> p;
+    vst1q_f32(p.lanes, v);
+    p.store(dst, count);
+}
+
+} // namespace point_detail
+
+/**
+ * @brief Squared distances between corresponding points of two interleaved xy arrays
+ * @param a_xy First points, {x, y} pairs
+ * @param b_xy Second points, {x, y} pairs
+ * @param distances Output squared distances, one per point
+ * @param count Number of points in each array
+ */
+inline void distance_squared_xy(const float* a_xy, const float* b_xy, float* distances, size_t count) {
+    if (count < 4) {
+        const float32x4x2_t a = point_detail::load_xy_partial(a_xy, count);
+        const float32x4x2_t b = point_detail::load_xy_partial(b_xy, count);
+        point_detail::store_partial(distances, vector_distance_squared(a.val[0], a.val[1], b.val[0], b.val[1]), count);
+        return;
+    }
+    
+    // Last four points, computed up front and stored over the overlap at the end
+    const size_t last = count - 4;
+    const float32x4x2_t a_tail = vld2q_f32(&a_xy[last * 2]);
+    const float32x4x2_t b_tail = vld2q_f32(&b_xy[last * 2]);
+    const float32x4_t tail = vector_distance_squared(a_tail.val[0], a_tail.val[1], b_tail.val[0], b_tail.val[1]);
+    
+    const size_t simd_count = count & ~3;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        float32x4x2_t a = vld2q_f32(&a_xy[i * 2]);
+        float32x4x2_t b = vld2q_f32(&b_xy[i * 2]);
+        vst1q_f32(&distances[i], vector_distance_squared(a.val[0], a.val[1], b.val[0], b.val[1]));
+    }
+    
+    vst1q_f32(&distances[last], tail);
+}
+
+/**
+ * @brief Squared distances from every point of an interleaved xy array to one query point
+ * @param xy Points, {x, y} pairs
+ * @param query_x X coordinate of the query point
+ * @param query_y Y coordinate of the query point
+ * @param distances Output squared distances, one per point
+ * @param count Number of points
+ */
+inline void distance_squared_to_point_xy(const float* xy, float query_x, float query_y,
+                                         float* distances, size_t count) {
+    const float32x4_t qx = vdupq_n_f32(query_x);
+    const float32x4_t qy = vdupq_n_f32(query_y);
+    
+    if (count < 4) {
+        const float32x4x2_t p = point_detail::load_xy_partial(xy, count);
+        point_detail::store_partial(distances, vector_distance_squared(qx, qy, p.val[0], p.val[1]), count);
+        return;
+    }
+    
+    const size_t last = count - 4;
+    const float32x4x2_t p_tail = vld2q_f32(&xy[last * 2]);
+    const float32x4_t tail = vector_distance_squared(qx, qy, p_tail.val[0], p_tail.val[1]);
+    
+    const size_t simd_count = count & ~3;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        float32x4x2_t p = vld2q_f32(&xy[i * 2]);
+        vst1q_f32(&distances[i], vector_distance_squared(qx, qy, p.val[0], p.val[1]));
+    }
+    
+    vst1q_f32(&distances[last], tail);
+}
+
+/**
+ * @brief Squared distances between corresponding points of two interleaved xyz arrays
+ * @param a_xyz First points, {x, y, z} triples
+ * @param b_xyz Second points, {x, y, z} triples
+ * @param distances Output squared distances, one per point
+ * @param count Number of points in each array
+ */
+inline void distance_squared_xyz(const float* a_xyz, const float* b_xyz, float* distances, size_t count) {
+    if (count < 4) {
+        const float32x4x3_t a = point_detail::load_xyz_partial(a_xyz, count);
+        const float32x4x3_t b = point_detail::load_xyz_partial(b_xyz, count);
+        point_detail::store_partial(distances, vector_distance_squared_xyz(a.val[0], a.val[1], a.val[2],
+                                                                           b.val[0], b.val[1], b.val[2]), count);
+        return;
+    }
+    
+    const size_t last = count - 4;
+    const float32x4x3_t a_tail = vld3q_f32(&a_xyz[last * 3]);
+    const float32x4x3_t b_tail = vld3q_f32(&b_xyz[last * 3]);
+    const float32x4_t tail = vector_distance_squared_xyz(a_tail.val[0], a_tail.val[1], a_tail.val[2],
+                                                         b_tail.val[0], b_tail.val[1], b_tail.val[2]);
+    
+    const size_t simd_count = count & ~3;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        float32x4x3_t a = vld3q_f32(&a_xyz[i * 3]);
+        float32x4x3_t b = vld3q_f32(&b_xyz[i * 3]);
+        vst1q_f32(&distances[i], vector_distance_squared_xyz(a.val[0], a.val[1], a.val[2], b.val[0], b.val[1], b.val[2]));
+    }
+    
+    vst1q_f32(&distances[last], tail);
+}
+
+/**
+ * @brief Squared distances from every point of an interleaved xyz array to one query point
+ * @param xyz Points, {x, y, z} triples
+ * @param query_x X coordinate of the query point
+ * @param query_y Y coordinate of the query point
+ * @param query_z Z coordinate of the query point
+ * @param distances Output squared distances, one per point
+ * @param count Number of points
+ */
+inline void distance_squared_to_point_xyz(const float* xyz, float query_x, float query_y, float query_z,
+                                          float* distances, size_t count) {
+    const float32x4_t qx = vdupq_n_f32(query_x);
+    const float32x4_t qy = vdupq_n_f32(query_y);
+    const float32x4_t qz = vdupq_n_f32(query_z);
+    
+    if (count < 4) {
+        const float32x4x3_t p = point_detail::load_xyz_partial(xyz, count);
+        point_detail::store_partial(distances, vector_distance_squared_xyz(qx, qy, qz, p.val[0], p.val[1], p.val[2]), count);
+        return;
+    }
+    
+    const size_t last = count - 4;
+    const float32x4x3_t p_tail = vld3q_f32(&xyz[last * 3]);
+    const float32x4_t tail = vector_distance_squared_xyz(qx, qy, qz, p_tail.val[0], p_tail.val[1], p_tail.val[2]);
+    
+    const size_t simd_count = count & ~3;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        float32x4x3_t p = vld3q_f32(&xyz[i * 3]);
+        vst1q_f32(&distances[i], vector_distance_squared_xyz(qx, qy, qz, p.val[0], p.val[1], p.val[2]));
+    }
+    
+    vst1q_f32(&distances[last], tail);
+}
+
+/**
+ * @brief Split interleaved xy points into separate x and y arrays (AoS to SoA)
+ * @param xy Points, {x, y} pairs
+ * @param x Output x coordinates
+ * @param y Output y coordinates
+ * @param count Number of points
+ */
+inline void deinterleave_xy(const float* xy, float* x, float* y, size_t count) {
+    if (count < 4) {
+        const float32x4x2_t p = point_detail::load_xy_partial(xy, count);
+        point_detail::store_partial(x, p.val[0], count);
+        point_detail::store_partial(y, p.val[1], count);
+        return;
+    }
+    
+    const size_t last = count - 4;
+    const float32x4x2_t tail = vld2q_f32(&xy[last * 2]);
+    
+    const size_t simd_count = count & ~3;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        float32x4x2_t p = vld2q_f32(&xy[i * 2]);
+        vst1q_f32(&x[i], p.val[0]);
+        vst1q_f32(&y[i], p.val[1]);
+    }
+    
+    vst1q_f32(&x[last], tail.val[0]);
+    vst1q_f32(&y[last], tail.val[1]);
+}
+
+/**
+ * @brief Merge separate x and y arrays into interleaved xy points (SoA to AoS)
+ * @param x X coordinates
+ * @param y Y coordinates
+ * @param xy Output points, {x, y} pairs
+ * @param count Number of points
+ */
+inline void interleave_xy(const float* x, const float* y, float* xy, size_t count) {
+    if (count < 4) {
+        simd_tail::Partial<float> px, py;
+        simd_tail::Partial<float, 8> p;
+        px.load(x, count, 0.0f);
+        py.load(y, count, 0.0f);
+        const float32x4x2_t points = {{vld1q_f32(px.lanes), vld1q_f32(py.lanes)}};
+        vst2q_f32(p.lanes, points);
+        p.store(xy, count * 2);
+        return;
+    }
+    
+    const size_t last = count - 4;
+    const float32x4x2_t tail = {{vld1q_f32(&x[last]), vld1q_f32(&y[last])}};
+    
+    const size_t simd_count = count & ~3;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        const float32x4x2_t points = {{vld1q_f32(&x[i]), vld1q_f32(&y[i])}};
+        vst2q_f32(&xy[i * 2], points);
+    }
+    
+    vst2q_f32(&xy[last * 2], tail);
+}
+
+/**
+ * @brief Split interleaved xyz points into separate x, y and z arrays (AoS to SoA)
+ * @param xyz Points, {x, y, z} triples
+ * @param x Output x coordinates
+ * @param y Output y coordinates
+ * @param z Output z coordinates
+ * @param count Number of points
+ */
+inline void deinterleave_xyz(const float* xyz, float* x, float* y, float* z, size_t count) {
+    if (count < 4) {
+        const float32x4x3_t p = point_detail::load_xyz_partial(xyz, count);
+        point_detail::store_partial(x, p.val[0], count);
+        point_detail::store_partial(y, p.val[1], count);
+        point_detail::store_partial(z, p.val[2], count);
+        return;
+    }
+    
+    const size_t last = count - 4;
+    const float32x4x3_t tail = vld3q_f32(&xyz[last * 3]);
+    
+    const size_t simd_count = count & ~3;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        float32x4x3_t p = vld3q_f32(&xyz[i * 3]);
+        vst1q_f32(&x[i], p.val[0]);
+        vst1q_f32(&y[i], p.val[1]);
+        vst1q_f32(&z[i], p.val[2]);
+    }
+    
+    vst1q_f32(&x[last], tail.val[0]);
+    vst1q_f32(&y[last], tail.val[1]);
+    vst1q_f32(&z[last], tail.val[2]);
+}
+
+/**
+ * @brief Merge separate x, y and z arrays into interleaved xyz points (SoA to AoS)
+ * @param x X coordinates
+ * @param y Y coordinates
+ * @param z Z coordinates
+ * @param xyz Output points, {x, y, z} triples
+ * @param count Number of points
+ */
+inline void interleave_xyz(const float* x, const float* y, const float* z, float* xyz, size_t count) {
+    if (count < 4) {
+        simd_tail::Partial<float> px, py, pz;
+        simd_tail::Partial<float, 12> p;
+        px.load(x, count, 0.0f);
+        py.load(y, count, 0.0f);
+        pz.load(z, count, 0.0f);
+        const float32x4x3_t points = {{vld1q_f32(px.lanes), vld1q_f32(py.lanes), vld1q_f32(pz.lanes)}};
+        vst3q_f32(p.lanes, points);
+        p.store(xyz, count * 3);
+        return;
+    }
+    
+    const size_t last = count - 4;
+    const float32x4x3_t tail = {{vld1q_f32(&x[last]), vld1q_f32(&y[last]), vld1q_f32(&z[last])}};
+    
+    const size_t simd_count = count & ~3;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        const float32x4x3_t points = {{vld1q_f32(&x[i]), vld1q_f32(&y[i]), vld1q_f32(&z[i])}};
+        vst3q_f32(&xyz[i * 3], points);
+    }
+    
+    vst3q_f32(&xyz[last * 3], tail);
+}
+
+// NearestPoint::index when there are no points
+constexpr size_t NEAREST_POINT_NONE = SIZE_MAX;
+
+/**
+ * @brief Closest point to a query
+ */
+struct NearestPoint {
+    size_t index;            // first point at the minimum distance (NEAREST_POINT_NONE if there are no points)
+    float distance_squared;  // its squared distance (FLT_MAX if there are no points)
+};
+
+namespace point_detail {
+
+/**
+ * @brief Running minimum over squared distances, one candidate per lane
+ *
+ * Lanes that have seen no point keep index UINT32_MAX.
+ */
+struct NearestLanes {
+    float32x4_t distance = vdupq_n_f32(FLT_MAX);
+    uint32x4_t index = vdupq_n_u32(UINT32_MAX);
+    
+    /**
+     * @brief Take the lanes of d that are strictly closer, keeping earlier indices on ties
+     */
+    void update(float32x4_t d, uint32x4_t idx) {
+        const uint32x4_t closer = vcltq_f32(d, distance);
+        distance = vbslq_f32(closer, d, distance);
+        index = vbslq_u32(closer, idx, index);
+    }
+    
+    /**
+     * @brief Closest candidate across lanes, the lowest index among equal distances
+     */
+    NearestPoint reduce() const {
+        const float min_distance = vminnmvq_f32(distance);
+        const uint32x4_t candidates = vbslq_u32(vceqq_f32(distance, vdupq_n_f32(min_distance)),
+                                                index, vdupq_n_u32(UINT32_MAX));
+        const uint32_t min_idx = vminvq_u32(candidates);
+        return {min_idx == UINT32_MAX ? NEAREST_POINT_NONE : min_idx, min_distance};
+    }
+};
+
+/**
+ * @brief Nearest of `count` points to (qx, qy), four points per lane step
+ * @param load Returns the x and y vectors of points [i, i + 4)
+ * @param load_partial Returns points [0, count) zero-padded, for count < 4
+ */
+template <typename Load, typename LoadPartial>
+inline NearestPoint nearest_point_scan(size_t count, float query_x, float query_y, Load load, LoadPartial load_partial) {
+    if (count == 0) return {NEAREST_POINT_NONE, FLT_MAX};
+    
+    const float32x4_t qx = vdupq_n_f32(query_x);
+    const float32x4_t qy = vdupq_n_f32(query_y);
+    const uint32x4_t lane = {0, 1, 2, 3};
+    NearestLanes nearest;
+    
+    if (count < 4) {
+        // Padding lanes sit at FLT_MAX, which is never closer, so they keep no index
+        const float32x4x2_t p = load_partial(count);
+        const uint32x4_t valid = vcltq_u32(lane, vdupq_n_u32(static_cast<uint32_t>(count)));
+        const float32x4_t d = vector_distance_squared(qx, qy, p.val[0], p.val[1]);
+        nearest.update(vbslq_f32(valid, d, vdupq_n_f32(FLT_MAX)), lane);
+        return nearest.reduce();
+    }
+    
+    const size_t simd_count = count & ~3;
+    uint32x4_t idx = lane;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        const float32x4x2_t p = load(i);
+        nearest.update(vector_distance_squared(qx, qy, p.val[0], p.val[1]), idx);
+        idx = vaddq_u32(idx, vdupq_n_u32(4));
+    }
+    
+    // Overlapping last vector: points seen twice keep their index, so they cannot move the result
+    if (simd_count < count) {
+        const float32x4x2_t p = load(count - 4);
+        nearest.update(vector_distance_squared(qx, qy, p.val[0], p.val[1]),
+                       vaddq_u32(lane, vdupq_n_u32(static_cast<uint32_t>(count - 4))));
+    }
+    return nearest.reduce();
+}
+
+/**
+ * @brief Nearest point for 4 * Groups queries, one query per lane
+ *
+ * Each point is broadcast and compared against every query at once, so the
+ * per-lane minimum is already the answer and no reduction is needed. The
+ * points are read once for the whole batch.
+ *
+ * @param load Returns the x and y vectors of points [i, i + 4)
+ * @param point Returns the x and y of point i
+ */
+template <size_t Groups, typename Load, typename Point>
+inline void nearest_points_block(size_t count, const float32x4_t (&qx)[Groups], const float32x4_t (&qy)[Groups],
+                                 NearestLanes (&nearest)[Groups], Load load, Point point) {
+    auto visit = [&](float32x4_t px, float32x4_t py, size_t i) {
+        const uint32x4_t idx = vdupq_n_u32(static_cast<uint32_t>(i));
+        for (size_t g = 0; g < Groups; ++g) {
+            nearest[g].update(vector_distance_squared(qx[g], qy[g], px, py), idx);
+        }
+    };
+    
+    const size_t simd_count = count & ~3;
+    for (size_t i = 0; i < simd_count; i += 4) {
+        const float32x4x2_t p = load(i);
+        visit(vdupq_laneq_f32(p.val[0], 0), vdupq_laneq_f32(p.val[1], 0), i);
+        visit(vdupq_laneq_f32(p.val[0], 1), vdupq_laneq_f32(p.val[1], 1), i + 1);
+        visit(vdupq_laneq_f32(p.val[0], 2), vdupq_laneq_f32(p.val[1], 2), i + 2);
+        visit(vdupq_laneq_f32(p.val[0], 3), vdupq_laneq_f32(p.val[1], 3), i + 3);
+    }
+    for (size_t i = simd_count; i < count; ++i) {
+        const float32x4x2_t p = point(i);
+        visit(p.val[0], p.val[1], i);
+    }
+}
+
+/**
+ * @brief Answer every query eight at a time, then the rest as one padded block
+ * @param load_queries Returns the x and y vectors of queries [q, q + n), n <= 4, zero-padded
+ */
+template <typename LoadQueries, typename Load, typename Point>
+inline void nearest_points_batch(size_t count, size_t num_queries, NearestPoint* nearest,
+                                 LoadQueries load_queries, Load load, Point point) {
+    auto run = [&](auto groups, size_t q, size_t n) {
+        constexpr size_t Groups = decltype(groups)::value;
+        float32x4_t qx[Groups], qy[Groups];
+        NearestLanes lanes[Groups];
+        for (size_t g = 0; g < Groups; ++g) {
+            const size_t begin = g * 4 < n ? g * 4 : n;
+            const size_t group_n = n - begin < 4 ? n - begin : 4;
+            const float32x4x2_t query = load_queries(q + begin, group_n);
+            qx[g] = query.val[0];
+            qy[g] = query.val[1];
+        }
+        
+        nearest_points_block<Groups>(count, qx, qy, lanes, load, point);
+        
+        for (size_t g = 0; g < Groups; ++g) {
+            float distance[4];
+            uint32_t index[4];
+            vst1q_f32(distance, lanes[g].distance);
+            vst1q_u32(index, lanes[g].index);
+            for (size_t k = 0; k < 4 && g * 4 + k < n; ++k) {
+                nearest[q + g * 4 + k] = {index[k] == UINT32_MAX ? NEAREST_POINT_NONE : index[k], distance[k]};
+            }
+        }
+    };
+    
+    size_t q = 0;
+    for (; q + 8 <= num_queries; q += 8) run(std::integral_constant<size_t, 2>{}, q, 8);
+    if (num_queries - q > 4) {
+        run(std::integral_constant<size_t, 2>{}, q, num_queries - q);
+    } else if (q < num_queries) {
+        run(std::integral_constant<size_t, 1>{}, q, num_queries - q);
+    }
+}
+
+} // namespace point_detail
+
+/**
+ * @brief Nearest point to a query, without writing out the distances
+ * @param x X coordinates of the points
+ * @param y Y coordinates of the points
+ * @param count Number of points
+ * @param query_x X coordinate of the query point
+ * @param query_y Y coordinate of the query point
+ * @return Index and squared distance of the first closest point, index NEAREST_POINT_NONE if count is 0
+ */
+inline NearestPoint nearest_point(const float* x, const float* y, size_t count, float query_x, float query_y) {
+    return point_detail::nearest_point_scan(count, query_x, query_y,
+        [=](size_t i) { return float32x4x2_t{{vld1q_f32(&x[i]), vld1q_f32(&y[i])}}; },
+        [=](size_t n) {
+            simd_tail::Partial<float> px, py;
+            px.load(x, n, 0.0f);
+            py.load(y, n, 0.0f);
+            return float32x4x2_t{{vld1q_f32(px.lanes), vld1q_f32(py.lanes)}};
+        });
+}
+
+/**
+ * @brief Nearest point of an interleaved xy array to a query, without writing out the distances
+ * @param xy Points, {x, y} pairs
+ * @param count Number of points
+ * @param query_x X coordinate of the query point
+ * @param query_y Y coordinate of the query point
+ * @return Index and squared distance of the first closest point, index NEAREST_POINT_NONE if count is 0
+ */
+inline NearestPoint nearest_point_xy(const float* xy, size_t count, float query_x, float query_y) {
+    return point_detail::nearest_point_scan(count, query_x, query_y,
+        [=](size_t i) { return vld2q_f32(&xy[i * 2]); },
+        [=](size_t n) { return point_detail::load_xy_partial(xy, n); });
+}
+
+/**
+ * @brief Nearest point to each of several queries, reading the points once per eight queries
+ * @param x X coordinates of the points
+ * @param y Y coordinates of the points
+ * @param count Number of points
+ * @param query_x X coordinates of the queries
+ * @param query_y Y coordinates of the queries
+ * @param num_queries Number of queries
+ * @param nearest Output, one result per query
+ */
+inline void nearest_points(const float* x, const float* y, size_t count,
+                           const float* query_x, const float* query_y, size_t num_queries, NearestPoint* nearest) {
+    point_detail::nearest_points_batch(count, num_queries, nearest,
+        [=](size_t q, size_t n) {
+            simd_tail::Partial<float> qx, qy;
+            qx.load(query_x + q, n, 0.0f);
+            qy.load(query_y + q, n, 0.0f);
+            return float32x4x2_t{{vld1q_f32(qx.lanes), vld1q_f32(qy.lanes)}};
+        },
+        [=](size_t i) { return float32x4x2_t{{vld1q_f32(&x[i]), vld1q_f32(&y[i])}}; },
+        [=](size_t i) { return float32x4x2_t{{vdupq_n_f32(x[i]), vdupq_n_f32(y[i])}}; });
+}
+
+/**
+ * @brief Nearest point of an interleaved xy array to each of several interleaved queries
+ * @param xy Points, {x, y} pairs
+ * @param count Number of points
+ * @param query_xy Queries, {x, y} pairs
+ * @param num_queries Number of queries
+ * @param nearest Output, one result per query
+ */
+inline void nearest_points_xy(const float* xy, size_t count, const float* query_xy, size_t num_queries,
+                              NearestPoint* nearest) {
+    point_detail::nearest_points_batch(count, num_queries, nearest,
+        [=](size_t q, size_t n) { return point_detail::load_xy_partial(query_xy + q * 2, n); },
+        [=](size_t i) { return vld2q_f32(&xy[i * 2]); },
+        [=](size_t i) { return float32x4x2_t{{vdupq_n_f32(xy[i * 2]), vdupq_n_f32(xy[i * 2 + 1])}}; });
+}
+
+#endif // POINT_KERNELS_H
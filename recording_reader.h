@@ -0,0 +1,287 @@
+#ifndef RECORDING_READER_H
+#define RECORDING_READER_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "obj_detection_util.h"
+
+/*
+ * Memory-mapped replay of raw columnar float recordings.
+ *
+ * File layout (little-endian):
+ *
+ *     RecordingHeader                     64 bytes
+ *     channel 0: num_samples floats       padded to column_stride bytes
+ *     channel 1: ...
+ *
+ * column_stride is a multiple of 64, so with the page-aligned mapping every
+ * column starts on a cache line and is padded to whole lines, which also
+ * satisfies the aligned_t kernel overloads.
+ *
+ * MappedRecording maps the file read-only and hands out pointers into the
+ * mapping, so kernels run straight over the page cache with no copy and no
+ * second resident buffer. The mapping is marked MADV_SEQUENTIAL, and
+ * for_each_chunk() issues MADV_WILLNEED for the next chunk before the
+ * current one is processed so read-ahead overlaps the kernels. Because the
+ * column is contiguous, a chunk may also read samples before its start;
+ * this is how windowed filters keep their state across chunks.
+ */
+
+constexpr char RECORDING_MAGIC[8] = {'A', 'R', 'M', 'S', 'R', 'E', 'C', '1'};
+constexpr uint32_t RECORDING_VERSION = 1;
+constexpr size_t RECORDING_HEADER_SIZE = 64;
+
+struct RecordingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_channels;
+    uint64_t num_samples;
+    uint64_t column_stride;  // bytes from one channel's first sample to the next
+    uint8_t reserved[32];
+};
+
+static_assert(sizeof(RecordingHeader) == RECORDING_HEADER_SIZE, "header must fill one cache line");
+
+/**
+ * @brief Write a raw columnar recording
+ * @param path Output file
+ * @param channels Array of num_channels column pointers
+ * @param num_channels Number of channels
+ * @param num_samples Samples per channel
+ * @throws std::runtime_error if the file cannot be written
+ */
+inline void write_recording(const std::string& path, const float* const* channels,
+                            size_t num_channels, size_t num_samples) {
+    RecordingHeader header = {};
+    std::memcpy(header.magic, RECORDING_MAGIC, sizeof(header.magic));
+    header.version = RECORDING_VERSION;
+    header.num_channels = static_cast<uint32_t>(num_channels);
+    header.num_samples = num_samples;
+    header.column_stride = (num_samples * sizeof(float) + 63) & ~uint64_t{63};
+    
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) throw std::runtime_error("cannot create recording " + path + ": " + std::strerror(errno));
+    
+    static const uint8_t zeros[64] = {};
+    const size_t padding = header.column_stride - num_samples * sizeof(float);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    for (size_t c = 0; ok && c < num_channels; ++c) {
+        ok = std::fwrite(channels[c], sizeof(float), num_samples, file) == num_samples &&
+             std::fwrite(zeros, 1, padding, file) == padding;
+    }
+    
+    if (std::fclose(file) != 0 || !ok) throw std::runtime_error("cannot write recording " + path);
+}
+
+/**
+ * @brief Mapping options
+ */
+struct MapOptions {
+    // Ask for transparent huge pages on the mapping (needs read-only THP support for files);
+    // ignored where unsupported
+    bool huge_pages = false;
+    // Fault the whole file in up front instead of on first touch
+    bool populate = false;
+};
+
+/**
+ * @brief Read-only mapping of a whole file
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Map a file
+     * @param path File to map
+     * @param options Mapping options
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& path, MapOptions options = MapOptions()) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+        
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("empty or unreadable file: " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        if (options.populate) flags |= MAP_POPULATE;
+#endif
+        void* base = ::mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+        ::close(fd);  // the mapping keeps the file alive
+        if (base == MAP_FAILED) throw std::runtime_error("cannot map " + path + ": " + std::strerror(errno));
+        base_ = static_cast<const uint8_t*>(base);
+        
+        ::madvise(base, size_, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+        if (options.huge_pages) ::madvise(base, size_, MADV_HUGEPAGE);
+#endif
+    }
+    
+    ~MappedFile() {
+        if (base_) ::munmap(const_cast<uint8_t*>(base_), size_);
+    }
+    
+    MappedFile(MappedFile&& other) noexcept : base_(other.base_), size_(other.size_) {
+        other.base_ = nullptr;
+        other.size_ = 0;
+    }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+    
+    const uint8_t* data() const { return base_; }
+    size_t size() const { return size_; }
+    
+    /**
+     * @brief Hint that a byte range will be read soon
+     */
+    void will_need(const void* begin, size_t bytes) const {
+        if (bytes == 0) return;
+        const uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+        const uintptr_t first = reinterpret_cast<uintptr_t>(begin) & ~(page - 1);
+        const uintptr_t last = reinterpret_cast<uintptr_t>(begin) + bytes;
+        ::madvise(reinterpret_cast<void*>(first), last - first, MADV_WILLNEED);
+    }
+
+private:
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Read-only memory-mapped columnar recording
+ */
+class MappedRecording {
+public:
+    /**
+     * @brief Map a recording file
+     * @param path Recording written by write_recording()
+     * @param options Mapping options
+     * @throws std::runtime_error if the file cannot be opened or is not a valid recording
+     */
+    explicit MappedRecording(const std::string& path, MapOptions options = MapOptions())
+        : file_(path, options) {
+        if (file_.size() < RECORDING_HEADER_SIZE) throw std::runtime_error("recording too small: " + path);
+        
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        
+        // The sizes come from the file, so a product that wraps means a corrupt or crafted header
+        uint64_t column_bytes = 0, columns_bytes = 0;
+        const bool sizes_fit =
+            !__builtin_mul_overflow(header_.num_samples, uint64_t{sizeof(float)}, &column_bytes) &&
+            !__builtin_mul_overflow(uint64_t{header_.num_channels}, header_.column_stride, &columns_bytes);
+        const bool valid = std::memcmp(header_.magic, RECORDING_MAGIC, sizeof(header_.magic)) == 0 &&
+                           header_.version == RECORDING_VERSION &&
+                           sizes_fit &&
+                           header_.column_stride % 64 == 0 &&
+                           header_.column_stride >= column_bytes &&
+                           columns_bytes <= file_.size() - RECORDING_HEADER_SIZE;
+        if (!valid) throw std::runtime_error("not a valid recording: " + path);
+    }
+    
+    size_t num_channels() const { return header_.num_channels; }
+    size_t num_samples() const { return header_.num_samples; }
+    
+    /**
+     * @brief Zero-copy pointer to one channel's samples (64-byte aligned, padded to whole lines)
+     */
+    const float* channel(size_t c) const {
+        return reinterpret_cast<const float*>(file_.data() + RECORDING_HEADER_SIZE + c * header_.column_stride);
+    }
+    
+    /**
+     * @brief Hint that a range of samples will be read soon
+     * @param c Channel
+     * @param begin First sample
+     * @param count Number of samples
+     */
+    void prefetch(size_t c, size_t begin, size_t count) const {
+        if (begin >= num_samples()) return;
+        if (count > num_samples() - begin) count = num_samples() - begin;
+        file_.will_need(channel(c) + begin, count * sizeof(float));
+    }
+    
+    /**
+     * @brief Visit one channel in consecutive zero-copy chunks
+     * @param c Channel
+     * @param chunk_samples Samples per chunk (the last chunk may be shorter)
+     * @param fn Callable fn(const float* chunk, size_t n, size_t offset); chunk[-offset..n) is readable
+     *
+     * The next chunk is prefetched before fn runs on the current one.
+     */
+    template <typename F>
+    void for_each_chunk(size_t c, size_t chunk_samples, F&& fn) const {
+        const float* data = channel(c);
+        const size_t total = num_samples();
+        if (chunk_samples == 0) chunk_samples = total;
+        
+        prefetch(c, 0, chunk_samples);
+        for (size_t offset = 0; offset < total; offset += chunk_samples) {
+            const size_t n = total - offset < chunk_samples ? total - offset : chunk_samples;
+            prefetch(c, offset + n, chunk_samples);
+            fn(data + offset, n, offset);
+        }
+    }
+
+private:
+    MappedFile file_;
+    RecordingHeader header_ = {};
+};
+
+/**
+ * @brief Moving average over a chunked stream, using the samples preceding each chunk as history
+ *
+ * Chunks must be consecutive views into one contiguous array, as produced by
+ * MappedRecording::for_each_chunk(); the output matches moving_average_filter()
+ * over the whole array.
+ */
+struct StreamingMovingAverage {
+    size_t window_size;
+    
+    void process(const float* chunk, float* output, size_t n, size_t offset) const {
+        const size_t history = offset < window_size ? offset : window_size - 1;
+        moving_average_filter(chunk, output, n, window_size, history);
+    }
+};
+
+/**
+ * @brief Exponential moving average carried across chunks
+ *
+ * The output matches exp_moving_average() over the whole array.
+ */
+struct StreamingEma {
+    float alpha;
+    float state = 0.0f;
+    bool primed = false;
+    
+    explicit StreamingEma(float alpha_) : alpha(alpha_) {}
+    
+    void process(const float* chunk, float* output, size_t n) {
+        if (n == 0) return;
+        if (!primed) {
+            exp_moving_average(chunk, output, n, alpha);
+            primed = true;
+        } else {
+            exp_moving_average(chunk, output, n, alpha, state);
+        }
+        state = output[n - 1];
+    }
+};
+
+#endif // RECORDING_READER_H
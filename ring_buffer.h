@@ -0,0 +1,300 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include "thread_pool.h"
+
+/*
+ * Ring buffers for handing sensor samples between threads. SpscRing is
+ * lock-free on both sides; MpscRing reserves lock-free but commits in
+ * order, blocking (see its class comment).
+ *
+ * Instead of copying samples in and out, both sides work on spans of the
+ * ring memory directly: a producer asks for the free space, fills it and
+ * commits; a consumer asks for the readable samples, runs kernels on them
+ * in place and releases them. A region that wraps past the end of the
+ * storage comes back as two spans (RingSpans), so a kernel is simply called
+ * once per span, carrying any state (EMA, window history) across the seam.
+ *
+ * Read and write positions are free-running 64-bit counters on separate
+ * cache lines. Each side keeps a private copy of the other side's position
+ * and only re-reads the shared one when the copy says the ring looks full
+ * or empty, so in steady state producer and consumer rarely touch each
+ * other's line. Storage is 64-byte aligned and capacities are powers of two.
+ */
+
+/**
+ * @brief Up to two contiguous pieces of a ring region, in order
+ */
+template <typename T>
+struct RingSpans {
+    T* first = nullptr;
+    size_t first_size = 0;
+    T* second = nullptr;
+    size_t second_size = 0;
+    
+    size_t size() const { return first_size + second_size; }
+    bool empty() const { return size() == 0; }
+    
+    /**
+     * @brief Call fn(data, n, offset) on each non-empty piece; offset counts from the region start
+     */
+    template <typename F>
+    void for_each(F&& fn) const {
+        if (first_size) fn(first, first_size, size_t{0});
+        if (second_size) fn(second, second_size, first_size);
+    }
+};
+
+namespace ring_detail {
+
+inline size_t round_up_pow2(size_t n) {
+    size_t capacity = 1;
+    while (capacity < n) capacity <<= 1;
+    return capacity;
+}
+
+// 64-byte aligned storage for `capacity` elements
+template <typename T>
+struct Storage {
+    static_assert(std::is_trivially_copyable<T>::value, "ring elements are moved with memcpy");
+    
+    explicit Storage(size_t capacity)
+        : data(static_cast<T*>(std::aligned_alloc(64, ((capacity * sizeof(T) + 63) & ~size_t{63})))) {
+        if (!data) throw std::bad_alloc();
+    }
+    ~Storage() { std::free(data); }
+    
+    Storage(const Storage&) = delete;
+    Storage& operator=(const Storage&) = delete;
+    
+    T* data;
+};
+
+// Spans covering `count` elements starting at free-running position `pos`
+template <typename T>
+RingSpans<T> spans_at(T* data, size_t mask, uint64_t pos, size_t count) {
+    const size_t begin = static_cast<size_t>(pos) & mask;
+    const size_t to_end = mask + 1 - begin;
+    
+    RingSpans<T> spans;
+    spans.first = data + begin;
+    spans.first_size = count < to_end ? count : to_end;
+    spans.second = data;
+    spans.second_size = count - spans.first_size;
+    return spans;
+}
+
+// Copy `count` elements from `src` into spans; empty spans (a failed reservation) may be null
+template <typename T>
+void copy_into(const RingSpans<T>& spans, const T* src, size_t count) {
+    const size_t first = count < spans.first_size ? count : spans.first_size;
+    if (first) std::memcpy(spans.first, src, first * sizeof(T));
+    if (count > first) std::memcpy(spans.second, src + first, (count - first) * sizeof(T));
+}
+
+} // namespace ring_detail
+
+/**
+ * @brief Single-producer single-consumer ring buffer
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @brief Allocate a ring
+     * @param min_capacity Minimum number of elements (rounded up to a power of two)
+     */
+    explicit SpscRing(size_t min_capacity)
+        : mask_(ring_detail::round_up_pow2(min_capacity) - 1), storage_(mask_ + 1) {}
+    
+    size_t capacity() const { return mask_ + 1; }
+    
+    // Producer side
+    
+    /**
+     * @brief Free space the producer may fill, at most max_count elements
+     */
+    RingSpans<T> write_spans(size_t max_count = SIZE_MAX) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        size_t free_space = capacity() - static_cast<size_t>(head - cached_tail_);
+        if (free_space < max_count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            free_space = capacity() - static_cast<size_t>(head - cached_tail_);
+        }
+        return ring_detail::spans_at(storage_.data, mask_, head, free_space < max_count ? free_space : max_count);
+    }
+    
+    /**
+     * @brief Publish the first `count` elements of the last write_spans()
+     */
+    void commit_write(size_t count) {
+        head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+    
+    /**
+     * @brief Copy as many elements as fit and publish them
+     * @return Number of elements written
+     */
+    size_t push(const T* data, size_t count) {
+        RingSpans<T> spans = write_spans(count);
+        ring_detail::copy_into(spans, data, spans.size());
+        commit_write(spans.size());
+        return spans.size();
+    }
+    
+    // Consumer side
+    
+    /**
+     * @brief Readable elements; the consumer may also modify them in place until released
+     */
+    RingSpans<T> read_spans(size_t max_count = SIZE_MAX) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        size_t available = static_cast<size_t>(cached_head_ - tail);
+        if (available < max_count) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            available = static_cast<size_t>(cached_head_ - tail);
+        }
+        return ring_detail::spans_at(storage_.data, mask_, tail, available < max_count ? available : max_count);
+    }
+    
+    /**
+     * @brief Return the first `count` elements of the last read_spans() to the producer
+     */
+    void commit_read(size_t count) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+private:
+    const size_t mask_;
+    ring_detail::Storage<T> storage_;
+    
+    alignas(64) std::atomic<uint64_t> head_{0};
+    uint64_t cached_tail_ = 0;  // producer's copy of tail_
+    
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    uint64_t cached_head_ = 0;  // consumer's copy of head_
+};
+
+/**
+ * @brief Space claimed by one producer of an MpscRing
+ */
+template <typename T>
+struct RingReservation {
+    RingSpans<T> spans;
+    uint64_t start = 0;
+    size_t count = 0;
+};
+
+/**
+ * @brief Multi-producer single-consumer ring buffer
+ *
+ * Producers claim space with a CAS on the reserve position and fill it
+ * without any lock. Reservations are all-or-nothing.
+ *
+ * commit() is blocking, not lock-free: reservations are published in
+ * reservation order, and a producer whose predecessor has not committed
+ * yet spins until it does. The consumer therefore always sees a gap-free
+ * prefix, but a producer that is preempted between reserve() and commit()
+ * stalls every producer that reserved after it. Keep the fill between the
+ * two short, and do not use the ring where producers can be descheduled for
+ * long (for example, oversubscribed cores or priority inversion).
+ */
+template <typename T>
+class MpscRing {
+public:
+    /**
+     * @brief Allocate a ring
+     * @param min_capacity Minimum number of elements (rounded up to a power of two)
+     */
+    explicit MpscRing(size_t min_capacity)
+        : mask_(ring_detail::round_up_pow2(min_capacity) - 1), storage_(mask_ + 1) {}
+    
+    size_t capacity() const { return mask_ + 1; }
+    
+    // Producer side (any thread)
+    
+    /**
+     * @brief Claim space for exactly `count` elements
+     * @return Reservation with count == 0 if the ring lacks space
+     */
+    RingReservation<T> reserve(size_t count) {
+        RingReservation<T> reservation;
+        if (count == 0 || count > capacity()) return reservation;
+        
+        uint64_t start = reserve_.load(std::memory_order_relaxed);
+        while (true) {
+            const uint64_t tail = tail_.load(std::memory_order_acquire);
+            if (start < tail) {
+                // Stale start: the consumer has released past it, so it says nothing about free
+                // space. Reloaded after that tail, reserve_ is at least tail.
+                start = reserve_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (start + count - tail > capacity()) return reservation;
+            if (reserve_.compare_exchange_weak(start, start + count, std::memory_order_relaxed)) break;
+        }
+        
+        reservation.spans = ring_detail::spans_at(storage_.data, mask_, start, count);
+        reservation.start = start;
+        reservation.count = count;
+        return reservation;
+    }
+    
+    /**
+     * @brief Publish a filled reservation, first waiting for all earlier reservations to be published
+     */
+    void commit(const RingReservation<T>& reservation) {
+        if (reservation.count == 0) return;
+        while (commit_.load(std::memory_order_acquire) != reservation.start) {
+            cpu_relax();
+        }
+        commit_.store(reservation.start + reservation.count, std::memory_order_release);
+    }
+    
+    /**
+     * @brief Copy a whole block in and publish it
+     * @return count, or 0 if the block did not fit
+     */
+    size_t push(const T* data, size_t count) {
+        RingReservation<T> reservation = reserve(count);
+        ring_detail::copy_into(reservation.spans, data, reservation.count);
+        commit(reservation);
+        return reservation.count;
+    }
+    
+    // Consumer side (one thread)
+    
+    /**
+     * @brief Committed elements; the consumer may also modify them in place until released
+     */
+    RingSpans<T> read_spans(size_t max_count = SIZE_MAX) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t available = static_cast<size_t>(commit_.load(std::memory_order_acquire) - tail);
+        return ring_detail::spans_at(storage_.data, mask_, tail, available < max_count ? available : max_count);
+    }
+    
+    /**
+     * @brief Return the first `count` elements of the last read_spans() to the producers
+     */
+    void commit_read(size_t count) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+private:
+    const size_t mask_;
+    ring_detail::Storage<T> storage_;
+    
+    alignas(64) std::atomic<uint64_t> reserve_{0};
+    alignas(64) std::atomic<uint64_t> commit_{0};
+    alignas(64) std::atomic<uint64_t> tail_{0};
+};
+
+#endif // RING_BUFFER_H
@@ -0,0 +1,289 @@
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "simd.h"
+#include "benchmark.h"
+
+/*
+ * Roofline placement of the benchmarked kernels.
+ *
+ * calibrate_machine() measures the single-core ceilings at every size of
+ * the sweep: STREAM-style read (sum), write (fill) and copy bandwidth, and
+ * the peak FMA rate from independent accumulator chains held in registers.
+ * Bandwidth is measured at the same sizes as the kernels, so an L1-sized
+ * kernel is compared with L1 bandwidth rather than DRAM.
+ *
+ * Each kernel's attainable rate is min(peak FLOP/s, intensity x bandwidth).
+ * Read-only kernels are held to the read bandwidth and kernels that also
+ * write to the copy bandwidth. The report gives the limiting ceiling and
+ * the fraction of it the kernel reaches; integer kernels with no
+ * floating-point work are measured against bandwidth alone.
+ */
+
+// Independent FMA chains in the peak test: covers FMA latency x pipes on current cores
+constexpr size_t ROOFLINE_FMA_CHAINS = 16;
+
+// Inner iterations of one peak-FMA trial
+constexpr size_t ROOFLINE_FMA_ITERATIONS = 1 << 16;
+
+/**
+ * @brief Measured ceilings at one size
+ */
+struct BandwidthCeiling {
+    const char* tier;
+    size_t elements;
+    double read_gb_per_s;
+    double write_gb_per_s;
+    double copy_gb_per_s;  // bytes read + bytes written
+};
+
+struct MachineCeilings {
+    double peak_gflop_per_s;
+    std::vector<BandwidthCeiling> bandwidth;
+};
+
+/**
+ * @brief One kernel placed on the roofline
+ */
+struct RooflineEntry {
+    std::string kernel;
+    const char* tier;
+    size_t elements;
+    double arithmetic_intensity;  // FLOP per byte
+    double achieved_gflop_per_s;
+    double achieved_gb_per_s;
+    double ceiling_gb_per_s;       // applicable bandwidth ceiling
+    double attainable_gflop_per_s;
+    const char* bound;             // "memory" or "compute"
+    double percent_of_ceiling;
+};
+
+/**
+ * @brief Best (fastest) time in ns of `trials` runs of fn
+ */
+template <typename F>
+inline double roofline_best_ns(int trials, F&& fn) {
+    double best = 0.0;
+    for (int t = 0; t < trials; ++t) {
+        const uint64_t start = bench_now_ns();
+        fn();
+        const double elapsed = static_cast<double>(bench_now_ns() - start);
+        if (t == 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+/**
+ * @brief Sustained single-core read, write and copy bandwidth at one size
+ */
+inline BandwidthCeiling measure_bandwidth(const BenchmarkSize& size, int trials) {
+    // Whole 16-float blocks; sizes below one block measure one block rather than dividing by zero
+    const size_t n = size.elements < 16 ? 16 : size.elements & ~size_t{15};
+    const size_t reps = n >= BENCH_TRIAL_ELEMENTS ? 1 : BENCH_TRIAL_ELEMENTS / n;
+    std::vector<float> src(n, 1.0f), dst(n);
+    
+    auto read = [&] {
+        for (size_t r = 0; r < reps; ++r) {
+            float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+            for (size_t i = 0; i < n; i += 16) {
+                acc0 = vaddq_f32(acc0, vld1q_f32(&src[i]));
+                acc1 = vaddq_f32(acc1, vld1q_f32(&src[i + 4]));
+                acc2 = vaddq_f32(acc2, vld1q_f32(&src[i + 8]));
+                acc3 = vaddq_f32(acc3, vld1q_f32(&src[i + 12]));
+            }
+            bench_sink_float = vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+        }
+    };
+    auto write = [&] {
+        for (size_t r = 0; r < reps; ++r) {
+            const float32x4_t v = vdupq_n_f32(static_cast<float>(r));
+            for (size_t i = 0; i < n; i += 16) {
+                vst1q_f32(&dst[i], v);
+                vst1q_f32(&dst[i + 4], v);
+                vst1q_f32(&dst[i + 8], v);
+                vst1q_f32(&dst[i + 12], v);
+            }
+            bench_sink_float = dst[r % n];
+        }
+    };
+    auto copy = [&] {
+        for (size_t r = 0; r < reps; ++r) {
+            for (size_t i = 0; i < n; i += 16) {
+                vst1q_f32(&dst[i], vld1q_f32(&src[i]));
+                vst1q_f32(&dst[i + 4], vld1q_f32(&src[i + 4]));
+                vst1q_f32(&dst[i + 8], vld1q_f32(&src[i + 8]));
+                vst1q_f32(&dst[i + 12], vld1q_f32(&src[i + 12]));
+            }
+            bench_sink_float = dst[r % n];
+        }
+    };
+    
+    read();
+    write();
+    copy();
+    
+    const double bytes = static_cast<double>(reps) * n * sizeof(float);
+    BandwidthCeiling ceiling;
+    ceiling.tier = size.tier;
+    ceiling.elements = size.elements;
+    ceiling.read_gb_per_s = bytes / roofline_best_ns(trials, read);
+    ceiling.write_gb_per_s = bytes / roofline_best_ns(trials, write);
+    ceiling.copy_gb_per_s = 2.0 * bytes / roofline_best_ns(trials, copy);
+    return ceiling;
+}
+
+/**
+ * @brief Peak single-core fp32 FMA throughput in GFLOP/s (an FMA counts as two)
+ */
+inline double measure_peak_gflops(int trials) {
+    auto run = [] {
+        float32x4_t acc[ROOFLINE_FMA_CHAINS];
+        for (size_t k = 0; k < ROOFLINE_FMA_CHAINS; ++k) acc[k] = vdupq_n_f32(static_cast<float>(k));
+        const float32x4_t a = vdupq_n_f32(0.999f);
+        const float32x4_t b = vdupq_n_f32(0.001f);
+        
+        for (size_t i = 0; i < ROOFLINE_FMA_ITERATIONS; ++i) {
+            for (size_t k = 0; k < ROOFLINE_FMA_CHAINS; ++k) {
+                acc[k] = vfmaq_f32(b, acc[k], a);
+            }
+        }
+        
+        float32x4_t total = vdupq_n_f32(0.0f);
+        for (size_t k = 0; k < ROOFLINE_FMA_CHAINS; ++k) total = vaddq_f32(total, acc[k]);
+        bench_sink_float = vaddvq_f32(total);
+    };
+    
+    run();
+    const double flops = 2.0 * 4.0 * ROOFLINE_FMA_CHAINS * ROOFLINE_FMA_ITERATIONS;
+    return flops / roofline_best_ns(trials, run);
+}
+
+/**
+ * @brief Measure peak FMA rate and bandwidth at every size of a sweep
+ */
+inline MachineCeilings calibrate_machine(const BenchmarkConfig& config) {
+    const int trials = std::max(config.trials, 5);
+    
+    MachineCeilings machine;
+    machine.peak_gflop_per_s = measure_peak_gflops(trials);
+    for (const BenchmarkSize& size : config.sizes) {
+        machine.bandwidth.push_back(measure_bandwidth(size, trials));
+    }
+    return machine;
+}
+
+/**
+ * @brief Place benchmark results on the roofline
+ * @param results Output of run_benchmarks() with the same sizes as the calibration
+ * @param kernels Kernel descriptions (for traffic and operation counts)
+ * @param machine Output of calibrate_machine()
+ */
+inline std::vector<RooflineEntry> build_roofline(const std::vector<BenchmarkResult>& results,
+                                                 const std::vector<BenchmarkKernel>& kernels,
+                                                 const MachineCeilings& machine) {
+    std::vector<RooflineEntry> entries;
+    
+    for (const BenchmarkResult& r : results) {
+        const BenchmarkKernel* kernel = nullptr;
+        for (const BenchmarkKernel& k : kernels) {
+            if (k.name == r.kernel) kernel = &k;
+        }
+        const BandwidthCeiling* bw = nullptr;
+        for (const BandwidthCeiling& b : machine.bandwidth) {
+            if (b.elements == r.elements) bw = &b;
+        }
+        if (!kernel || !bw) continue;
+        
+        RooflineEntry e;
+        e.kernel = r.kernel;
+        e.tier = r.tier;
+        e.elements = r.elements;
+        e.arithmetic_intensity = kernel->flops_per_element / kernel->bytes_per_element;
+        e.achieved_gflop_per_s = r.gflop_per_s;
+        e.achieved_gb_per_s = r.gb_per_s;
+        e.ceiling_gb_per_s = kernel->write_bytes_per_element > 0.0 ? bw->copy_gb_per_s : bw->read_gb_per_s;
+        
+        // Elements per ns each ceiling allows; the smaller one binds
+        const double memory_rate = e.ceiling_gb_per_s / kernel->bytes_per_element;
+        const double compute_rate = kernel->flops_per_element > 0.0
+            ? machine.peak_gflop_per_s / kernel->flops_per_element : memory_rate + 1.0;
+        const double attainable_rate = std::min(memory_rate, compute_rate);
+        
+        e.attainable_gflop_per_s = attainable_rate * kernel->flops_per_element;
+        e.bound = memory_rate <= compute_rate ? "memory" : "compute";
+        e.percent_of_ceiling = 100.0 * (1.0 / r.ns_per_element_p50) / attainable_rate;
+        entries.push_back(e);
+    }
+    
+    return entries;
+}
+
+/**
+ * @brief Print the measured ceilings and the roofline placement
+ */
+inline void print_roofline_table(std::ostream& out, const MachineCeilings& machine,
+                                 const std::vector<RooflineEntry>& entries) {
+    out << "Peak FMA: " << std::fixed << std::setprecision(2) << machine.peak_gflop_per_s << " GFLOP/s\n";
+    out << std::left << std::setw(6) << "tier" << std::right << std::setw(10) << "elements"
+        << std::setw(10) << "read" << std::setw(10) << "write" << std::setw(10) << "copy" << "  GB/s\n";
+    for (const BandwidthCeiling& b : machine.bandwidth) {
+        out << std::left << std::setw(6) << b.tier << std::right << std::setw(10) << b.elements
+            << std::setw(10) << b.read_gb_per_s << std::setw(10) << b.write_gb_per_s
+            << std::setw(10) << b.copy_gb_per_s << "\n";
+    }
+    
+    out << "\n" << std::left << std::setw(26) << "kernel" << std::setw(6) << "tier" << std::right
+        << std::setw(9) << "FLOP/B" << std::setw(9) << "GFLOP/s" << std::setw(9) << "GB/s"
+        << std::setw(10) << "ceil GB/s" << std::setw(9) << "bound" << std::setw(9) << "% ceil" << "\n";
+    for (const RooflineEntry& e : entries) {
+        out << std::left << std::setw(26) << e.kernel << std::setw(6) << e.tier << std::right
+            << std::setprecision(3) << std::setw(9) << e.arithmetic_intensity << std::setprecision(2)
+            << std::setw(9) << e.achieved_gflop_per_s << std::setw(9) << e.achieved_gb_per_s
+            << std::setw(10) << e.ceiling_gb_per_s << std::setw(9) << e.bound
+            << std::setprecision(1) << std::setw(9) << e.percent_of_ceiling << "\n";
+    }
+}
+
+/**
+ * @brief Write benchmark results together with the ceilings and roofline placement as JSON
+ */
+inline void write_roofline_json(std::ostream& out, const std::vector<BenchmarkResult>& results,
+                                const BenchmarkConfig& config, const MachineCeilings& machine,
+                                const std::vector<RooflineEntry>& entries) {
+    out << "{\n";
+    write_benchmark_json_fields(out, results, config);
+    out << ",\n" << std::setprecision(6) << std::defaultfloat;
+    out << "  \"peak_gflop_per_s\": " << machine.peak_gflop_per_s << ",\n";
+    out << "  \"bandwidth\": [\n";
+    for (size_t i = 0; i < machine.bandwidth.size(); ++i) {
+        const BandwidthCeiling& b = machine.bandwidth[i];
+        out << "    {\"tier\": \"" << b.tier << "\", \"elements\": " << b.elements
+            << ", \"read_gb_per_s\": " << b.read_gb_per_s << ", \"write_gb_per_s\": " << b.write_gb_per_s
+            << ", \"copy_gb_per_s\": " << b.copy_gb_per_s << "}"
+            << (i + 1 < machine.bandwidth.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n";
+    out << "  \"roofline\": [\n";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const RooflineEntry& e = entries[i];
+        out << "    {\"kernel\": \"" << e.kernel << "\", \"tier\": \"" << e.tier
+            << "\", \"elements\": " << e.elements
+            << ", \"arithmetic_intensity\": " << e.arithmetic_intensity
+            << ", \"ceiling_gb_per_s\": " << e.ceiling_gb_per_s
+            << ", \"attainable_gflop_per_s\": " << e.attainable_gflop_per_s
+            << ", \"bound\": \"" << e.bound << "\""
+            << ", \"percent_of_ceiling\": " << e.percent_of_ceiling << "}"
+            << (i + 1 < entries.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+#endif // ROOFLINE_H
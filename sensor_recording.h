@@ -0,0 +1,365 @@
+#ifndef SENSOR_RECORDING_H
+#define SENSOR_RECORDING_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "obj_detection_util.h"
+#include "recording_reader.h"
+#include "simd_expr.h"
+
+/*
+ * Chunk-indexed columnar sensor recordings.
+ *
+ * File layout (little-endian, every section 64-byte aligned):
+ *
+ *     SensorFileHeader                              64 bytes
+ *     chunk 0:  int64 timestamps[n]                 padded to 64 bytes
+ *               float channel 0[n] ... channel C-1  each padded to 64 bytes
+ *     chunk 1:  ...
+ *     footer:   SensorChunkEntry[num_chunks]
+ *               SensorChunkStats[num_chunks][num_channels]
+ *     SensorFileTrailer                             32 bytes, at the end of the file
+ *
+ * Every chunk holds chunk_samples rows except possibly the last. The writer
+ * computes min, max and sum of each chunk column with the expression
+ * reductions while the chunk is still in cache. A reader can then answer
+ * range queries such as find_above() from the footer alone for chunks that
+ * lie entirely on one side of the threshold, and only runs a kernel over
+ * the straddling ones. Chunk columns are read zero-copy from the mapping.
+ */
+
+constexpr char SENSOR_FILE_MAGIC[8] = {'A', 'R', 'M', 'S', 'C', 'H', 'K', '1'};
+constexpr uint32_t SENSOR_FILE_VERSION = 1;
+
+struct SensorFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_channels;
+    uint64_t chunk_samples;
+    uint8_t reserved[40];
+};
+
+struct SensorChunkEntry {
+    uint64_t offset;        // file offset of the chunk's timestamp column
+    uint64_t first_sample;  // row index of the chunk's first sample
+    uint64_t count;         // rows in the chunk
+    int64_t first_timestamp;
+    int64_t last_timestamp;
+    uint8_t reserved[24];
+};
+
+struct SensorChunkStats {
+    float min;
+    float max;
+    float sum;
+    uint32_t count;
+};
+
+struct SensorFileTrailer {
+    uint64_t footer_offset;
+    uint64_t num_chunks;
+    uint64_t num_samples;
+    char magic[8];
+};
+
+static_assert(sizeof(SensorFileHeader) == 64, "header must fill one cache line");
+static_assert(sizeof(SensorChunkEntry) == 64, "chunk entries must fill one cache line");
+static_assert(sizeof(SensorChunkStats) == 16, "unexpected stats padding");
+static_assert(sizeof(SensorFileTrailer) == 32, "unexpected trailer padding");
+
+/**
+ * @brief Bytes occupied by a column of `count` elements of `size` bytes, padded to 64
+ */
+inline uint64_t sensor_column_bytes(uint64_t count, size_t size) {
+    return (count * size + 63) & ~uint64_t{63};
+}
+
+/**
+ * @brief Streaming writer of chunk-indexed sensor recordings
+ */
+class SensorRecordingWriter {
+public:
+    /**
+     * @brief Create a recording
+     * @param path Output file
+     * @param num_channels Number of float channels per row
+     * @param chunk_samples Rows per chunk
+     * @throws std::runtime_error if the file cannot be created
+     */
+    SensorRecordingWriter(const std::string& path, size_t num_channels, size_t chunk_samples = 65536)
+        : path_(path), num_channels_(num_channels), chunk_samples_(chunk_samples ? chunk_samples : 1),
+          timestamps_(chunk_samples_), columns_(num_channels, std::vector<float>(chunk_samples_)) {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) throw std::runtime_error("cannot create recording " + path + ": " + std::strerror(errno));
+        
+        SensorFileHeader header = {};
+        std::memcpy(header.magic, SENSOR_FILE_MAGIC, sizeof(header.magic));
+        header.version = SENSOR_FILE_VERSION;
+        header.num_channels = static_cast<uint32_t>(num_channels);
+        header.chunk_samples = chunk_samples_;
+        write(&header, sizeof(header));
+    }
+    
+    ~SensorRecordingWriter() {
+        try {
+            finish();
+        } catch (...) {
+            // Destructors must not throw; call finish() explicitly to see write errors
+        }
+    }
+    
+    SensorRecordingWriter(const SensorRecordingWriter&) = delete;
+    SensorRecordingWriter& operator=(const SensorRecordingWriter&) = delete;
+    
+    /**
+     * @brief Append rows
+     * @param timestamps Timestamp of each row
+     * @param channels Array of num_channels column pointers, each with `count` samples
+     * @param count Number of rows
+     */
+    void append(const int64_t* timestamps, const float* const* channels, size_t count) {
+        size_t done = 0;
+        while (done < count) {
+            const size_t space = chunk_samples_ - buffered_;
+            const size_t n = count - done < space ? count - done : space;
+            
+            std::memcpy(&timestamps_[buffered_], timestamps + done, n * sizeof(int64_t));
+            for (size_t c = 0; c < num_channels_; ++c) {
+                std::memcpy(&columns_[c][buffered_], channels[c] + done, n * sizeof(float));
+            }
+            
+            buffered_ += n;
+            done += n;
+            if (buffered_ == chunk_samples_) flush_chunk();
+        }
+    }
+    
+    /**
+     * @brief Write the last partial chunk and the footer, and close the file
+     * @throws std::runtime_error on write errors
+     */
+    void finish() {
+        if (!file_) return;
+        flush_chunk();
+        
+        SensorFileTrailer trailer = {};
+        trailer.footer_offset = offset_;
+        trailer.num_chunks = index_.size();
+        trailer.num_samples = num_samples_;
+        std::memcpy(trailer.magic, SENSOR_FILE_MAGIC, sizeof(trailer.magic));
+        
+        write(index_.data(), index_.size() * sizeof(SensorChunkEntry));
+        write(stats_.data(), stats_.size() * sizeof(SensorChunkStats));
+        write(&trailer, sizeof(trailer));
+        
+        const bool ok = std::fclose(file_) == 0;
+        file_ = nullptr;
+        if (!ok) throw std::runtime_error("cannot write recording " + path_);
+    }
+
+private:
+    void write(const void* data, size_t bytes) {
+        if (!file_) throw std::runtime_error("recording already closed: " + path_);
+        if (bytes && std::fwrite(data, 1, bytes, file_) != bytes) {
+            std::fclose(file_);
+            file_ = nullptr;
+            throw std::runtime_error("cannot write recording " + path_);
+        }
+        offset_ += bytes;
+    }
+    
+    void write_padded(const void* data, size_t bytes) {
+        static const uint8_t zeros[64] = {};
+        write(data, bytes);
+        write(zeros, sensor_column_bytes(bytes, 1) - bytes);
+    }
+    
+    void flush_chunk() {
+        if (buffered_ == 0) return;
+        
+        SensorChunkEntry entry = {};
+        entry.offset = offset_;
+        entry.first_sample = num_samples_;
+        entry.count = buffered_;
+        entry.first_timestamp = timestamps_[0];
+        entry.last_timestamp = timestamps_[buffered_ - 1];
+        index_.push_back(entry);
+        
+        write_padded(timestamps_.data(), buffered_ * sizeof(int64_t));
+        for (size_t c = 0; c < num_channels_; ++c) {
+            // Summarize while the column is still hot in cache
+            expr::Span column(columns_[c].data(), buffered_);
+            SensorChunkStats stats;
+            stats.min = expr::min_value(column);
+            stats.max = expr::max_value(column);
+            stats.sum = expr::sum(column);
+            stats.count = static_cast<uint32_t>(buffered_);
+            stats_.push_back(stats);
+            
+            write_padded(columns_[c].data(), buffered_ * sizeof(float));
+        }
+        
+        num_samples_ += buffered_;
+        buffered_ = 0;
+    }
+    
+    std::string path_;
+    FILE* file_ = nullptr;
+    const size_t num_channels_;
+    const size_t chunk_samples_;
+    std::vector<int64_t> timestamps_;
+    std::vector<std::vector<float>> columns_;
+    size_t buffered_ = 0;
+    uint64_t offset_ = 0;
+    uint64_t num_samples_ = 0;
+    std::vector<SensorChunkEntry> index_;
+    std::vector<SensorChunkStats> stats_;
+};
+
+/**
+ * @brief Rows returned by a threshold query, with how much of the file was touched
+ */
+struct ThresholdQueryResult {
+    std::vector<uint64_t> samples;  // row indices, ascending
+    size_t chunks_scanned = 0;      // chunks whose column was read
+    size_t chunks_skipped = 0;      // chunks answered from the footer alone
+};
+
+/**
+ * @brief Memory-mapped reader of chunk-indexed sensor recordings
+ */
+class SensorRecordingReader {
+public:
+    /**
+     * @brief Open a recording and load its footer index
+     * @param path Recording written by SensorRecordingWriter
+     * @param options Mapping options
+     * @throws std::runtime_error if the file cannot be opened or is not a valid recording
+     */
+    explicit SensorRecordingReader(const std::string& path, MapOptions options = MapOptions())
+        : file_(path, options) {
+        const size_t size = file_.size();
+        bool valid = size >= sizeof(SensorFileHeader) + sizeof(SensorFileTrailer);
+        
+        SensorFileTrailer trailer = {};
+        if (valid) {
+            std::memcpy(&header_, file_.data(), sizeof(header_));
+            std::memcpy(&trailer, file_.data() + size - sizeof(trailer), sizeof(trailer));
+            // The footer must hold exactly num_chunks entries; dividing the bytes it spans,
+            // rather than multiplying the file's counts, cannot wrap
+            const uint64_t chunk_footer_bytes = sizeof(SensorChunkEntry) +
+                                                uint64_t{header_.num_channels} * sizeof(SensorChunkStats);
+            const uint64_t footer_end = size - sizeof(trailer);
+            valid = std::memcmp(header_.magic, SENSOR_FILE_MAGIC, sizeof(header_.magic)) == 0 &&
+                    std::memcmp(trailer.magic, SENSOR_FILE_MAGIC, sizeof(trailer.magic)) == 0 &&
+                    header_.version == SENSOR_FILE_VERSION &&
+                    trailer.footer_offset <= footer_end &&
+                    (footer_end - trailer.footer_offset) % chunk_footer_bytes == 0 &&
+                    (footer_end - trailer.footer_offset) / chunk_footer_bytes == trailer.num_chunks;
+        }
+        if (!valid) throw std::runtime_error("not a valid sensor recording: " + path);
+        
+        num_samples_ = trailer.num_samples;
+        index_.resize(trailer.num_chunks);
+        stats_.resize(trailer.num_chunks * header_.num_channels);
+        const uint8_t* footer = file_.data() + trailer.footer_offset;
+        std::memcpy(index_.data(), footer, index_.size() * sizeof(SensorChunkEntry));
+        std::memcpy(stats_.data(), footer + index_.size() * sizeof(SensorChunkEntry),
+                    stats_.size() * sizeof(SensorChunkStats));
+        
+        for (const SensorChunkEntry& entry : index_) {
+            // A chunk has fewer rows than the file has bytes, which keeps the padded column sizes
+            // from wrapping; the rest is checked
+            uint64_t sample_bytes = 0, bytes = 0, end = 0;
+            const bool fits = entry.count <= size &&
+                              !__builtin_mul_overflow(uint64_t{header_.num_channels},
+                                                      sensor_column_bytes(entry.count, sizeof(float)), &sample_bytes) &&
+                              !__builtin_add_overflow(sample_bytes, sensor_column_bytes(entry.count, sizeof(int64_t)),
+                                                      &bytes) &&
+                              !__builtin_add_overflow(entry.offset, bytes, &end);
+            if (!fits || entry.offset % 64 != 0 || end > trailer.footer_offset) {
+                throw std::runtime_error("corrupt chunk index: " + path);
+            }
+        }
+    }
+    
+    size_t num_channels() const { return header_.num_channels; }
+    size_t num_chunks() const { return index_.size(); }
+    size_t num_samples() const { return num_samples_; }
+    size_t chunk_samples() const { return header_.chunk_samples; }
+    
+    const SensorChunkEntry& chunk(size_t k) const { return index_[k]; }
+    
+    /**
+     * @brief Footer statistics of one chunk column
+     */
+    const SensorChunkStats& stats(size_t k, size_t c) const { return stats_[k * header_.num_channels + c]; }
+    
+    /**
+     * @brief Zero-copy timestamps of a chunk (64-byte aligned)
+     */
+    const int64_t* timestamps(size_t k) const {
+        return reinterpret_cast<const int64_t*>(file_.data() + index_[k].offset);
+    }
+    
+    /**
+     * @brief Zero-copy samples of one chunk column (64-byte aligned, padded to whole lines)
+     */
+    const float* channel(size_t k, size_t c) const {
+        const SensorChunkEntry& entry = index_[k];
+        const uint64_t offset = entry.offset + sensor_column_bytes(entry.count, sizeof(int64_t)) +
+                                c * sensor_column_bytes(entry.count, sizeof(float));
+        return reinterpret_cast<const float*>(file_.data() + offset);
+    }
+    
+    /**
+     * @brief Find every row where a channel exceeds a threshold
+     * @param c Channel
+     * @param threshold Detection threshold (strictly greater, as threshold_detection)
+     * @return Matching rows; chunks with max <= threshold are skipped without reading their data
+     */
+    ThresholdQueryResult find_above(size_t c, float threshold) const {
+        ThresholdQueryResult result;
+        std::vector<uint8_t> detections;
+        
+        for (size_t k = 0; k < index_.size(); ++k) {
+            const SensorChunkEntry& entry = index_[k];
+            const SensorChunkStats& s = stats(k, c);
+            
+            if (!(s.max > threshold)) {
+                result.chunks_skipped++;
+                continue;
+            }
+            if (s.min > threshold) {
+                result.chunks_skipped++;
+                for (uint64_t i = 0; i < entry.count; ++i) result.samples.push_back(entry.first_sample + i);
+                continue;
+            }
+            
+            result.chunks_scanned++;
+            detections.resize(entry.count);
+            threshold_detection(channel(k, c), detections.data(), entry.count, threshold);
+            for (uint64_t i = 0; i < entry.count; ++i) {
+                if (detections[i]) result.samples.push_back(entry.first_sample + i);
+            }
+        }
+        
+        return result;
+    }
+
+private:
+    MappedFile file_;
+    SensorFileHeader header_ = {};
+    uint64_t num_samples_ = 0;
+    std::vector<SensorChunkEntry> index_;
+    std::vector<SensorChunkStats> stats_;
+};
+
+#endif // SENSOR_RECORDING_H
@@ -0,0 +1,36 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+/*
+ * SIMD backend selection. The kernels are written with NEON intrinsics:
+ *
+ *  - NEON on AArch64: <arm_neon.h> itself, so ARM builds compile exactly
+ *    as before. 32-bit ARM is rejected: the kernels use AArch64-only
+ *    intrinsics (across-lane reductions such as vaddvq_f32 and vminvq_u32,
+ *    vdupq_laneq_f32, vcvt_high_f32_f16).
+ *  - x86 with SSE4.1 (-march=x86-64-v2 and up): simd_portable.h, with FMA
+ *    and F16C instructions used where the build enables them. AVX2 builds
+ *    (-march=x86-64-v3) also run the hot loops 8 lanes wide; see
+ *    simd_wide.h.
+ *  - Anything else: simd_portable.h on generic vectors, which the compiler
+ *    lowers to the SIMD it has or to scalar code.
+ *
+ * SIMD_BACKEND names the backend in use, for logs and benchmark reports.
+ */
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#if !defined(__aarch64__)
+#error "The NEON kernels need AArch64; 32-bit ARM lacks intrinsics they use"
+#endif
+#include <arm_neon.h>
+#define SIMD_BACKEND "neon"
+#else
+#include "simd_portable.h"
+#if defined(__SSE4_1__)
+#define SIMD_BACKEND "sse4.1"
+#else
+#define SIMD_BACKEND "generic"
+#endif
+#endif
+
+#endif // SIMD_H
@@ -0,0 +1,617 @@
+#ifndef SIMD_EXPR_H
+#define SIMD_EXPR_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "simd.h"
+#include "simd_tail.h"
+
+/*
+ * Lazy expression templates over the NEON primitives.
+ *
+ * Arithmetic on Span/Vec operands builds an expression tree instead of
+ * computing anything; eval(), Vec assignment and the reductions walk the
+ * tree once per 4 lanes, so an expression such as
+ *
+ *     expr::Span prev(p, n), curr(c, n);
+ *     expr::eval(out, expr::clamp((curr - prev) * inv_dt, 0.0f, max_speed));
+ *     size_t fast = expr::count((curr - prev) * inv_dt > limit);
+ *
+ * compiles to a single fused loop per statement, the same shape as the
+ * hand-written kernels in obj_detection_util.h. Remainders use the same
+ * overlapping last vector as those kernels (see simd_tail.h); only
+ * expressions shorter than one vector fall back to at().
+ *
+ * Value nodes provide   float32x4_t load(size_t i)  (lanes i .. i+3)
+ *                       float at(size_t i)          (fewer than 4 elements)
+ *                       size_t size()               (SIZE_MAX for scalars)
+ *                       bool has_vector             (any Span/Vec operand)
+ * and mask nodes the same with uint32x4_t / bool.
+ *
+ * Every expression that is evaluated or reduced needs at least one Span or
+ * Vec operand, which is checked at compile time, and all its array
+ * operands must have the same size; size() throws std::invalid_argument
+ * otherwise.
+ */
+
+namespace expr {
+
+template <typename E>
+struct Expr {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+template <typename E>
+struct MaskExpr {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+// Operands are stored by value; Vec stores as a non-owning Span
+template <typename E>
+using stored_t = typename E::stored_type;
+
+/**
+ * @brief Size of an expression over operands of sizes a and b (SIZE_MAX for scalars)
+ */
+inline size_t common_size(size_t a, size_t b) {
+    if (a != b && a != SIZE_MAX && b != SIZE_MAX) {
+        throw std::invalid_argument("expression operands differ in size");
+    }
+    return a < b ? a : b;
+}
+
+// Rejects expressions made only of scalars, whose size would be SIZE_MAX
+#define SIMD_EXPR_REQUIRE_VECTOR(E) \
+    static_assert(stored_t<E>::has_vector, "expression needs at least one Span or Vec operand")
+
+/**
+ * @brief Broadcast scalar operand
+ */
+struct Scalar : Expr<Scalar> {
+    using stored_type = Scalar;
+    float value;
+    
+    static constexpr bool has_vector = false;
+    
+    explicit Scalar(float v) : value(v) {}
+    float32x4_t load(size_t) const { return vdupq_n_f32(value); }
+    float at(size_t) const { return value; }
+    size_t size() const { return SIZE_MAX; }
+};
+
+/**
+ * @brief Non-owning view of a float array
+ */
+struct Span : Expr<Span> {
+    using stored_type = Span;
+    const float* data;
+    size_t count;
+    
+    static constexpr bool has_vector = true;
+    
+    Span(const float* d, size_t n) : data(d), count(n) {}
+    float32x4_t load(size_t i) const { return vld1q_f32(&data[i]); }
+    float at(size_t i) const { return data[i]; }
+    size_t size() const { return count; }
+};
+
+template <typename Op, typename A, typename B>
+struct Binary : Expr<Binary<Op, A, B>> {
+    using stored_type = Binary;
+    stored_t<A> a;
+    stored_t<B> b;
+    
+    static constexpr bool has_vector = stored_t<A>::has_vector || stored_t<B>::has_vector;
+    
+    Binary(const A& lhs, const B& rhs) : a(lhs), b(rhs) {}
+    float32x4_t load(size_t i) const { return Op::apply(a.load(i), b.load(i)); }
+    float at(size_t i) const { return Op::apply(a.at(i), b.at(i)); }
+    size_t size() const { return common_size(a.size(), b.size()); }
+};
+
+template <typename Op, typename A>
+struct Unary : Expr<Unary<Op, A>> {
+    using stored_type = Unary;
+    stored_t<A> a;
+    
+    static constexpr bool has_vector = stored_t<A>::has_vector;
+    
+    explicit Unary(const A& arg) : a(arg) {}
+    float32x4_t load(size_t i) const { return Op::apply(a.load(i)); }
+    float at(size_t i) const { return Op::apply(a.at(i)); }
+    size_t size() const { return a.size(); }
+};
+
+template <typename Op, typename A, typename B>
+struct Compare : MaskExpr<Compare<Op, A, B>> {
+    using stored_type = Compare;
+    stored_t<A> a;
+    stored_t<B> b;
+    
+    static constexpr bool has_vector = stored_t<A>::has_vector || stored_t<B>::has_vector;
+    
+    Compare(const A& lhs, const B& rhs) : a(lhs), b(rhs) {}
+    uint32x4_t load(size_t i) const { return Op::apply(a.load(i), b.load(i)); }
+    bool at(size_t i) const { return Op::apply(a.at(i), b.at(i)); }
+    size_t size() const { return common_size(a.size(), b.size()); }
+};
+
+template <typename Op, typename A, typename B>
+struct MaskBinary : MaskExpr<MaskBinary<Op, A, B>> {
+    using stored_type = MaskBinary;
+    stored_t<A> a;
+    stored_t<B> b;
+    
+    static constexpr bool has_vector = stored_t<A>::has_vector || stored_t<B>::has_vector;
+    
+    MaskBinary(const A& lhs, const B& rhs) : a(lhs), b(rhs) {}
+    uint32x4_t load(size_t i) const { return Op::apply(a.load(i), b.load(i)); }
+    bool at(size_t i) const { return Op::apply(a.at(i), b.at(i)); }
+    size_t size() const { return common_size(a.size(), b.size()); }
+};
+
+template <typename A>
+struct MaskNot : MaskExpr<MaskNot<A>> {
+    using stored_type = MaskNot;
+    stored_t<A> a;
+    
+    static constexpr bool has_vector = stored_t<A>::has_vector;
+    
+    explicit MaskNot(const A& arg) : a(arg) {}
+    uint32x4_t load(size_t i) const { return vmvnq_u32(a.load(i)); }
+    bool at(size_t i) const { return !a.at(i); }
+    size_t size() const { return a.size(); }
+};
+
+template <typename M, typename A, typename B>
+struct Select : Expr<Select<M, A, B>> {
+    using stored_type = Select;
+    stored_t<M> mask;
+    stored_t<A> a;
+    stored_t<B> b;
+    
+    static constexpr bool has_vector = stored_t<M>::has_vector || stored_t<A>::has_vector || stored_t<B>::has_vector;
+    
+    Select(const M& m, const A& lhs, const B& rhs) : mask(m), a(lhs), b(rhs) {}
+    float32x4_t load(size_t i) const { return vbslq_f32(mask.load(i), a.load(i), b.load(i)); }
+    float at(size_t i) const { return mask.at(i) ? a.at(i) : b.at(i); }
+    size_t size() const { return common_size(mask.size(), common_size(a.size(), b.size())); }
+};
+
+// Lane operations, each with a vector and a matching scalar form
+struct AddOp {
+    static float32x4_t apply(float32x4_t a, float32x4_t b) { return vaddq_f32(a, b); }
+    static float apply(float a, float b) { return a + b; }
+};
+struct SubOp {
+    static float32x4_t apply(float32x4_t a, float32x4_t b) { return vsubq_f32(a, b); }
+    static float apply(float a, float b) { return a - b; }
+};
+struct MulOp {
+    static float32x4_t apply(float32x4_t a, float32x4_t b) { return vmulq_f32(a, b); }
+    static float apply(float a, float b) { return a * b; }
+};
+struct DivOp {
+    static float32x4_t apply(float32x4_t a, float32x4_t b) { return vdivq_f32(a, b); }
+    static float apply(float a, float b) { return a / b; }
+};
+struct MinOp {
+    static float32x4_t apply(float32x4_t a, float32x4_t b) { return vminq_f32(a, b); }
+    static float apply(float a, float b) { return b < a ? b : a; }
+};
+struct MaxOp {
+    static float32x4_t apply(float32x4_t a, float32x4_t b) { return vmaxq_f32(a, b); }
+    static float apply(float a, float b) { return b > a ? b : a; }
+};
+struct NegOp {
+    static float32x4_t apply(float32x4_t a) { return vnegq_f32(a); }
+    static float apply(float a) { return -a; }
+};
+struct AbsOp {
+    static float32x4_t apply(float32x4_t a) { return vabsq_f32(a); }
+    static float apply(float a) { return a < 0.0f ? -a : a; }
+};
+struct SqrtOp {
+    static float32x4_t apply(float32x4_t a) { return vsqrtq_f32(a); }
+    static float apply(float a) { return std::sqrt(a); }
+};
+struct GtOp {
+    static uint32x4_t apply(float32x4_t a, float32x4_t b) { return vcgtq_f32(a, b); }
+    static bool apply(float a, float b) { return a > b; }
+};
+struct GeOp {
+    static uint32x4_t apply(float32x4_t a, float32x4_t b) { return vcgeq_f32(a, b); }
+    static bool apply(float a, float b) { return a >= b; }
+};
+struct LtOp {
+    static uint32x4_t apply(float32x4_t a, float32x4_t b) { return vcltq_f32(a, b); }
+    static bool apply(float a, float b) { return a < b; }
+};
+struct LeOp {
+    static uint32x4_t apply(float32x4_t a, float32x4_t b) { return vcleq_f32(a, b); }
+    static bool apply(float a, float b) { return a <= b; }
+};
+struct AndOp {
+    static uint32x4_t apply(uint32x4_t a, uint32x4_t b) { return vandq_u32(a, b); }
+    static bool apply(bool a, bool b) { return a && b; }
+};
+struct OrOp {
+    static uint32x4_t apply(uint32x4_t a, uint32x4_t b) { return vorrq_u32(a, b); }
+    static bool apply(bool a, bool b) { return a || b; }
+};
+
+// Value operators: expression (op) expression, and with a float on either side
+#define SIMD_EXPR_BINARY_OPERATOR(fn, Op, Node, Base)                                   \
+    template <typename A, typename B>                                                   \
+    inline Node<Op, A, B> fn(const Base<A>& a, const Base<B>& b) {                      \
+        return Node<Op, A, B>(a.self(), b.self());                                      \
+    }                                                                                   \
+    template <typename A>                                                               \
+    inline Node<Op, A, Scalar> fn(const Base<A>& a, float b) {                          \
+        return Node<Op, A, Scalar>(a.self(), Scalar(b));                                \
+    }                                                                                   \
+    template <typename B>                                                               \
+    inline Node<Op, Scalar, B> fn(float a, const Base<B>& b) {                          \
+        return Node<Op, Scalar, B>(Scalar(a), b.self());                                \
+    }
+
+SIMD_EXPR_BINARY_OPERATOR(operator+, AddOp, Binary, Expr)
+SIMD_EXPR_BINARY_OPERATOR(operator-, SubOp, Binary, Expr)
+SIMD_EXPR_BINARY_OPERATOR(operator*, MulOp, Binary, Expr)
+SIMD_EXPR_BINARY_OPERATOR(operator/, DivOp, Binary, Expr)
+SIMD_EXPR_BINARY_OPERATOR(min, MinOp, Binary, Expr)
+SIMD_EXPR_BINARY_OPERATOR(max, MaxOp, Binary, Expr)
+SIMD_EXPR_BINARY_OPERATOR(operator>, GtOp, Compare, Expr)
+SIMD_EXPR_BINARY_OPERATOR(operator>=, GeOp, Compare, Expr)
+SIMD_EXPR_BINARY_OPERATOR(operator<, LtOp, Compare, Expr)
+SIMD_EXPR_BINARY_OPERATOR(operator<=, LeOp, Compare, Expr)
+
+#undef SIMD_EXPR_BINARY_OPERATOR
+
+template <typename A>
+inline Unary<NegOp, A> operator-(const Expr<A>& a) { return Unary<NegOp, A>(a.self()); }
+
+template <typename A>
+inline Unary<AbsOp, A> abs(const Expr<A>& a) { return Unary<AbsOp, A>(a.self()); }
+
+template <typename A>
+inline Unary<SqrtOp, A> sqrt(const Expr<A>& a) { return Unary<SqrtOp, A>(a.self()); }
+
+template <typename A>
+inline Binary<MinOp, Binary<MaxOp, A, Scalar>, Scalar> clamp(const Expr<A>& a, float lo, float hi) {
+    return min(max(a, lo), hi);
+}
+
+template <typename A, typename B>
+inline MaskBinary<AndOp, A, B> operator&(const MaskExpr<A>& a, const MaskExpr<B>& b) {
+    return MaskBinary<AndOp, A, B>(a.self(), b.self());
+}
+
+template <typename A, typename B>
+inline MaskBinary<OrOp, A, B> operator|(const MaskExpr<A>& a, const MaskExpr<B>& b) {
+    return MaskBinary<OrOp, A, B>(a.self(), b.self());
+}
+
+template <typename A>
+inline MaskNot<A> operator~(const MaskExpr<A>& a) { return MaskNot<A>(a.self()); }
+
+/**
+ * @brief Per-lane choice between two values
+ * @param mask Condition expression
+ * @param a Value where mask is true
+ * @param b Value where mask is false
+ */
+template <typename M, typename A, typename B>
+inline Select<M, A, B> select(const MaskExpr<M>& mask, const Expr<A>& a, const Expr<B>& b) {
+    return Select<M, A, B>(mask.self(), a.self(), b.self());
+}
+
+template <typename M, typename A>
+inline Select<M, A, Scalar> select(const MaskExpr<M>& mask, const Expr<A>& a, float b) {
+    return Select<M, A, Scalar>(mask.self(), a.self(), Scalar(b));
+}
+
+/**
+ * @brief Evaluate a value expression into an output array
+ * @param output Output array with at least e.size() elements (may alias an operand)
+ * @param e Expression to evaluate
+ */
+template <typename E>
+inline void eval(float* output, const Expr<E>& e) {
+    SIMD_EXPR_REQUIRE_VECTOR(E);
+    const E& x = e.self();
+    const size_t count = x.size();
+    
+    if (count < 4) {
+        for (size_t i = 0; i < count; ++i) output[i] = x.at(i);
+        return;
+    }
+    
+    // Last four lanes, evaluated before any store in case output aliases an operand
+    const float32x4_t tail = x.load(count - 4);
+    const size_t simd_count = count & ~3;
+    
+    for (size_t i = 0; i < simd_count; i += 4) {
+        vst1q_f32(&output[i], x.load(i));
+    }
+    
+    vst1q_f32(&output[count - 4], tail);
+}
+
+/**
+ * @brief Evaluate a mask expression into a 0/1 byte array
+ * @param output Output array with at least e.size() elements
+ * @param e Mask expression to evaluate
+ */
+template <typename E>
+inline void eval(uint8_t* output, const MaskExpr<E>& e) {
+    SIMD_EXPR_REQUIRE_VECTOR(E);
+    const E& x = e.self();
+    const size_t count = x.size();
+    const uint8x16_t one = vdupq_n_u8(1);
+    
+    if (count < 4) {
+        for (size_t i = 0; i < count; ++i) output[i] = x.at(i) ? 1 : 0;
+        return;
+    }
+    
+    if (count < 16) {
+        // Groups of four lanes, the last one overlapping
+        simd_tail::Partial<uint8_t> bytes;
+        for (size_t i = 0; i < count; i += 4) {
+            const size_t start = i + 4 <= count ? i : count - 4;
+            const uint8x8_t narrow = vmovn_u16(vcombine_u16(vmovn_u32(x.load(start)), vdup_n_u16(0)));
+            const uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(narrow), 0);
+            std::memcpy(&bytes.lanes[start], &packed, sizeof(packed));
+        }
+        vst1q_u8(bytes.lanes, vandq_u8(vld1q_u8(bytes.lanes), one));
+        bytes.store(output, count);
+        return;
+    }
+    
+    auto pack = [&x, one](size_t i) {
+        uint16x8_t lo = vcombine_u16(vmovn_u32(x.load(i)), vmovn_u32(x.load(i + 4)));
+        uint16x8_t hi = vcombine_u16(vmovn_u32(x.load(i + 8)), vmovn_u32(x.load(i + 12)));
+        return vandq_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)), one);
+    };
+    
+    const uint8x16_t tail = pack(count - 16);
+    const size_t simd_count = count & ~15;
+    
+    for (size_t i = 0; i < simd_count; i += 16) {
+        vst1q_u8(&output[i], pack(i));
+    }
+    
+    vst1q_u8(&output[count - 16], tail);
+}
+
+/**
+ * @brief Sum of all elements of an expression
+ */
+template <typename E>
+inline float sum(const Expr<E>& e) {
+    SIMD_EXPR_REQUIRE_VECTOR(E);
+    const E& x = e.self();
+    const size_t count = x.size();
+    const size_t simd_count = count & ~3;
+    
+    if (count < 4) {
+        float result = 0.0f;
+        for (size_t i = 0; i < count; ++i) result += x.at(i);
+        return result;
+    }
+    
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (size_t i = 0; i < simd_count; i += 4) {
+        acc = vaddq_f32(acc, x.load(i));
+    }
+    
+    // Overlapping last vector with the lanes already summed masked off
+    if (simd_count < count) {
+        const uint32x4_t keep = simd_tail::tail_mask_u32(simd_count + 4 - count);
+        acc = vaddq_f32(acc, vreinterpretq_f32_u32(vandq_u32(keep, vreinterpretq_u32_f32(x.load(count - 4)))));
+    }
+    
+    return vaddvq_f32(acc);
+}
+
+/**
+ * @brief Dot product of two expressions (fused multiply-add accumulation)
+ */
+template <typename A, typename B>
+inline float dot(const Expr<A>& a, const Expr<B>& b) {
+    static_assert(stored_t<A>::has_vector || stored_t<B>::has_vector, "expression needs at least one Span or Vec operand");
+    const A& x = a.self();
+    const B& y = b.self();
+    const size_t count = common_size(x.size(), y.size());
+    const size_t simd_count = count & ~3;
+    
+    if (count < 4) {
+        float result = 0.0f;
+        for (size_t i = 0; i < count; ++i) result += x.at(i) * y.at(i);
+        return result;
+    }
+    
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (size_t i = 0; i < simd_count; i += 4) {
+        acc = vfmaq_f32(acc, x.load(i), y.load(i));
+    }
+    
+    // Overlapping last vector; zeroing the lanes already counted in the product drops them
+    if (simd_count < count) {
+        const uint32x4_t keep = simd_tail::tail_mask_u32(simd_count + 4 - count);
+        const float32x4_t product = vmulq_f32(x.load(count - 4), y.load(count - 4));
+        acc = vaddq_f32(acc, vreinterpretq_f32_u32(vandq_u32(keep, vreinterpretq_u32_f32(product))));
+    }
+    
+    return vaddvq_f32(acc);
+}
+
+/**
+ * @brief Minimum element of a non-empty expression
+ */
+template <typename E>
+inline float min_value(const Expr<E>& e) {
+    SIMD_EXPR_REQUIRE_VECTOR(E);
+    const E& x = e.self();
+    const size_t count = x.size();
+    const size_t simd_count = count & ~3;
+    
+    if (count < 4) {
+        float result = x.at(0);
+        for (size_t i = 1; i < count; ++i) {
+            float v = x.at(i);
+            if (v < result) result = v;
+        }
+        return result;
+    }
+    
+    float32x4_t acc = x.load(0);
+    for (size_t i = 4; i < simd_count; i += 4) {
+        acc = vminq_f32(acc, x.load(i));
+    }
+    
+    // Overlapping last vector; elements seen twice do not change the minimum
+    acc = vminq_f32(acc, x.load(count - 4));
+    
+    return vminvq_f32(acc);
+}
+
+/**
+ * @brief Maximum element of a non-empty expression
+ */
+template <typename E>
+inline float max_value(const Expr<E>& e) {
+    SIMD_EXPR_REQUIRE_VECTOR(E);
+    const E& x = e.self();
+    const size_t count = x.size();
+    const size_t simd_count = count & ~3;
+    
+    if (count < 4) {
+        float result = x.at(0);
+        for (size_t i = 1; i < count; ++i) {
+            float v = x.at(i);
+            if (v > result) result = v;
+        }
+        return result;
+    }
+    
+    float32x4_t acc = x.load(0);
+    for (size_t i = 4; i < simd_count; i += 4) {
+        acc = vmaxq_f32(acc, x.load(i));
+    }
+    
+    // Overlapping last vector; elements seen twice do not change the maximum
+    acc = vmaxq_f32(acc, x.load(count - 4));
+    
+    return vmaxvq_f32(acc);
+}
+
+/**
+ * @brief Number of lanes where a mask expression is true
+ */
+template <typename E>
+inline size_t count(const MaskExpr<E>& e) {
+    SIMD_EXPR_REQUIRE_VECTOR(E);
+    const E& x = e.self();
+    const size_t n = x.size();
+    const size_t simd_count = n & ~3;
+    
+    if (n < 4) {
+        size_t result = 0;
+        for (size_t i = 0; i < n; ++i) result += x.at(i) ? 1 : 0;
+        return result;
+    }
+    
+    // True lanes are all ones (-1), so subtracting counts them
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (size_t i = 0; i < simd_count; i += 4) {
+        acc = vsubq_u32(acc, x.load(i));
+    }
+    
+    // Overlapping last vector with the lanes already counted masked off
+    if (simd_count < n) {
+        acc = vsubq_u32(acc, vandq_u32(simd_tail::tail_mask_u32(simd_count + 4 - n), x.load(n - 4)));
+    }
+    
+    return vaddvq_u32(acc);
+}
+
+/**
+ * @brief Whether a mask expression is true in any lane (stops at the first hit)
+ */
+template <typename E>
+inline bool any(const MaskExpr<E>& e) {
+    SIMD_EXPR_REQUIRE_VECTOR(E);
+    const E& x = e.self();
+    const size_t n = x.size();
+    const size_t simd_count = n & ~3;
+    
+    if (n < 4) {
+        for (size_t i = 0; i < n; ++i) {
+            if (x.at(i)) return true;
+        }
+        return false;
+    }
+    
+    for (size_t i = 0; i < simd_count; i += 4) {
+        if (vmaxvq_u32(x.load(i)) != 0) return true;
+    }
+    
+    return vmaxvq_u32(x.load(n - 4)) != 0;
+}
+
+/**
+ * @brief Owning float array that can be assigned from an expression
+ */
+class Vec : public Expr<Vec> {
+public:
+    using stored_type = Span;
+    
+    explicit Vec(size_t n) : values_(n) {}
+    
+    /**
+     * @brief Evaluate an expression into this array, resizing it to the expression's size
+     *
+     * The expression may read this Vec. When the size changes it is evaluated
+     * into a new buffer first, so resizing cannot free what it reads.
+     */
+    template <typename E>
+    Vec& operator=(const Expr<E>& e) {
+        SIMD_EXPR_REQUIRE_VECTOR(E);
+        const size_t n = e.self().size();
+        if (n == values_.size()) {
+            eval(values_.data(), e);
+        } else {
+            std::vector<float> result(n);
+            eval(result.data(), e);
+            values_.swap(result);
+        }
+        return *this;
+    }
+    
+    operator Span() const { return Span(values_.data(), values_.size()); }
+    
+    float32x4_t load(size_t i) const { return vld1q_f32(&values_[i]); }
+    float at(size_t i) const { return values_[i]; }
+    size_t size() const { return values_.size(); }
+    
+    float* data() { return values_.data(); }
+    const float* data() const { return values_.data(); }
+    float& operator[](size_t i) { return values_[i]; }
+    float operator[](size_t i) const { return values_[i]; }
+
+private:
+    std::vector<float> values_;
+};
+
+#undef SIMD_EXPR_REQUIRE_VECTOR
+
+} // namespace expr
+
+#endif // SIMD_EXPR_H
@@ -0,0 +1,315 @@
+#ifndef SIMD_MATH_H
+#define SIMD_MATH_H
+
+#include <cmath>
+#include <cstdint>
+
+#include "simd.h"
+#include "obj_detection_util.h"
+
+/*
+ * Elementary functions on float32x4_t, for kernels that would otherwise
+ * leave the vector path for a scalar libm call per lane.
+ *
+ * Every function works on all four lanes at once with plain NEON
+ * arithmetic: a range reduction, a short polynomial and a reconstruction,
+ * with selects in place of branches. Each comes in two accuracy levels,
+ * chosen with a template argument:
+ *
+ *  - MathAccuracy::Precise (the default): within 1-3 ulp of the correctly
+ *    rounded result, close enough to stand in for libm.
+ *  - MathAccuracy::Fast: errors around 1e-5 (16-17 bits) for fewer
+ *    instructions, for weights, headings and other values that are
+ *    thresholded or displayed rather than accumulated.
+ *
+ * The error bounds in the comments were measured against double-precision
+ * libm over the stated ranges, on builds with FMA. Without FMA, add up to
+ * an ulp, except that sin and cos only keep their absolute bound next to
+ * their zeros. Inputs are expected to be finite; beyond the documented
+ * special cases, infinities and NaNs are not treated specially.
+ */
+
+enum class MathAccuracy {
+    Fast,
+    Precise,
+};
+
+// pi/4 as a short head, exact when multiplied by a small integer, plus the remainder
+constexpr float SIMD_MATH_PI_4_HI = 0.78515625f;
+constexpr float SIMD_MATH_PI_4_LO = 2.4191339744830963e-4f;
+
+constexpr float SIMD_MATH_TAN_PI_8 = 0.414213562373095f;
+
+// pi/2 in three parts (Cody-Waite), so that n * pi/2 is subtracted without rounding for |n| < 2^13
+constexpr float SIMD_MATH_PI_2_A = 1.5703125f;
+constexpr float SIMD_MATH_PI_2_B = 4.837512969970703125e-4f;
+constexpr float SIMD_MATH_PI_2_C = 7.54978995489188216e-8f;
+constexpr float SIMD_MATH_2_PI = 0.636619772367581f;
+
+// ln 2 in two parts, and the range of exp() between overflow and underflow to zero
+constexpr float SIMD_MATH_LN2_HI = 0.693359375f;
+constexpr float SIMD_MATH_LN2_LO = -2.12194440e-4f;
+constexpr float SIMD_MATH_LOG2E = 1.44269504088896f;
+constexpr float SIMD_MATH_EXP_MAX = 88.7228394f;
+constexpr float SIMD_MATH_EXP_MIN = -104.0f;
+
+/**
+ * @brief Lane-wise 1 / x from the hardware estimate and Newton-Raphson steps
+ * @param x Nonzero inputs
+ * @return 1 / x: Precise within 2 ulp (two steps), Fast about 16 bits (one step)
+ */
+template <MathAccuracy Accuracy = MathAccuracy::Precise>
+inline float32x4_t recip_f32x4(float32x4_t x) {
+    float32x4_t r = vrecpeq_f32(x);
+    r = vmulq_f32(r, vrecpsq_f32(x, r));
+    if constexpr (Accuracy == MathAccuracy::Precise) r = vmulq_f32(r, vrecpsq_f32(x, r));
+    return r;
+}
+
+/**
+ * @brief Lane-wise 1 / sqrt(x) from the hardware estimate and Newton-Raphson steps
+ * @param x Positive inputs
+ * @return 1 / sqrt(x): Precise within 3 ulp (two steps), Fast about 16 bits (one step)
+ */
+template <MathAccuracy Accuracy = MathAccuracy::Precise>
+inline float32x4_t rsqrt_f32x4(float32x4_t x) {
+    float32x4_t r = vrsqrteq_f32(x);
+    r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(x, r), r));
+    if constexpr (Accuracy == MathAccuracy::Precise) r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(x, r), r));
+    return r;
+}
+
+/**
+ * @brief Lane-wise sqrt(x)
+ * @param x Non-negative inputs
+ * @return Precise: the correctly rounded FSQRT. Fast: x * rsqrt(x), about 16 bits, with sqrt(0) = 0
+ */
+template <MathAccuracy Accuracy = MathAccuracy::Precise>
+inline float32x4_t sqrt_f32x4(float32x4_t x) {
+    if constexpr (Accuracy == MathAccuracy::Precise) {
+        return vsqrtq_f32(x);
+    } else {
+        const float32x4_t root = vmulq_f32(x, rsqrt_f32x4<MathAccuracy::Fast>(x));
+        return vbslq_f32(vceqq_f32(x, vdupq_n_f32(0.0f)), x, root);
+    }
+}
+
+/**
+ * @brief Lane-wise e^x
+ * @param x Inputs; above ln(FLT_MAX) give infinity, below -104 give 0
+ * @return e^x: Precise within 1 ulp for normal results, Fast within 6e-6 relative
+ *
+ * x = n ln2 + r with |r| <= ln2 / 2, e^r from a polynomial (Cephes expf
+ * for Precise), then scaled by 2^n in two halves so that results down in
+ * the denormal range stay exact.
+ */
+template <MathAccuracy Accuracy = MathAccuracy::Precise>
+inline float32x4_t exp_f32x4(float32x4_t x) {
+    const float32x4_t clamped = vminq_f32(vmaxq_f32(x, vdupq_n_f32(SIMD_MATH_EXP_MIN)), vdupq_n_f32(SIMD_MATH_EXP_MAX));
+    const float32x4_t n = vrndnq_f32(vmulq_f32(clamped, vdupq_n_f32(SIMD_MATH_LOG2E)));
+    float32x4_t r = keep_sum_order(vfmaq_f32(clamped, n, vdupq_n_f32(-SIMD_MATH_LN2_HI)));
+    r = keep_sum_order(vfmaq_f32(r, n, vdupq_n_f32(-SIMD_MATH_LN2_LO)));
+    
+    // e^r = 1 + r + r^2 * poly(r)
+    float32x4_t poly;
+    if constexpr (Accuracy == MathAccuracy::Precise) {
+        poly = vdupq_n_f32(1.9875691500e-4f);
+        poly = vfmaq_f32(vdupq_n_f32(1.3981999507e-3f), poly, r);
+        poly = vfmaq_f32(vdupq_n_f32(8.3334519073e-3f), poly, r);
+        poly = vfmaq_f32(vdupq_n_f32(4.1665795894e-2f), poly, r);
+        poly = vfmaq_f32(vdupq_n_f32(1.6666665459e-1f), poly, r);
+        poly = vfmaq_f32(vdupq_n_f32(5.0000001201e-1f), poly, r);
+    } else {
+        poly = vdupq_n_f32(0.041277752f);
+        poly = vfmaq_f32(vdupq_n_f32(0.167535155f), poly, r);
+        poly = vfmaq_f32(vdupq_n_f32(0.500051161f), poly, r);
+    }
+    const float32x4_t e = vaddq_f32(vfmaq_f32(r, vmulq_f32(r, r), poly), vdupq_n_f32(1.0f));
+    
+    // 2^n as 2^(n/2) * 2^(n - n/2), each a normal float for n in [-150, 128]
+    const int32x4_t n_int = vcvtq_s32_f32(n);
+    const int32x4_t half = vshrq_n_s32(n_int, 1);
+    const int32x4_t bias = vdupq_n_s32(127);
+    const float32x4_t scale_a = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(half, bias), 23));
+    const float32x4_t scale_b = vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vsubq_s32(n_int, half), bias), 23));
+    const float32x4_t result = vmulq_f32(keep_sum_order(vmulq_f32(e, scale_a)), scale_b);
+    return vbslq_f32(vcgtq_f32(x, vdupq_n_f32(SIMD_MATH_EXP_MAX)), vdupq_n_f32(INFINITY), result);
+}
+
+/**
+ * @brief Lane-wise natural logarithm
+ * @param x Inputs; 0 gives -infinity and negative inputs NaN. Denormals are not supported.
+ * @return ln(x): Precise within 1 ulp, Fast within 1.3e-5 relative (absolute near x = 1)
+ *
+ * x = 2^k * m with m in [sqrt(1/2), sqrt(2)), so f = m - 1 is small, then
+ * ln(x) = k ln2 + f - f^2 / 2 + f^3 * poly(f) (Cephes logf for Precise).
+ */
+template <MathAccuracy Accuracy = MathAccuracy::Precise>
+inline float32x4_t log_f32x4(float32x4_t x) {
+    // Offsetting by the bits of sqrt(1/2) makes the exponent field round m into range
+    const int32x4_t bits = vreinterpretq_s32_f32(x);
+    const int32x4_t offset = vsubq_s32(bits, vdupq_n_s32(0x3f3504f3));
+    const int32x4_t k_int = vshrq_n_s32(offset, 23);
+    const float32x4_t m = vreinterpretq_f32_s32(vsubq_s32(bits, vshlq_n_s32(k_int, 23)));
+    const float32x4_t k = vcvtq_f32_s32(k_int);
+    const float32x4_t f = vsubq_f32(m, vdupq_n_f32(1.0f));
+    const float32x4_t z = vmulq_f32(f, f);
+    
+    float32x4_t poly;
+    if constexpr (Accuracy == MathAccuracy::Precise) {
+        poly = vdupq_n_f32(7.0376836292e-2f);
+        poly = vfmaq_f32(vdupq_n_f32(-1.1514610310e-1f), poly, f);
+        poly = vfmaq_f32(vdupq_n_f32(1.1676998740e-1f), poly, f);
+        poly = vfmaq_f32(vdupq_n_f32(-1.2420140846e-1f), poly, f);
+        poly = vfmaq_f32(vdupq_n_f32(1.4249322787e-1f), poly, f);
+        poly = vfmaq_f32(vdupq_n_f32(-1.6668057665e-1f), poly, f);
+        poly = vfmaq_f32(vdupq_n_f32(2.0000714765e-1f), poly, f);
+        poly = vfmaq_f32(vdupq_n_f32(-2.4999993993e-1f), poly, f);
+        poly = vfmaq_f32(vdupq_n_f32(3.3333331174e-1f), poly, f);
+    } else {
+        poly = vdupq_n_f32(-0.145925438f);
+        poly = vfmaq_f32(vdupq_n_f32(0.217765401f), poly, f);
+        poly = vfmaq_f32(vdupq_n_f32(-0.252449994f), poly, f);
+        poly = vfmaq_f32(vdupq_n_f32(0.332854695f), poly, f);
+    }
+    
+    // Small terms first, then f, then the exact k * ln2 head
+    float32x4_t y = vmulq_f32(vmulq_f32(f, z), poly);
+    y = vfmaq_f32(y, k, vdupq_n_f32(SIMD_MATH_LN2_LO));
+    y = vfmaq_f32(y, z, vdupq_n_f32(-0.5f));
+    const float32x4_t result = vfmaq_f32(vaddq_f32(f, y), k, vdupq_n_f32(SIMD_MATH_LN2_HI));
+    
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t special = vbslq_f32(vceqq_f32(x, zero), vdupq_n_f32(-INFINITY), vdupq_n_f32(NAN));
+    return vbslq_f32(vcleq_f32(x, zero), special, result);
+}
+
+namespace simd_math_detail {
+
+/**
+ * @brief sin(x + quarter_turns * pi/2)
+ *
+ * x = n pi/2 + r with |r| <= pi/4. Quadrant q = n + quarter_turns picks
+ * sin(r) or cos(r) and the sign.
+ */
+template <MathAccuracy Accuracy>
+inline float32x4_t sin_quadrant(float32x4_t x, int32_t quarter_turns) {
+    const float32x4_t n = vrndnq_f32(vmulq_f32(x, vdupq_n_f32(SIMD_MATH_2_PI)));
+    float32x4_t r = keep_sum_order(vfmaq_f32(x, n, vdupq_n_f32(-SIMD_MATH_PI_2_A)));
+    r = keep_sum_order(vfmaq_f32(r, n, vdupq_n_f32(-SIMD_MATH_PI_2_B)));
+    r = keep_sum_order(vfmaq_f32(r, n, vdupq_n_f32(-SIMD_MATH_PI_2_C)));
+    const float32x4_t z = vmulq_f32(r, r);
+    
+    // sin(r) = r + r^3 * s(z), cos(r) = 1 - z / 2 + z^2 * c(z) (Cephes sinf/cosf for Precise)
+    float32x4_t sin_r, cos_r;
+    if constexpr (Accuracy == MathAccuracy::Precise) {
+        float32x4_t s = vdupq_n_f32(-1.9515295891e-4f);
+        s = vfmaq_f32(vdupq_n_f32(8.3321608736e-3f), s, z);
+        s = vfmaq_f32(vdupq_n_f32(-1.6666654611e-1f), s, z);
+        sin_r = vfmaq_f32(r, vmulq_f32(r, z), s);
+        
+        float32x4_t c = vdupq_n_f32(2.443315711809948e-5f);
+        c = vfmaq_f32(vdupq_n_f32(-1.388731625493765e-3f), c, z);
+        c = vfmaq_f32(vdupq_n_f32(4.166664568298827e-2f), c, z);
+        cos_r = vfmaq_f32(vfmaq_f32(vdupq_n_f32(1.0f), z, vdupq_n_f32(-0.5f)), vmulq_f32(z, z), c);
+    } else {
+        const float32x4_t s = vfmaq_f32(vdupq_n_f32(-0.166633903f), z, vdupq_n_f32(0.00816328039f));
+        sin_r = vfmaq_f32(r, vmulq_f32(r, z), s);
+        const float32x4_t c = vfmaq_f32(vdupq_n_f32(-0.499760553f), z, vdupq_n_f32(0.0404584419f));
+        cos_r = vfmaq_f32(vdupq_n_f32(1.0f), z, c);
+    }
+    
+    // Odd quadrants take the cosine, quadrants 2 and 3 flip the sign
+    const uint32x4_t q = vreinterpretq_u32_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(quarter_turns)));
+    const uint32x4_t odd = vtstq_u32(q, vdupq_n_u32(1));
+    const uint32x4_t negate = vshlq_n_u32(vandq_u32(q, vdupq_n_u32(2)), 30);
+    const float32x4_t value = vbslq_f32(odd, cos_r, sin_r);
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(value), negate));
+}
+
+} // namespace simd_math_detail
+
+/**
+ * @brief Lane-wise sine
+ * @param x Angles in radians, |x| <= 8192
+ * @return sin(x): Precise within 2 ulp for |x| <= 10 and 1e-7 absolute beyond, Fast within 1.4e-5 absolute
+ */
+template <MathAccuracy Accuracy = MathAccuracy::Precise>
+inline float32x4_t sin_f32x4(float32x4_t x) {
+    return simd_math_detail::sin_quadrant<Accuracy>(x, 0);
+}
+
+/**
+ * @brief Lane-wise cosine
+ * @param x Angles in radians, |x| <= 8192
+ * @return cos(x): Precise within 2 ulp for |x| <= 10 and 1e-7 absolute beyond, Fast within 1.4e-5 absolute
+ */
+template <MathAccuracy Accuracy = MathAccuracy::Precise>
+inline float32x4_t cos_f32x4(float32x4_t x) {
+    return simd_math_detail::sin_quadrant<Accuracy>(x, 1);
+}
+
+/**
+ * @brief Lane-wise atan2(y, x), in radians in [-pi, pi]
+ * @param y Y coordinates (numerator)
+ * @param x X coordinates (denominator)
+ * @return Angle of each (x, y) from the positive x axis: Precise within 2 ulp, Fast within 1e-5 absolute
+ *
+ * The ratio min(|x|, |y|) / max(|x|, |y|) is reduced to |t| <= tan(pi/8)
+ * with atan(a) = pi/4 + atan((a - 1) / (a + 1)), evaluated with a
+ * polynomial (Cephes atanf for Precise) and unfolded to octant * pi/4 +-
+ * atan(t). Both (0, 0) and (-0, 0) give 0.
+ */
+template <MathAccuracy Accuracy = MathAccuracy::Precise>
+inline float32x4_t atan2_f32x4(float32x4_t y, float32x4_t x) {
+    const float32x4_t abs_x = vabsq_f32(x);
+    const float32x4_t abs_y = vabsq_f32(y);
+    const float32x4_t num = vminq_f32(abs_x, abs_y);
+    const float32x4_t den = vmaxq_f32(abs_x, abs_y);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    
+    // Above tan(pi/8), continue from pi/4 so the polynomial only sees |t| <= tan(pi/8):
+    // t = (num - den) / (num + den) = (a - 1) / (a + 1) for a = num / den, with one rounding
+    const uint32x4_t upper = vcgtq_f32(num, vmulq_f32(den, vdupq_n_f32(SIMD_MATH_TAN_PI_8)));
+    const float32x4_t t_num = vbslq_f32(upper, vsubq_f32(num, den), num);
+    const float32x4_t t_den = vbslq_f32(upper, vaddq_f32(num, den), den);
+    
+    // The origin gives 0 instead of 0 / 0
+    const uint32x4_t origin = vceqq_f32(den, vdupq_n_f32(0.0f));
+    const float32x4_t t = vbslq_f32(origin, vdupq_n_f32(0.0f), vdivq_f32(t_num, vbslq_f32(origin, one, t_den)));
+    
+    // atan(t) = t + t^3 * poly(t^2)
+    const float32x4_t z = vmulq_f32(t, t);
+    float32x4_t poly;
+    if constexpr (Accuracy == MathAccuracy::Precise) {
+        poly = vdupq_n_f32(8.05374449538e-2f);
+        poly = vfmaq_f32(vdupq_n_f32(-1.38776856032e-1f), poly, z);
+        poly = vfmaq_f32(vdupq_n_f32(1.99777106478e-1f), poly, z);
+        poly = vfmaq_f32(vdupq_n_f32(-3.33329491539e-1f), poly, z);
+    } else {
+        poly = vfmaq_f32(vdupq_n_f32(-0.33183375f), z, vdupq_n_f32(0.170341537f));
+    }
+    poly = vfmaq_f32(t, vmulq_f32(poly, z), t);
+    
+    // Unfold to octant * pi/4 +- poly: past the diagonal, then into the left half plane
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t octant = vbslq_f32(upper, one, zero);
+    float32x4_t direction = one;
+    const uint32x4_t past_diagonal = vcgtq_f32(abs_y, abs_x);
+    octant = vbslq_f32(past_diagonal, vsubq_f32(vdupq_n_f32(2.0f), octant), octant);
+    direction = vbslq_f32(past_diagonal, vnegq_f32(direction), direction);
+    const uint32x4_t left = vcltq_f32(x, zero);
+    octant = vbslq_f32(left, vsubq_f32(vdupq_n_f32(4.0f), octant), octant);
+    direction = vbslq_f32(left, vnegq_f32(direction), direction);
+    
+    // pi/4 split so that octant * SIMD_MATH_PI_4_HI is exact and the angle is rounded once
+    const float32x4_t small = vfmaq_f32(vmulq_f32(direction, poly), octant, vdupq_n_f32(SIMD_MATH_PI_4_LO));
+    const float32x4_t angle = vfmaq_f32(small, octant, vdupq_n_f32(SIMD_MATH_PI_4_HI));
+    
+    // Below the x axis (including y = -0) the angle is negative
+    const uint32x4_t sign = vdupq_n_u32(0x80000000u);
+    return vreinterpretq_f32_u32(vorrq_u32(vandq_u32(vreinterpretq_u32_f32(y), sign),
+                                           vreinterpretq_u32_f32(angle)));
+}
+
+#endif // SIMD_MATH_H
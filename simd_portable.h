@@ -0,0 +1,549 @@
+#ifndef SIMD_PORTABLE_H
+#define SIMD_PORTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE4_1__)
+#include <immintrin.h>
+#define SIMD_PORTABLE_SSE 1
+#else
+#define SIMD_PORTABLE_SSE 0
+#endif
+
+/*
+ * The NEON types and intrinsics used by the kernels, for hosts without
+ * NEON. Include simd.h rather than this file.
+ *
+ * Vectors are GCC/Clang generic vectors of the same size and lane type as
+ * their NEON counterparts, so element-wise arithmetic, comparisons and
+ * conversions compile to whatever SIMD the target has. Operations with no
+ * natural generic form (blends, horizontal reductions, saturating and
+ * rounding arithmetic, half-precision conversion) use SSE4.1, FMA and F16C
+ * intrinsics when the build enables them, and plain lane code otherwise.
+ *
+ * Results match NEON lane for lane, with three exceptions: without FMA,
+ * vfmaq_f32 rounds the product before the add, vminq/vmaxq may return
+ * either zero when comparing +0 with -0, and the vrecpeq/vrsqrteq
+ * estimates are more precise than NEON's.
+ */
+
+#if !defined(__GNUC__)
+#error "simd_portable.h needs GCC or Clang vector extensions"
+#endif
+
+typedef _Float16 float16_t;
+
+typedef float float32x2_t __attribute__((vector_size(8)));
+typedef float float32x4_t __attribute__((vector_size(16)));
+typedef _Float16 float16x4_t __attribute__((vector_size(8)));
+typedef _Float16 float16x8_t __attribute__((vector_size(16)));
+typedef uint8_t uint8x8_t __attribute__((vector_size(8)));
+typedef uint8_t uint8x16_t __attribute__((vector_size(16)));
+typedef int8_t int8x8_t __attribute__((vector_size(8)));
+typedef int8_t int8x16_t __attribute__((vector_size(16)));
+typedef uint16_t uint16x4_t __attribute__((vector_size(8)));
+typedef uint16_t uint16x8_t __attribute__((vector_size(16)));
+typedef int16_t int16x4_t __attribute__((vector_size(8)));
+typedef int16_t int16x8_t __attribute__((vector_size(16)));
+typedef uint32_t uint32x2_t __attribute__((vector_size(8)));
+typedef uint32_t uint32x4_t __attribute__((vector_size(16)));
+typedef int32_t int32x2_t __attribute__((vector_size(8)));
+typedef int32_t int32x4_t __attribute__((vector_size(16)));
+typedef uint64_t uint64x1_t __attribute__((vector_size(8)));
+typedef int64_t int64x2_t __attribute__((vector_size(16)));
+
+struct float32x4x2_t {
+    float32x4_t val[2];
+};
+
+struct float32x4x3_t {
+    float32x4_t val[3];
+};
+
+struct float32x4x4_t {
+    float32x4_t val[4];
+};
+
+namespace simd_portable {
+
+/**
+ * @brief Bitwise select: lanes of a where mask bits are set, b elsewhere
+ */
+template <typename V, typename M>
+inline V select(M mask, V a, V b) {
+    return (V)((mask & (M)a) | (~mask & (M)b));
+}
+
+/**
+ * @brief Fold all lanes of v into one with op, in lane order
+ */
+template <size_t Lanes, typename V, typename Op>
+inline auto fold_lanes(V v, Op op) {
+    auto result = v[0];
+    for (size_t i = 1; i < Lanes; ++i) result = op(result, v[i]);
+    return result;
+}
+
+template <int N>
+inline float32x4_t ext_f32(float32x4_t a, float32x4_t b) {
+    static_assert(N >= 0 && N < 4, "lane index out of range");
+    return __builtin_shufflevector(a, b, N, N + 1, N + 2, N + 3);
+}
+
+template <int N>
+inline int32x4_t ext_s32(int32x4_t a, int32x4_t b) {
+    static_assert(N >= 0 && N < 4, "lane index out of range");
+    return __builtin_shufflevector(a, b, N, N + 1, N + 2, N + 3);
+}
+
+#if SIMD_PORTABLE_SSE
+// Reductions over the byte lanes of an SSE register via PHMINPOSUW
+inline uint32_t min_epu8(__m128i v) {
+    const __m128i pairs = _mm_min_epu8(v, _mm_srli_epi16(v, 8));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_minpos_epu16(_mm_and_si128(pairs, _mm_set1_epi16(0x00ff))))) & 0xffff;
+}
+
+inline uint32_t min_epu16(__m128i v) {
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_minpos_epu16(v))) & 0xffff;
+}
+#endif
+
+} // namespace simd_portable
+
+// Loads and stores
+
+inline float32x4_t vld1q_f32(const float* p) { float32x4_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+inline float16x8_t vld1q_f16(const float16_t* p) { float16x8_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+inline uint8x16_t vld1q_u8(const uint8_t* p) { uint8x16_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+inline int8x16_t vld1q_s8(const int8_t* p) { int8x16_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+inline uint16x8_t vld1q_u16(const uint16_t* p) { uint16x8_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+inline int16x8_t vld1q_s16(const int16_t* p) { int16x8_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+
+inline float32x4x4_t vld1q_f32_x4(const float* p) {
+    float32x4x4_t v;
+    std::memcpy(&v.val[0], p, sizeof(v.val));
+    return v;
+}
+
+// De-interleaving loads: {x0, y0, x1, y1, ...} -> {x0, x1, ...}, {y0, y1, ...}
+inline float32x4x2_t vld2q_f32(const float* p) {
+    const float32x4_t a = vld1q_f32(p);
+    const float32x4_t b = vld1q_f32(p + 4);
+    return {{__builtin_shufflevector(a, b, 0, 2, 4, 6), __builtin_shufflevector(a, b, 1, 3, 5, 7)}};
+}
+
+inline float32x4x3_t vld3q_f32(const float* p) {
+    const float32x4_t a = vld1q_f32(p);      // x0 y0 z0 x1
+    const float32x4_t b = vld1q_f32(p + 4);  // y1 z1 x2 y2
+    const float32x4_t c = vld1q_f32(p + 8);  // z2 x3 y3 z3
+    const float32x4_t x = __builtin_shufflevector(a, b, 0, 3, 6, 6);
+    const float32x4_t y = __builtin_shufflevector(a, b, 1, 4, 7, 7);
+    const float32x4_t z = __builtin_shufflevector(a, b, 2, 5, 5, 5);
+    return {{__builtin_shufflevector(x, c, 0, 1, 2, 5),
+             __builtin_shufflevector(y, c, 0, 1, 2, 6),
+             __builtin_shufflevector(z, c, 0, 1, 4, 7)}};
+}
+
+inline void vst1q_f32(float* p, float32x4_t v) { std::memcpy(p, &v, sizeof(v)); }
+inline void vst1q_u8(uint8_t* p, uint8x16_t v) { std::memcpy(p, &v, sizeof(v)); }
+inline void vst1_u8(uint8_t* p, uint8x8_t v) { std::memcpy(p, &v, sizeof(v)); }
+inline void vst1q_s16(int16_t* p, int16x8_t v) { std::memcpy(p, &v, sizeof(v)); }
+inline void vst1q_s32(int32_t* p, int32x4_t v) { std::memcpy(p, &v, sizeof(v)); }
+inline void vst1q_s64(int64_t* p, int64x2_t v) { std::memcpy(p, &v, sizeof(v)); }
+inline void vst1q_u32(uint32_t* p, uint32x4_t v) { std::memcpy(p, &v, sizeof(v)); }
+inline void vst1q_f32_x4(float* p, float32x4x4_t v) { std::memcpy(p, &v.val[0], sizeof(v.val)); }
+
+// Interleaving stores, the inverses of vld2q_f32 and vld3q_f32
+inline void vst2q_f32(float* p, float32x4x2_t v) {
+    vst1q_f32(p, __builtin_shufflevector(v.val[0], v.val[1], 0, 4, 1, 5));
+    vst1q_f32(p + 4, __builtin_shufflevector(v.val[0], v.val[1], 2, 6, 3, 7));
+}
+
+inline void vst3q_f32(float* p, float32x4x3_t v) {
+    const float32x4_t xy_lo = __builtin_shufflevector(v.val[0], v.val[1], 0, 4, 1, 5);  // x0 y0 x1 y1
+    const float32x4_t yxy = __builtin_shufflevector(v.val[0], v.val[1], 5, 2, 6, 6);    // y1 x2 y2 -
+    const float32x4_t xy_hi = __builtin_shufflevector(v.val[0], v.val[1], 3, 7, 7, 7);  // x3 y3 - -
+    vst1q_f32(p, __builtin_shufflevector(xy_lo, v.val[2], 0, 1, 4, 2));
+    vst1q_f32(p + 4, __builtin_shufflevector(yxy, v.val[2], 0, 5, 1, 2));
+    vst1q_f32(p + 8, __builtin_shufflevector(xy_hi, v.val[2], 6, 0, 1, 7));
+}
+
+// Broadcasts and lane access
+
+inline float32x4_t vdupq_n_f32(float x) { return float32x4_t{x, x, x, x}; }
+inline uint32x4_t vdupq_n_u32(uint32_t x) { return uint32x4_t{x, x, x, x}; }
+inline int32x4_t vdupq_n_s32(int32_t x) { return int32x4_t{x, x, x, x}; }
+inline int64x2_t vdupq_n_s64(int64_t x) { return int64x2_t{x, x}; }
+inline uint16x8_t vdupq_n_u16(uint16_t x) { return uint16x8_t{x, x, x, x, x, x, x, x}; }
+inline int16x8_t vdupq_n_s16(int16_t x) { return int16x8_t{x, x, x, x, x, x, x, x}; }
+inline uint8x16_t vdupq_n_u8(uint8_t x) { return uint8x16_t{x, x, x, x, x, x, x, x, x, x, x, x, x, x, x, x}; }
+inline int8x16_t vdupq_n_s8(int8_t x) { return int8x16_t{x, x, x, x, x, x, x, x, x, x, x, x, x, x, x, x}; }
+inline uint8x8_t vdup_n_u8(uint8_t x) { return uint8x8_t{x, x, x, x, x, x, x, x}; }
+inline uint16x4_t vdup_n_u16(uint16_t x) { return uint16x4_t{x, x, x, x}; }
+
+inline float32x4_t vdupq_laneq_f32(float32x4_t v, int lane) { return vdupq_n_f32(v[lane]); }
+inline int32x4_t vdupq_laneq_s32(int32x4_t v, int lane) { return vdupq_n_s32(v[lane]); }
+inline int64x2_t vdupq_laneq_s64(int64x2_t v, int lane) { return vdupq_n_s64(v[lane]); }
+
+inline float vget_lane_f32(float32x2_t v, int lane) { return v[lane]; }
+inline float vgetq_lane_f32(float32x4_t v, int lane) { return v[lane]; }
+inline uint32_t vget_lane_u32(uint32x2_t v, int lane) { return v[lane]; }
+inline uint64_t vget_lane_u64(uint64x1_t v, int lane) { return v[lane]; }
+
+inline float32x2_t vget_low_f32(float32x4_t v) { return __builtin_shufflevector(v, v, 0, 1); }
+inline float32x2_t vget_high_f32(float32x4_t v) { return __builtin_shufflevector(v, v, 2, 3); }
+inline float16x4_t vget_low_f16(float16x8_t v) { return __builtin_shufflevector(v, v, 0, 1, 2, 3); }
+inline int16x4_t vget_low_s16(int16x8_t v) { return __builtin_shufflevector(v, v, 0, 1, 2, 3); }
+inline int32x2_t vget_low_s32(int32x4_t v) { return __builtin_shufflevector(v, v, 0, 1); }
+inline int8x8_t vget_low_s8(int8x16_t v) { return __builtin_shufflevector(v, v, 0, 1, 2, 3, 4, 5, 6, 7); }
+
+inline uint8x16_t vcombine_u8(uint8x8_t lo, uint8x8_t hi) {
+    return __builtin_shufflevector(lo, hi, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+}
+inline float32x4_t vcombine_f32(float32x2_t lo, float32x2_t hi) { return __builtin_shufflevector(lo, hi, 0, 1, 2, 3); }
+inline uint16x8_t vcombine_u16(uint16x4_t lo, uint16x4_t hi) { return __builtin_shufflevector(lo, hi, 0, 1, 2, 3, 4, 5, 6, 7); }
+inline int16x8_t vcombine_s16(int16x4_t lo, int16x4_t hi) { return __builtin_shufflevector(lo, hi, 0, 1, 2, 3, 4, 5, 6, 7); }
+
+// NEON requires constant lane counts here too
+#define vextq_f32(a, b, n) simd_portable::ext_f32<(n)>((a), (b))
+#define vextq_s32(a, b, n) simd_portable::ext_s32<(n)>((a), (b))
+
+inline float32x4_t vtrn1q_f32(float32x4_t a, float32x4_t b) { return __builtin_shufflevector(a, b, 0, 4, 2, 6); }
+inline float32x4_t vtrn2q_f32(float32x4_t a, float32x4_t b) { return __builtin_shufflevector(a, b, 1, 5, 3, 7); }
+inline uint8x16_t vuzp1q_u8(uint8x16_t a, uint8x16_t b) {
+    return __builtin_shufflevector(a, b, 0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+}
+inline uint16x8_t vuzp1q_u16(uint16x8_t a, uint16x8_t b) { return __builtin_shufflevector(a, b, 0, 2, 4, 6, 8, 10, 12, 14); }
+
+// Reinterpretation
+
+inline uint32x4_t vreinterpretq_u32_f32(float32x4_t v) { return (uint32x4_t)v; }
+inline float32x4_t vreinterpretq_f32_u32(uint32x4_t v) { return (float32x4_t)v; }
+inline int32x4_t vreinterpretq_s32_f32(float32x4_t v) { return (int32x4_t)v; }
+inline float32x4_t vreinterpretq_f32_s32(int32x4_t v) { return (float32x4_t)v; }
+inline uint32x4_t vreinterpretq_u32_s32(int32x4_t v) { return (uint32x4_t)v; }
+inline int32x4_t vreinterpretq_s32_u32(uint32x4_t v) { return (int32x4_t)v; }
+inline uint16x8_t vreinterpretq_u16_u32(uint32x4_t v) { return (uint16x8_t)v; }
+inline uint16x8_t vreinterpretq_u16_u8(uint8x16_t v) { return (uint16x8_t)v; }
+inline uint8x16_t vreinterpretq_u8_u16(uint16x8_t v) { return (uint8x16_t)v; }
+inline int8x16_t vreinterpretq_s8_u8(uint8x16_t v) { return (int8x16_t)v; }
+inline int16x8_t vreinterpretq_s16_u16(uint16x8_t v) { return (int16x8_t)v; }
+inline uint64x1_t vreinterpret_u64_u8(uint8x8_t v) { return (uint64x1_t)v; }
+inline uint32x2_t vreinterpret_u32_u8(uint8x8_t v) { return (uint32x2_t)v; }
+
+// Floating-point arithmetic
+
+inline float32x4_t vaddq_f32(float32x4_t a, float32x4_t b) { return a + b; }
+inline float32x4_t vsubq_f32(float32x4_t a, float32x4_t b) { return a - b; }
+inline float32x4_t vmulq_f32(float32x4_t a, float32x4_t b) { return a * b; }
+inline float32x4_t vdivq_f32(float32x4_t a, float32x4_t b) {
+#if SIMD_PORTABLE_SSE
+    // FDIV is correctly rounded; keep -ffast-math from turning this into RCPPS + Newton step
+#if defined(__AVX__)
+    __asm__("vdivps %2, %1, %0" : "=x"(a) : "x"(a), "xm"(b));
+#else
+    __asm__("divps %1, %0" : "+x"(a) : "xm"(b));
+#endif
+    return a;
+#else
+    return a / b;
+#endif
+}
+inline float32x4_t vnegq_f32(float32x4_t a) { return -a; }
+inline float32x2_t vadd_f32(float32x2_t a, float32x2_t b) { return a + b; }
+
+inline float32x4_t vfmaq_f32(float32x4_t acc, float32x4_t a, float32x4_t b) {
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a, b, acc);
+#else
+    return acc + a * b;
+#endif
+}
+
+inline float32x4_t vabsq_f32(float32x4_t a) {
+    return (float32x4_t)((uint32x4_t)a & vdupq_n_u32(0x7fffffffu));
+}
+
+inline float32x4_t vsqrtq_f32(float32x4_t a) {
+#if SIMD_PORTABLE_SSE
+    return _mm_sqrt_ps(a);
+#else
+    return float32x4_t{std::sqrt(a[0]), std::sqrt(a[1]), std::sqrt(a[2]), std::sqrt(a[3])};
+#endif
+}
+
+// Reciprocal and reciprocal square root estimates. SSE gives 12 bits where
+// NEON gives 8, and the generic path the exact value; the Newton steps
+// below refine any of them.
+inline float32x4_t vrecpeq_f32(float32x4_t a) {
+#if SIMD_PORTABLE_SSE
+    return _mm_rcp_ps(a);
+#else
+    return float32x4_t{1.0f / a[0], 1.0f / a[1], 1.0f / a[2], 1.0f / a[3]};
+#endif
+}
+
+inline float32x4_t vrsqrteq_f32(float32x4_t a) {
+#if SIMD_PORTABLE_SSE
+    return _mm_rsqrt_ps(a);
+#else
+    return float32x4_t{1.0f / std::sqrt(a[0]), 1.0f / std::sqrt(a[1]), 1.0f / std::sqrt(a[2]), 1.0f / std::sqrt(a[3])};
+#endif
+}
+
+// Newton step factors: FRECPS is 2 - a * b, FRSQRTS is (3 - a * b) / 2, both fused
+inline float32x4_t vrecpsq_f32(float32x4_t a, float32x4_t b) { return vfmaq_f32(vdupq_n_f32(2.0f), -a, b); }
+inline float32x4_t vrsqrtsq_f32(float32x4_t a, float32x4_t b) { return vfmaq_f32(vdupq_n_f32(3.0f), -a, b) * 0.5f; }
+
+// Round to nearest, ties to even
+inline float32x4_t vrndnq_f32(float32x4_t a) {
+#if SIMD_PORTABLE_SSE
+    return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#else
+    return float32x4_t{std::nearbyint(a[0]), std::nearbyint(a[1]), std::nearbyint(a[2]), std::nearbyint(a[3])};
+#endif
+}
+
+// FMIN/FMAX return NaN when either input is NaN
+inline float32x4_t vminq_f32(float32x4_t a, float32x4_t b) {
+    const uint32x4_t take_a = (uint32x4_t)(a < b) | (uint32x4_t)(a != a);
+    return simd_portable::select(take_a, a, b);
+}
+
+inline float32x4_t vmaxq_f32(float32x4_t a, float32x4_t b) {
+    const uint32x4_t take_a = (uint32x4_t)(a > b) | (uint32x4_t)(a != a);
+    return simd_portable::select(take_a, a, b);
+}
+
+inline float32x4_t vpaddq_f32(float32x4_t a, float32x4_t b) {
+#if SIMD_PORTABLE_SSE
+    return _mm_hadd_ps(a, b);
+#else
+    return float32x4_t{a[0] + a[1], a[2] + a[3], b[0] + b[1], b[2] + b[3]};
+#endif
+}
+
+inline float32x2_t vpadd_f32(float32x2_t a, float32x2_t b) { return float32x2_t{a[0] + a[1], b[0] + b[1]}; }
+
+// Same pairwise order as FADDP
+inline float vaddvq_f32(float32x4_t v) { return (v[0] + v[1]) + (v[2] + v[3]); }
+
+inline float vminvq_f32(float32x4_t v) {
+    const float32x4_t pairs = vminq_f32(v, __builtin_shufflevector(v, v, 2, 3, 0, 1));
+    return vminq_f32(pairs, __builtin_shufflevector(pairs, pairs, 1, 0, 3, 2))[0];
+}
+
+inline float vmaxvq_f32(float32x4_t v) {
+    const float32x4_t pairs = vmaxq_f32(v, __builtin_shufflevector(v, v, 2, 3, 0, 1));
+    return vmaxq_f32(pairs, __builtin_shufflevector(pairs, pairs, 1, 0, 3, 2))[0];
+}
+
+// FMINNMV ignores NaN lanes unless every lane is NaN
+inline float vminnmvq_f32(float32x4_t v) {
+    auto min_number = [](float32x4_t a, float32x4_t b) {
+        const float32x4_t min = simd_portable::select((uint32x4_t)(a != a), b, vminq_f32(a, b));
+        return simd_portable::select((uint32x4_t)(b != b), a, min);
+    };
+    const float32x4_t pairs = min_number(v, __builtin_shufflevector(v, v, 2, 3, 0, 1));
+    return min_number(pairs, __builtin_shufflevector(pairs, pairs, 1, 0, 3, 2))[0];
+}
+
+inline float32x4_t vcvt_f32_f16(float16x4_t v) {
+#if defined(__F16C__)
+    __m128i bits = _mm_setzero_si128();
+    std::memcpy(&bits, &v, sizeof(v));
+    return _mm_cvtph_ps(bits);
+#else
+    return __builtin_convertvector(v, float32x4_t);
+#endif
+}
+
+inline float32x4_t vcvt_high_f32_f16(float16x8_t v) {
+    return vcvt_f32_f16(__builtin_shufflevector(v, v, 4, 5, 6, 7));
+}
+
+inline float32x4_t vcvtq_f32_s32(int32x4_t v) { return __builtin_convertvector(v, float32x4_t); }
+inline int32x4_t vcvtq_s32_f32(float32x4_t v) { return __builtin_convertvector(v, int32x4_t); }
+inline int32x4_t vcvtnq_s32_f32(float32x4_t v) { return vcvtq_s32_f32(vrndnq_f32(v)); }
+
+// Comparisons, producing all-ones lanes where true
+
+inline uint32x4_t vceqq_f32(float32x4_t a, float32x4_t b) { return (uint32x4_t)(a == b); }
+inline uint32x4_t vcgtq_f32(float32x4_t a, float32x4_t b) { return (uint32x4_t)(a > b); }
+inline uint32x4_t vcgeq_f32(float32x4_t a, float32x4_t b) { return (uint32x4_t)(a >= b); }
+inline uint32x4_t vcltq_f32(float32x4_t a, float32x4_t b) { return (uint32x4_t)(a < b); }
+inline uint32x4_t vcleq_f32(float32x4_t a, float32x4_t b) { return (uint32x4_t)(a <= b); }
+inline uint32x4_t vceqq_u32(uint32x4_t a, uint32x4_t b) { return (uint32x4_t)(a == b); }
+inline uint32x4_t vcltq_u32(uint32x4_t a, uint32x4_t b) { return (uint32x4_t)(a < b); }
+inline uint32x4_t vcgeq_u32(uint32x4_t a, uint32x4_t b) { return (uint32x4_t)(a >= b); }
+inline uint32x4_t vcltq_s32(int32x4_t a, int32x4_t b) { return (uint32x4_t)(a < b); }
+inline uint32x4_t vcgeq_s32(int32x4_t a, int32x4_t b) { return (uint32x4_t)(a >= b); }
+inline uint16x8_t vceqq_u16(uint16x8_t a, uint16x8_t b) { return (uint16x8_t)(a == b); }
+inline uint16x8_t vcgtq_u16(uint16x8_t a, uint16x8_t b) { return (uint16x8_t)(a > b); }
+inline uint16x8_t vcgeq_u16(uint16x8_t a, uint16x8_t b) { return (uint16x8_t)(a >= b); }
+inline uint16x8_t vceqq_s16(int16x8_t a, int16x8_t b) { return (uint16x8_t)(a == b); }
+inline uint16x8_t vcgtq_s16(int16x8_t a, int16x8_t b) { return (uint16x8_t)(a > b); }
+inline uint8x16_t vceqq_u8(uint8x16_t a, uint8x16_t b) { return (uint8x16_t)(a == b); }
+inline uint8x16_t vcgtq_u8(uint8x16_t a, uint8x16_t b) { return (uint8x16_t)(a > b); }
+inline uint8x16_t vcgeq_u8(uint8x16_t a, uint8x16_t b) { return (uint8x16_t)(a >= b); }
+inline uint8x16_t vceqq_s8(int8x16_t a, int8x16_t b) { return (uint8x16_t)(a == b); }
+inline uint8x16_t vcgtq_s8(int8x16_t a, int8x16_t b) { return (uint8x16_t)(a > b); }
+
+// Bitwise operations and selects
+
+inline uint32x4_t vandq_u32(uint32x4_t a, uint32x4_t b) { return a & b; }
+inline uint32x4_t vorrq_u32(uint32x4_t a, uint32x4_t b) { return a | b; }
+inline uint32x4_t vmvnq_u32(uint32x4_t a) { return ~a; }
+inline uint32x4_t veorq_u32(uint32x4_t a, uint32x4_t b) { return a ^ b; }
+inline uint32x4_t vtstq_u32(uint32x4_t a, uint32x4_t b) { return (uint32x4_t)((a & b) != 0); }
+inline uint8x16_t vandq_u8(uint8x16_t a, uint8x16_t b) { return a & b; }
+inline uint8x8_t vand_u8(uint8x8_t a, uint8x8_t b) { return a & b; }
+inline int8x16_t vandq_s8(int8x16_t a, int8x16_t b) { return a & b; }
+inline int16x8_t vandq_s16(int16x8_t a, int16x8_t b) { return a & b; }
+
+inline uint32x4_t vbslq_u32(uint32x4_t mask, uint32x4_t a, uint32x4_t b) { return simd_portable::select(mask, a, b); }
+inline float32x4_t vbslq_f32(uint32x4_t mask, float32x4_t a, float32x4_t b) { return simd_portable::select(mask, a, b); }
+
+// Integer arithmetic
+
+inline uint32x4_t vaddq_u32(uint32x4_t a, uint32x4_t b) { return a + b; }
+inline uint32x4_t vsubq_u32(uint32x4_t a, uint32x4_t b) { return a - b; }
+inline uint32x4_t vshlq_n_u32(uint32x4_t a, int n) { return a << n; }
+inline int32x4_t vaddq_s32(int32x4_t a, int32x4_t b) { return a + b; }
+inline int32x4_t vsubq_s32(int32x4_t a, int32x4_t b) { return a - b; }
+// Wrapping multiply-subtract, as MLS
+inline int32x4_t vmlsq_s32(int32x4_t acc, int32x4_t a, int32x4_t b) {
+    return (int32x4_t)((uint32x4_t)acc - (uint32x4_t)a * (uint32x4_t)b);
+}
+inline int32x4_t vshlq_n_s32(int32x4_t a, int n) { return (int32x4_t)((uint32x4_t)a << n); }
+inline int32x4_t vshrq_n_s32(int32x4_t a, int n) { return a >> n; }
+inline int64x2_t vaddq_s64(int64x2_t a, int64x2_t b) { return a + b; }
+
+inline uint32x4_t vminq_u32(uint32x4_t a, uint32x4_t b) { return simd_portable::select((uint32x4_t)(a < b), a, b); }
+inline uint16x8_t vminq_u16(uint16x8_t a, uint16x8_t b) { return simd_portable::select((uint16x8_t)(a < b), a, b); }
+inline int16x8_t vminq_s16(int16x8_t a, int16x8_t b) { return simd_portable::select((uint16x8_t)(a < b), a, b); }
+inline uint8x16_t vminq_u8(uint8x16_t a, uint8x16_t b) { return simd_portable::select((uint8x16_t)(a < b), a, b); }
+inline int8x16_t vminq_s8(int8x16_t a, int8x16_t b) { return simd_portable::select((uint8x16_t)(a < b), a, b); }
+
+// Widening, narrowing and pairwise accumulation
+
+inline uint16x4_t vmovn_u32(uint32x4_t v) { return __builtin_convertvector(v, uint16x4_t); }
+inline uint8x8_t vmovn_u16(uint16x8_t v) { return __builtin_convertvector(v, uint8x8_t); }
+inline uint8x8_t vshrn_n_u16(uint16x8_t v, int n) { return __builtin_convertvector(v >> n, uint8x8_t); }
+
+inline int16x8_t vmovl_s8(int8x8_t v) { return __builtin_convertvector(v, int16x8_t); }
+inline int16x8_t vmovl_high_s8(int8x16_t v) { return vmovl_s8(__builtin_shufflevector(v, v, 8, 9, 10, 11, 12, 13, 14, 15)); }
+inline int32x4_t vmovl_s16(int16x4_t v) { return __builtin_convertvector(v, int32x4_t); }
+inline int32x4_t vmovl_high_s16(int16x8_t v) { return vmovl_s16(__builtin_shufflevector(v, v, 4, 5, 6, 7)); }
+inline int64x2_t vmovl_s32(int32x2_t v) { return __builtin_convertvector(v, int64x2_t); }
+inline int64x2_t vmovl_high_s32(int32x4_t v) { return vmovl_s32(__builtin_shufflevector(v, v, 2, 3)); }
+
+inline int16x8_t vmull_s8(int8x8_t a, int8x8_t b) { return vmovl_s8(a) * vmovl_s8(b); }
+inline int16x8_t vmull_high_s8(int8x16_t a, int8x16_t b) { return vmovl_high_s8(a) * vmovl_high_s8(b); }
+inline int32x4_t vmull_s16(int16x4_t a, int16x4_t b) { return vmovl_s16(a) * vmovl_s16(b); }
+inline int32x4_t vmull_high_s16(int16x8_t a, int16x8_t b) { return vmovl_high_s16(a) * vmovl_high_s16(b); }
+
+inline int32x4_t vsubl_s16(int16x4_t a, int16x4_t b) { return vmovl_s16(a) - vmovl_s16(b); }
+inline int32x4_t vsubl_high_s16(int16x8_t a, int16x8_t b) { return vmovl_high_s16(a) - vmovl_high_s16(b); }
+
+inline int32x4_t vmlal_n_s16(int32x4_t acc, int16x4_t a, int16_t b) { return acc + vmovl_s16(a) * static_cast<int32_t>(b); }
+inline int32x4_t vmlal_high_n_s16(int32x4_t acc, int16x8_t a, int16_t b) { return acc + vmovl_high_s16(a) * static_cast<int32_t>(b); }
+
+inline int32x4_t vpaddlq_s16(int16x8_t v) {
+#if SIMD_PORTABLE_SSE
+    return (int32x4_t)_mm_madd_epi16((__m128i)v, _mm_set1_epi16(1));
+#else
+    return __builtin_convertvector(__builtin_shufflevector(v, v, 0, 2, 4, 6), int32x4_t) +
+           __builtin_convertvector(__builtin_shufflevector(v, v, 1, 3, 5, 7), int32x4_t);
+#endif
+}
+
+inline int32x4_t vpadalq_s16(int32x4_t acc, int16x8_t v) { return acc + vpaddlq_s16(v); }
+
+inline int64x2_t vpadalq_s32(int64x2_t acc, int32x4_t v) {
+    return acc + __builtin_convertvector(__builtin_shufflevector(v, v, 0, 2), int64x2_t) +
+           __builtin_convertvector(__builtin_shufflevector(v, v, 1, 3), int64x2_t);
+}
+
+inline int16x4_t vqmovn_s32(int32x4_t v) {
+#if SIMD_PORTABLE_SSE
+    const int16x8_t packed = (int16x8_t)_mm_packs_epi32((__m128i)v, (__m128i)v);
+    return __builtin_shufflevector(packed, packed, 0, 1, 2, 3);
+#else
+    const int32x4_t lo = vdupq_n_s32(INT16_MIN);
+    const int32x4_t hi = vdupq_n_s32(INT16_MAX);
+    v = simd_portable::select((uint32x4_t)(v < lo), lo, v);
+    v = simd_portable::select((uint32x4_t)(v > hi), hi, v);
+    return __builtin_convertvector(v, int16x4_t);
+#endif
+}
+
+// Rounding shift without the overflow of adding the rounding constant first
+inline int16x4_t vqrshrn_n_s32(int32x4_t v, int n) {
+    return vqmovn_s32((v >> n) + ((v >> (n - 1)) & 1));
+}
+
+inline int32x4_t vqrdmulhq_s32(int32x4_t a, int32x4_t b) {
+#if SIMD_PORTABLE_SSE
+    const __m128i round = _mm_set1_epi64x(int64_t{1} << 30);
+    const __m128i even = _mm_add_epi64(_mm_mul_epi32((__m128i)a, (__m128i)b), round);
+    const __m128i odd = _mm_add_epi64(_mm_mul_epi32(_mm_srli_epi64((__m128i)a, 32), _mm_srli_epi64((__m128i)b, 32)), round);
+    // Bits 31..62 of each product: low half of the even lanes, high half of the odd ones
+    const int32x4_t result = (int32x4_t)_mm_blend_epi16(_mm_srli_epi64(even, 31), _mm_slli_epi64(odd, 1), 0xcc);
+#else
+    int32x4_t result;
+    for (int i = 0; i < 4; ++i) {
+        const int64_t product = static_cast<int64_t>(a[i]) * b[i];
+        result[i] = static_cast<int32_t>(static_cast<uint64_t>(product + (int64_t{1} << 30)) >> 31);
+    }
+#endif
+    // Only INT32_MIN * INT32_MIN overflows; it saturates to INT32_MAX
+    const int32x4_t min = vdupq_n_s32(INT32_MIN);
+    return result ^ (int32x4_t)((a == min) & (b == min));
+}
+
+// Horizontal reductions
+
+inline uint32_t vaddvq_u32(uint32x4_t v) { return (v[0] + v[1]) + (v[2] + v[3]); }
+inline int64_t vaddvq_s64(int64x2_t v) { return v[0] + v[1]; }
+
+inline uint32_t vminvq_u32(uint32x4_t v) {
+    const uint32x4_t pairs = vminq_u32(v, __builtin_shufflevector(v, v, 2, 3, 0, 1));
+    return vminq_u32(pairs, __builtin_shufflevector(pairs, pairs, 1, 0, 3, 2))[0];
+}
+
+inline uint32_t vmaxvq_u32(uint32x4_t v) { return ~vminvq_u32(~v); }
+
+inline uint16_t vminvq_u16(uint16x8_t v) {
+#if SIMD_PORTABLE_SSE
+    return static_cast<uint16_t>(simd_portable::min_epu16((__m128i)v));
+#else
+    return simd_portable::fold_lanes<8>(v, [](uint16_t a, uint16_t b) { return a < b ? a : b; });
+#endif
+}
+
+inline uint16_t vmaxvq_u16(uint16x8_t v) { return static_cast<uint16_t>(~vminvq_u16(~v)); }
+
+inline int16_t vminvq_s16(int16x8_t v) {
+    // Flipping the sign bit maps signed order onto unsigned order
+    return static_cast<int16_t>(vminvq_u16((uint16x8_t)v ^ vdupq_n_u16(0x8000)) ^ 0x8000);
+}
+
+inline uint8_t vminvq_u8(uint8x16_t v) {
+#if SIMD_PORTABLE_SSE
+    return static_cast<uint8_t>(simd_portable::min_epu8((__m128i)v));
+#else
+    return simd_portable::fold_lanes<16>(v, [](uint8_t a, uint8_t b) { return a < b ? a : b; });
+#endif
+}
+
+inline uint8_t vmaxvq_u8(uint8x16_t v) { return static_cast<uint8_t>(~vminvq_u8(~v)); }
+
+inline int8_t vminvq_s8(int8x16_t v) {
+    return static_cast<int8_t>(vminvq_u8((uint8x16_t)v ^ vdupq_n_u8(0x80)) ^ 0x80);
+}
+
+#endif // SIMD_PORTABLE_H
@@ -0,0 +1,175 @@
+#ifndef SIMD_TAIL_H
+#define SIMD_TAIL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "simd.h"
+
+/*
+ * Tail handling shared by the kernels.
+ *
+ * A loop over `count` elements in V-lane vectors leaves count % V of them.
+ * Rather than finishing those one at a time, the kernels keep them on the
+ * vector path:
+ *
+ *  - Maps whose output does not feed back into their input recompute the
+ *    last full vector, ending exactly at count, and store it over the
+ *    overlap, which simply receives the same values again. The tail is
+ *    computed before the main loop so in-place calls stay correct.
+ *  - Reductions load the same last vector and mask off the lanes the main
+ *    loop already covered (load_tail_zeroed), or rely on min/max being
+ *    idempotent and take it as is.
+ *  - Recurrences (prefix sums, EMA) and arrays shorter than one vector
+ *    stage the remaining elements in a vector-sized buffer (Partial). The
+ *    copy never touches memory past `count` and is split into power-of-two
+ *    pieces, so it costs a handful of moves whatever the remainder.
+ *
+ * Callers that can guarantee readable padding past the end of their
+ * buffers use the aligned_t overloads in aligned_kernels.h instead.
+ */
+
+namespace simd_tail {
+
+/**
+ * @brief Copy bytes <= Capacity (at most 64) as at most seven fixed-size moves
+ */
+template <size_t Capacity>
+inline void copy_short(void* dst, const void* src, size_t bytes) {
+    static_assert(Capacity <= 64, "copy_short moves at most 64 bytes");
+    
+    uint8_t* d = static_cast<uint8_t*>(dst);
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+    
+    // Lets the compiler see that no piece runs past the buffer
+    if (bytes > Capacity) __builtin_unreachable();
+    
+    // Pieces larger than Capacity cannot occur and are compiled out
+    if (Capacity >= 64 && (bytes & 64)) { std::memcpy(d, s, 64); d += 64; s += 64; }
+    if (Capacity >= 32 && (bytes & 32)) { std::memcpy(d, s, 32); d += 32; s += 32; }
+    if (Capacity >= 16 && (bytes & 16)) { std::memcpy(d, s, 16); d += 16; s += 16; }
+    if (Capacity >= 8 && (bytes & 8)) { std::memcpy(d, s, 8); d += 8; s += 8; }
+    if (Capacity >= 4 && (bytes & 4)) { std::memcpy(d, s, 4); d += 4; s += 4; }
+    if (Capacity >= 2 && (bytes & 2)) { std::memcpy(d, s, 2); d += 2; s += 2; }
+    if (bytes & 1) *d = *s;
+}
+
+/**
+ * @brief Staging buffer for up to Lanes elements (default: one 128-bit vector)
+ */
+template <typename T, size_t Lanes = 16 / sizeof(T)>
+struct Partial {
+    static_assert(Lanes * sizeof(T) <= 64, "copy_short moves at most 64 bytes");
+    
+    alignas(16) T lanes[Lanes];
+    
+    /**
+     * @brief Fill lanes [0, n) from src and the rest with `fill`
+     */
+    void load(const T* src, size_t n, T fill) {
+        for (size_t k = 0; k < Lanes; ++k) lanes[k] = fill;
+        copy_short<sizeof(lanes)>(lanes, src, n * sizeof(T));
+    }
+    
+    /**
+     * @brief Fill lanes [Lanes - n, Lanes) from src and the rest with `fill`
+     */
+    void load_back(const T* src, size_t n, T fill) {
+        for (size_t k = 0; k < Lanes; ++k) lanes[k] = fill;
+        copy_short<sizeof(lanes)>(lanes + (Lanes - n), src, n * sizeof(T));
+    }
+    
+    /**
+     * @brief Write lanes [0, n) to dst
+     */
+    void store(T* dst, size_t n) const {
+        copy_short<sizeof(lanes)>(dst, lanes, n * sizeof(T));
+    }
+};
+
+/**
+ * @brief Mask selecting the first `remaining` lanes of a vector
+ * @param remaining Number of active lanes (0 to 4)
+ * @return All-ones in lanes [0, remaining), zero elsewhere
+ */
+inline uint32x4_t lane_mask_first(size_t remaining) {
+    const uint32x4_t lane = {0, 1, 2, 3};
+    return vcltq_u32(lane, vdupq_n_u32(static_cast<uint32_t>(remaining)));
+}
+
+/**
+ * @brief Mask keeping lanes >= skip, i.e. dropping the first `skip` lanes of an overlapping vector
+ */
+inline uint32x4_t tail_mask_u32(size_t skip) {
+    const uint32x4_t lane = {0, 1, 2, 3};
+    return vcgeq_u32(lane, vdupq_n_u32(static_cast<uint32_t>(skip)));
+}
+
+inline uint16x8_t tail_mask_u16(size_t skip) {
+    const uint16x8_t lane = {0, 1, 2, 3, 4, 5, 6, 7};
+    return vcgeq_u16(lane, vdupq_n_u16(static_cast<uint16_t>(skip)));
+}
+
+inline uint8x16_t tail_mask_u8(size_t skip) {
+    const uint8x16_t lane = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    return vcgeq_u8(lane, vdupq_n_u8(static_cast<uint8_t>(skip)));
+}
+
+/**
+ * @brief The vector ending at array[count - 1], with every lane outside the last count % 4 elements zeroed
+ *
+ * Lanes that the main loop already covered, or that would lie before
+ * array[0] when count < 4, read as zero. Call only when count % 4 != 0.
+ */
+inline float32x4_t load_tail_zeroed(const float* array, size_t count) {
+    const size_t tail = count & 3;
+    if (count < 4) {
+        Partial<float> p;
+        p.load_back(array, tail, 0.0f);
+        return vld1q_f32(p.lanes);
+    }
+    const uint32x4_t keep = tail_mask_u32(4 - tail);
+    return vreinterpretq_f32_u32(vandq_u32(keep, vreinterpretq_u32_f32(vld1q_f32(&array[count - 4]))));
+}
+
+inline int16x8_t load_tail_zeroed(const int16_t* array, size_t count) {
+    const size_t tail = count & 7;
+    if (count < 8) {
+        Partial<int16_t> p;
+        p.load_back(array, tail, 0);
+        return vld1q_s16(p.lanes);
+    }
+    return vandq_s16(vreinterpretq_s16_u16(tail_mask_u16(8 - tail)), vld1q_s16(&array[count - 8]));
+}
+
+inline int8x16_t load_tail_zeroed(const int8_t* array, size_t count) {
+    const size_t tail = count & 15;
+    if (count < 16) {
+        Partial<int8_t> p;
+        p.load_back(array, tail, 0);
+        return vld1q_s8(p.lanes);
+    }
+    return vandq_s8(vreinterpretq_s8_u8(tail_mask_u8(16 - tail)), vld1q_s8(&array[count - 16]));
+}
+
+/**
+ * @brief Index of the first set lane of a byte comparison mask (16 if none)
+ */
+inline size_t first_set_lane(uint8x16_t mask) {
+    // Narrowing shift keeps four bits per lane in lane order
+    const uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(mask), 4)), 0);
+    return bits ? static_cast<size_t>(__builtin_ctzll(bits)) / 4 : 16;
+}
+
+/**
+ * @brief Index of the first set lane of a 16-bit comparison mask (8 if none)
+ */
+inline size_t first_set_lane(uint16x8_t mask) {
+    const uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(mask)), 0);
+    return bits ? static_cast<size_t>(__builtin_ctzll(bits)) / 8 : 8;
+}
+
+} // namespace simd_tail
+
+#endif // SIMD_TAIL_H
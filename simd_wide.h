@@ -0,0 +1,138 @@
+#ifndef SIMD_WIDE_H
+#define SIMD_WIDE_H
+
+#include <cstdint>
+
+#include "simd.h"
+
+/*
+ * Eight-lane float and mask/index vectors for the hottest kernel loops.
+ *
+ * The kernels are written with 128-bit NEON intrinsics, which the x86
+ * backend maps onto SSE, so AVX2 hosts would leave half of every register
+ * idle. The hot reductions and maps therefore run their main loop over
+ * these types first when simd_wide::NATIVE is set, and finish with the
+ * 4-lane code:
+ *
+ *  - AVX2 with FMA (-march=x86-64-v3): one 256-bit register per vector.
+ *    NATIVE is true.
+ *  - NEON, SSE4.1 and generic: a pair of 128-bit vectors, so code using
+ *    these types compiles everywhere. NATIVE is false and the kernels skip
+ *    their 8-lane loops, so ARM code generation and results are unchanged.
+ *
+ * Eight-lane reductions add in a different order from the 4-lane loops, so
+ * sums from AVX2 builds may differ from the other backends in the last bits.
+ */
+
+namespace simd_wide {
+
+#if defined(__AVX2__) && defined(__FMA__) && !defined(__ARM_NEON)
+
+constexpr bool NATIVE = true;
+
+// Eight floats
+struct f32x8 {
+    __m256 v;
+};
+
+// Eight 32-bit lanes: comparison masks (all ones or all zeros) or indices
+struct u32x8 {
+    __m256i v;
+};
+
+inline f32x8 load(const float* src) { return {_mm256_loadu_ps(src)}; }
+inline void store(float* dst, f32x8 a) { _mm256_storeu_ps(dst, a.v); }
+inline f32x8 dup(float x) { return {_mm256_set1_ps(x)}; }
+inline f32x8 add(f32x8 a, f32x8 b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline f32x8 sub(f32x8 a, f32x8 b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline f32x8 mul(f32x8 a, f32x8 b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline f32x8 fma(f32x8 acc, f32x8 a, f32x8 b) { return {_mm256_fmadd_ps(a.v, b.v, acc.v)}; }
+
+inline u32x8 less(f32x8 a, f32x8 b) { return {_mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ))}; }
+inline u32x8 greater(f32x8 a, f32x8 b) { return {_mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ))}; }
+inline f32x8 select(u32x8 mask, f32x8 a, f32x8 b) { return {_mm256_blendv_ps(b.v, a.v, _mm256_castsi256_ps(mask.v))}; }
+inline u32x8 select(u32x8 mask, u32x8 a, u32x8 b) { return {_mm256_blendv_epi8(b.v, a.v, mask.v)}; }
+
+/**
+ * @brief Indices first .. first + 7
+ */
+inline u32x8 iota(uint32_t first) {
+    return {_mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7))};
+}
+
+inline float32x4_t low(f32x8 a) { return (float32x4_t)_mm256_castps256_ps128(a.v); }
+inline float32x4_t high(f32x8 a) { return (float32x4_t)_mm256_extractf128_ps(a.v, 1); }
+inline uint32x4_t low(u32x8 a) { return (uint32x4_t)_mm256_castsi256_si128(a.v); }
+inline uint32x4_t high(u32x8 a) { return (uint32x4_t)_mm256_extracti128_si256(a.v, 1); }
+
+/**
+ * @brief Two 8-lane masks narrowed to sixteen bytes of 0xFF/0x00, a's lanes first
+ */
+inline uint8x16_t narrow_masks(u32x8 a, u32x8 b) {
+    // packs interleaves the 128-bit halves; the permute puts a's eight lanes ahead of b's
+    const __m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(a.v, b.v), 0xD8);
+    return (uint8x16_t)_mm_packs_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+}
+
+#else
+
+constexpr bool NATIVE = false;
+
+// Eight floats
+struct f32x8 {
+    float32x4_t lo, hi;
+};
+
+// Eight 32-bit lanes: comparison masks (all ones or all zeros) or indices
+struct u32x8 {
+    uint32x4_t lo, hi;
+};
+
+inline f32x8 load(const float* src) { return {vld1q_f32(src), vld1q_f32(src + 4)}; }
+inline void store(float* dst, f32x8 a) { vst1q_f32(dst, a.lo); vst1q_f32(dst + 4, a.hi); }
+inline f32x8 dup(float x) { return {vdupq_n_f32(x), vdupq_n_f32(x)}; }
+inline f32x8 add(f32x8 a, f32x8 b) { return {vaddq_f32(a.lo, b.lo), vaddq_f32(a.hi, b.hi)}; }
+inline f32x8 sub(f32x8 a, f32x8 b) { return {vsubq_f32(a.lo, b.lo), vsubq_f32(a.hi, b.hi)}; }
+inline f32x8 mul(f32x8 a, f32x8 b) { return {vmulq_f32(a.lo, b.lo), vmulq_f32(a.hi, b.hi)}; }
+inline f32x8 fma(f32x8 acc, f32x8 a, f32x8 b) { return {vfmaq_f32(acc.lo, a.lo, b.lo), vfmaq_f32(acc.hi, a.hi, b.hi)}; }
+
+inline u32x8 less(f32x8 a, f32x8 b) { return {vcltq_f32(a.lo, b.lo), vcltq_f32(a.hi, b.hi)}; }
+inline u32x8 greater(f32x8 a, f32x8 b) { return {vcgtq_f32(a.lo, b.lo), vcgtq_f32(a.hi, b.hi)}; }
+inline f32x8 select(u32x8 mask, f32x8 a, f32x8 b) { return {vbslq_f32(mask.lo, a.lo, b.lo), vbslq_f32(mask.hi, a.hi, b.hi)}; }
+inline u32x8 select(u32x8 mask, u32x8 a, u32x8 b) { return {vbslq_u32(mask.lo, a.lo, b.lo), vbslq_u32(mask.hi, a.hi, b.hi)}; }
+
+/**
+ * @brief Indices first .. first + 7
+ */
+inline u32x8 iota(uint32_t first) {
+    const uint32x4_t lane = {0, 1, 2, 3};
+    const uint32x4_t lo = vaddq_u32(lane, vdupq_n_u32(first));
+    return {lo, vaddq_u32(lo, vdupq_n_u32(4))};
+}
+
+inline float32x4_t low(f32x8 a) { return a.lo; }
+inline float32x4_t high(f32x8 a) { return a.hi; }
+inline uint32x4_t low(u32x8 a) { return a.lo; }
+inline uint32x4_t high(u32x8 a) { return a.hi; }
+
+/**
+ * @brief Two 8-lane masks narrowed to sixteen bytes of 0xFF/0x00, a's lanes first
+ */
+inline uint8x16_t narrow_masks(u32x8 a, u32x8 b) {
+    const uint16x8_t lo = vcombine_u16(vmovn_u32(a.lo), vmovn_u32(a.hi));
+    const uint16x8_t hi = vcombine_u16(vmovn_u32(b.lo), vmovn_u32(b.hi));
+    return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+}
+
+#endif
+
+/**
+ * @brief The two halves added lane-wise, for finishing a reduction with 4-lane code
+ */
+inline float32x4_t fold(f32x8 a) {
+    return vaddq_f32(low(a), high(a));
+}
+
+} // namespace simd_wide
+
+#endif // SIMD_WIDE_H
@@ -0,0 +1,191 @@
+#ifndef STREAMING_STORES_H
+#define STREAMING_STORES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+#include "simd.h"
+#include "aligned_arena.h"
+
+/*
+ * Streaming mode for the element-wise kernels on arrays larger than the
+ * last-level cache.
+ *
+ * Past the LLC a normal store first reads the line it writes
+ * (read-for-ownership) and then evicts data that is still useful, only to
+ * have the output itself evicted before anyone reads it. Above
+ * streaming_config().threshold_bytes (the LLC size) speed(), cumulative_sum()
+ * and moving_average_filter() therefore switch to variants that:
+ *
+ *  - write whole cache lines with non-temporal stores: STNP on AArch64,
+ *    MOVNTPS on x86. Other targets fall back to normal stores.
+ *  - prefetch their inputs streaming_config().prefetch_bytes ahead. The
+ *    default of 0 relies on the hardware prefetcher; applications opt in
+ *    to the distance tuned for speed() on this core by calling
+ *    apply_streaming_tuning() (tuned_kernels.h) from main().
+ *
+ * The cache size is read on the first call large enough to stream, not at
+ * startup, and nothing here depends on the working directory.
+ *
+ * Results are bit-identical to the cached path. Streaming needs a 16-byte
+ * aligned output, which every heap array has; other calls keep to normal
+ * stores. The variants end with streaming_fence(), so their output is
+ * ordered before later stores, such as a flag handing it to another thread.
+ */
+
+// LLC size assumed when the cache hierarchy cannot be read
+constexpr size_t STREAMING_DEFAULT_LLC_BYTES = 2 * 1024 * 1024;
+
+// Smallest threshold: below this the output certainly fits in cache
+constexpr size_t STREAMING_MIN_THRESHOLD_BYTES = 256 * 1024;
+
+// Input prefetch distance until something sets a tuned one: hardware prefetcher only
+constexpr size_t STREAMING_DEFAULT_PREFETCH_BYTES = 0;
+
+// Floats per cache line, the unit of the streaming loops
+constexpr size_t STREAMING_LINE_FLOATS = CACHE_LINE_SIZE / sizeof(float);
+
+/**
+ * @brief Bytes in a sysfs cache size such as "32K" or "8M", 0 if unreadable
+ */
+inline size_t parse_cache_size(const char* text) {
+    size_t value = 0;
+    while (*text >= '0' && *text <= '9') value = value * 10 + (*text++ - '0');
+    if (*text == 'K' || *text == 'k') value *= 1024;
+    if (*text == 'M' || *text == 'm') value *= 1024 * 1024;
+    return value;
+}
+
+#if defined(__linux__)
+/**
+ * @brief Read a small sysfs file into text as a C string
+ * @return Whether anything was read
+ */
+inline bool read_sysfs_text(const char* path, char* text, size_t size) {
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    const ssize_t n = ::read(fd, text, size - 1);
+    ::close(fd);
+    text[n > 0 ? n : 0] = '\0';
+    return n > 0;
+}
+#endif
+
+/**
+ * @brief Size of the last-level cache, or STREAMING_DEFAULT_LLC_BYTES if unknown
+ */
+inline size_t detect_llc_bytes() {
+    size_t llc = 0;
+#if defined(__linux__)
+    // Highest-level cache of CPU 0, which is shared by the cluster or socket
+    int llc_level = 0;
+    for (int index = 0; index < 16; ++index) {
+        char path[64], level[16], size[16];
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        if (!read_sysfs_text(path, level, sizeof(level))) break;
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+        if (!read_sysfs_text(path, size, sizeof(size))) break;
+        const int cache_level = std::atoi(level);
+        if (cache_level >= llc_level) {
+            llc_level = cache_level;
+            llc = parse_cache_size(size);
+        }
+    }
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    if (llc == 0) {
+        const long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        const long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        llc = l3 > 0 ? static_cast<size_t>(l3) : l2 > 0 ? static_cast<size_t>(l2) : 0;
+    }
+#endif
+#elif defined(__APPLE__)
+    for (const char* name : {"hw.l3cachesize", "hw.l2cachesize"}) {
+        int64_t value = 0;
+        size_t size = sizeof(value);
+        if (sysctlbyname(name, &value, &size, nullptr, 0) == 0 && value > 0) {
+            llc = static_cast<size_t>(value);
+            break;
+        }
+    }
+#endif
+    return llc > 0 ? llc : STREAMING_DEFAULT_LLC_BYTES;
+}
+
+/**
+ * @brief When the kernels stream, and how far ahead they prefetch
+ */
+struct StreamingConfig {
+    size_t threshold_bytes;  // calls touching at least this many bytes stream
+    size_t prefetch_bytes;   // input prefetch distance, 0 = hardware prefetcher only
+};
+
+/**
+ * @brief The streaming settings, filled on first use with the LLC size and the default prefetch distance
+ *
+ * Settable, e.g. to a tuned prefetch distance, before threads that call
+ * the kernels start.
+ */
+inline StreamingConfig& streaming_config() {
+    static StreamingConfig config = [] {
+        const size_t llc = detect_llc_bytes();
+        return StreamingConfig{llc > STREAMING_MIN_THRESHOLD_BYTES ? llc : STREAMING_MIN_THRESHOLD_BYTES,
+                               STREAMING_DEFAULT_PREFETCH_BYTES};
+    }();
+    return config;
+}
+
+/**
+ * @brief Whether a call touching `bytes` bytes and writing to `output` should stream
+ */
+inline bool use_streaming_stores(const void* output, size_t bytes) {
+    // Small calls never stream, and never pay for reading the cache size
+    return bytes >= STREAMING_MIN_THRESHOLD_BYTES && bytes >= streaming_config().threshold_bytes &&
+           reinterpret_cast<uintptr_t>(output) % 16 == 0;
+}
+
+/**
+ * @brief Elements to store normally before output reaches a cache line boundary
+ */
+inline size_t streaming_head(const float* output, size_t count) {
+    const size_t offset = reinterpret_cast<uintptr_t>(output) % CACHE_LINE_SIZE;
+    const size_t head = offset ? (CACHE_LINE_SIZE - offset) / sizeof(float) : 0;
+    return head < count ? head : count;
+}
+
+/**
+ * @brief Store eight floats at a 16-byte aligned address, bypassing the caches where the target can
+ */
+inline void store_streaming(float* p, float32x4_t a, float32x4_t b) {
+#if defined(__aarch64__)
+    __asm__("stnp %q1, %q2, %0" : "=Q"(*reinterpret_cast<float (*)[8]>(p)) : "w"(a), "w"(b));
+#elif defined(SIMD_PORTABLE_SSE) && SIMD_PORTABLE_SSE
+    _mm_stream_ps(p, a);
+    _mm_stream_ps(p + 4, b);
+#else
+    vst1q_f32(p, a);
+    vst1q_f32(p + 4, b);
+#endif
+}
+
+/**
+ * @brief Order the preceding streaming stores before later stores
+ *
+ * MOVNTPS stores are weakly ordered and need SFENCE. STNP is only a cache
+ * hint and keeps the normal store ordering, so Arm needs nothing.
+ */
+inline void streaming_fence() {
+#if defined(SIMD_PORTABLE_SSE) && SIMD_PORTABLE_SSE
+    _mm_sfence();
+#endif
+}
+
+#endif // STREAMING_STORES_H
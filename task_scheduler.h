@@ -0,0 +1,348 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.h"
+
+/*
+ * Work-stealing scheduler for per-frame graphs of small, uneven kernel calls.
+ *
+ * A TaskGraph holds callables and "runs before" edges. run() executes the
+ * graph on the calling thread plus the scheduler's workers. Each
+ * participant owns a Chase-Lev deque: it pushes newly ready tasks to the
+ * bottom and pops them LIFO (cache-warm), while idle participants steal
+ * FIFO from the top of a random victim. Work therefore migrates to
+ * whichever cores are free, which a static split cannot do on big.LITTLE
+ * parts.
+ *
+ * Between runs workers spin briefly and then park, like ThreadPool.
+ * Per-worker busy time, task and steal counts of the last run are kept in
+ * SchedulerStats.
+ */
+
+class TaskGraph;
+
+namespace task_detail {
+
+struct Node {
+    std::function<void()> work;
+    std::vector<Node*> successors;
+    int num_predecessors = 0;
+    std::atomic<int> pending{0};
+};
+
+} // namespace task_detail
+
+/**
+ * @brief Bounded lock-free work-stealing deque (Chase-Lev)
+ *
+ * push() and pop() may only be called by the owning thread; steal() by any
+ * thread. push() fails when the deque is full and the caller runs the task
+ * itself instead.
+ */
+class ChaseLevDeque {
+public:
+    using Item = task_detail::Node*;
+    
+    explicit ChaseLevDeque(size_t capacity_log2 = 12)
+        : mask_((int64_t{1} << capacity_log2) - 1),
+          buffer_(new std::atomic<Item>[size_t{1} << capacity_log2]) {}
+    
+    bool push(Item item) {
+        const int64_t b = bottom_.load(std::memory_order_relaxed);
+        const int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t > mask_) return false;
+        
+        buffer_[b & mask_].store(item, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_release);
+        return true;
+    }
+    
+    Item pop() {
+        const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_seq_cst);
+        
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        
+        Item item = buffer_[b & mask_].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Last element: race any thief for it
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+    
+    Item steal() {
+        int64_t t = top_.load(std::memory_order_seq_cst);
+        const int64_t b = bottom_.load(std::memory_order_seq_cst);
+        if (t >= b) return nullptr;
+        
+        Item item = buffer_[t & mask_].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+private:
+    const int64_t mask_;
+    std::unique_ptr<std::atomic<Item>[]> buffer_;
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+};
+
+/**
+ * @brief Directed acyclic graph of tasks, reusable across frames
+ */
+class TaskGraph {
+public:
+    using TaskId = size_t;
+    
+    /**
+     * @brief Add a task
+     * @param work Callable run once per TaskGraph execution; must not throw
+     * @return Handle used to declare dependencies
+     */
+    TaskId add(std::function<void()> work) {
+        nodes_.push_back(std::make_unique<task_detail::Node>());
+        nodes_.back()->work = std::move(work);
+        return nodes_.size() - 1;
+    }
+    
+    /**
+     * @brief Declare that task `before` must finish before task `after` starts
+     */
+    void precede(TaskId before, TaskId after) {
+        nodes_[before]->successors.push_back(nodes_[after].get());
+        nodes_[after]->num_predecessors++;
+    }
+    
+    size_t size() const { return nodes_.size(); }
+    
+    void clear() { nodes_.clear(); }
+
+private:
+    friend class WorkStealingScheduler;
+    std::vector<std::unique_ptr<task_detail::Node>> nodes_;
+};
+
+/**
+ * @brief Per-participant counters of one run (index 0 is the calling thread)
+ */
+struct WorkerStats {
+    uint64_t tasks = 0;
+    uint64_t steals = 0;
+    uint64_t busy_ns = 0;
+};
+
+struct SchedulerStats {
+    uint64_t wall_ns = 0;
+    std::vector<WorkerStats> workers;
+    
+    /**
+     * @brief Fraction of the run's wall time a participant spent executing tasks
+     */
+    double utilization(size_t worker) const {
+        return wall_ns ? static_cast<double>(workers[worker].busy_ns) / wall_ns : 0.0;
+    }
+};
+
+class WorkStealingScheduler {
+public:
+    /**
+     * @brief Start a scheduler
+     * @param num_workers Worker threads in addition to the thread calling run()
+     * @param spin_iterations Polls before an idle worker parks between runs
+     */
+    explicit WorkStealingScheduler(size_t num_workers, uint32_t spin_iterations = 20000)
+        : spin_iterations_(spin_iterations) {
+        for (size_t i = 0; i <= num_workers; ++i) {
+            participants_.push_back(std::make_unique<Participant>());
+            participants_.back()->rng = 0x9e3779b97f4a7c15ull * (i + 1);
+        }
+        for (size_t i = 1; i <= num_workers; ++i) {
+            threads_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+    
+    ~WorkStealingScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_.store(true);
+        }
+        wake_.notify_all();
+        for (std::thread& t : threads_) t.join();
+    }
+    
+    WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+    
+    size_t concurrency() const { return participants_.size(); }
+    
+    /**
+     * @brief Execute every task of a graph, respecting dependencies, and wait for completion
+     * @param graph Graph to run; must be acyclic and not modified during the run
+     *
+     * Only one thread may call run() at a time.
+     */
+    void run(TaskGraph& graph) {
+        stats_.workers.assign(participants_.size(), WorkerStats{});
+        stats_.wall_ns = 0;
+        if (graph.nodes_.empty()) return;
+        
+        for (auto& p : participants_) p->stats = WorkerStats{};
+        for (auto& node : graph.nodes_) {
+            node->pending.store(node->num_predecessors, std::memory_order_relaxed);
+        }
+        remaining_.store(static_cast<int64_t>(graph.nodes_.size()), std::memory_order_relaxed);
+        
+        const auto start = std::chrono::steady_clock::now();
+        
+        // Roots go to the caller's deque; idle workers steal them from there
+        for (auto& node : graph.nodes_) {
+            if (node->num_predecessors == 0) submit(0, node.get());
+        }
+        
+        active_.store(true, std::memory_order_seq_cst);
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake_.notify_all();
+        }
+        
+        while (remaining_.load(std::memory_order_acquire) > 0) {
+            if (task_detail::Node* node = find_task(0)) {
+                execute(0, node);
+            } else {
+                cpu_relax();
+            }
+        }
+        active_.store(false, std::memory_order_release);
+        
+        stats_.wall_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        for (size_t i = 0; i < participants_.size(); ++i) {
+            stats_.workers[i] = participants_[i]->stats;
+        }
+    }
+    
+    /**
+     * @brief Busy time, task and steal counts of the most recent run()
+     */
+    const SchedulerStats& last_run_stats() const { return stats_; }
+
+private:
+    struct alignas(64) Participant {
+        ChaseLevDeque deque;
+        WorkerStats stats;
+        uint64_t rng = 0;
+    };
+    
+    // Queue a ready task on participant i's deque, running it directly if the deque is full
+    void submit(size_t i, task_detail::Node* node) {
+        if (!participants_[i]->deque.push(node)) execute(i, node);
+    }
+    
+    task_detail::Node* find_task(size_t i) {
+        Participant& self = *participants_[i];
+        if (task_detail::Node* node = self.deque.pop()) return node;
+        
+        const size_t n = participants_.size();
+        for (size_t attempt = 0; attempt < n; ++attempt) {
+            self.rng ^= self.rng << 13;
+            self.rng ^= self.rng >> 7;
+            self.rng ^= self.rng << 17;
+            const size_t victim = self.rng % n;
+            if (victim == i) continue;
+            
+            if (task_detail::Node* node = participants_[victim]->deque.steal()) {
+                self.stats.steals++;
+                return node;
+            }
+        }
+        return nullptr;
+    }
+    
+    void execute(size_t i, task_detail::Node* node) {
+        const auto start = std::chrono::steady_clock::now();
+        node->work();
+        const auto end = std::chrono::steady_clock::now();
+        
+        WorkerStats& stats = participants_[i]->stats;
+        stats.tasks++;
+        stats.busy_ns += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        
+        for (task_detail::Node* next : node->successors) {
+            if (next->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) submit(i, next);
+        }
+        
+        remaining_.fetch_sub(1, std::memory_order_release);
+    }
+    
+    void worker_loop(size_t i) {
+        uint64_t seen = 0;
+        
+        while (true) {
+            uint64_t epoch = epoch_.load(std::memory_order_acquire);
+            
+            for (uint32_t spin = 0; epoch == seen && spin < spin_iterations_; ++spin) {
+                cpu_relax();
+                epoch = epoch_.load(std::memory_order_acquire);
+                if (stop_.load(std::memory_order_relaxed)) return;
+            }
+            
+            if (epoch == seen) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                sleepers_.fetch_add(1, std::memory_order_seq_cst);
+                wake_.wait(lock, [&] {
+                    return stop_.load() || epoch_.load(std::memory_order_seq_cst) != seen;
+                });
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                if (stop_.load()) return;
+                epoch = epoch_.load(std::memory_order_acquire);
+            }
+            
+            seen = epoch;
+            while (active_.load(std::memory_order_acquire)) {
+                if (task_detail::Node* node = find_task(i)) {
+                    execute(i, node);
+                } else {
+                    cpu_relax();
+                }
+            }
+        }
+    }
+    
+    std::vector<std::unique_ptr<Participant>> participants_;
+    std::vector<std::thread> threads_;
+    const uint32_t spin_iterations_;
+    SchedulerStats stats_;
+    
+    alignas(64) std::atomic<int64_t> remaining_{0};
+    alignas(64) std::atomic<uint64_t> epoch_{0};
+    std::atomic<bool> active_{false};
+    std::atomic<uint32_t> sleepers_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex mutex_;
+    std::condition_variable wake_;
+};
+
+#endif // TASK_SCHEDULER_H
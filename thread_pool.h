@@ -0,0 +1,202 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Persistent fork-join thread pool for splitting one kernel call across cores.
+ *
+ * Workers are created once and wait between jobs by spinning on a job
+ * generation counter, then park on a condition variable if nothing arrives
+ * within spin_iterations polls. While they spin, parallel_for() fork and
+ * join cost a few cache-line transfers (low microseconds). The calling
+ * thread always takes part in the job, so a pool of N workers runs N + 1
+ * tasks at once.
+ *
+ * Tasks are claimed dynamically from a counter tagged with the job
+ * generation. Before rewriting the job fields, parallel_for() closes the
+ * finished job by setting the counter to JOB_CLOSED, and workers check
+ * that the generation was open and unchanged around their reads of the
+ * fields (a seqlock). A worker that wakes late for a finished job
+ * therefore cannot claim tasks of the next one or mix the two jobs'
+ * fields. Task bodies must not throw.
+ */
+
+/**
+ * @brief Hint to the core that the caller is busy-waiting
+ */
+inline void cpu_relax() {
+#if defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+class ThreadPool {
+public:
+    /**
+     * @brief Start a pool
+     * @param num_workers Worker threads in addition to the calling thread
+     * @param spin_iterations Polls of the job counter before a worker parks
+     */
+    explicit ThreadPool(size_t num_workers, uint32_t spin_iterations = 20000)
+        : spin_iterations_(spin_iterations) {
+        workers_.reserve(num_workers);
+        for (size_t i = 0; i < num_workers; ++i) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+    
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_.store(true);
+        }
+        wake_.notify_all();
+        for (std::thread& t : workers_) t.join();
+    }
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    /**
+     * @brief Number of threads that run tasks concurrently (workers plus caller)
+     */
+    size_t concurrency() const { return workers_.size() + 1; }
+    
+    /**
+     * @brief Run fn(task) for every task in [0, num_tasks) and wait for completion
+     * @param num_tasks Number of tasks
+     * @param fn Callable taking the task index; must not throw
+     *
+     * num_tasks must stay below 2^32 - 1.
+     * Not reentrant: only one thread may submit to a pool at a time.
+     */
+    template <typename F>
+    void parallel_for(size_t num_tasks, F&& fn) {
+        if (num_tasks == 0) return;
+        if (workers_.empty() || num_tasks == 1) {
+            for (size_t t = 0; t < num_tasks; ++t) fn(t);
+            return;
+        }
+        
+        // Close the finished job so that late workers stop claiming before its fields change
+        const uint64_t generation = (next_.load(std::memory_order_relaxed) >> 32) + 1;
+        next_.store(((generation - 1) << 32) | JOB_CLOSED, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        
+        using Fn = typename std::remove_reference<F>::type;
+        invoke_.store(+[](void* ctx, size_t task) { (*static_cast<Fn*>(ctx))(task); }, std::memory_order_relaxed);
+        context_.store(const_cast<void*>(static_cast<const void*>(&fn)), std::memory_order_relaxed);
+        num_tasks_.store(num_tasks, std::memory_order_relaxed);
+        completed_.store(0, std::memory_order_relaxed);
+        
+        // Publishing the new generation with task 0 releases the job fields above
+        next_.store(generation << 32, std::memory_order_seq_cst);
+        
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake_.notify_all();
+        }
+        
+        run_tasks(generation);
+        
+        while (completed_.load(std::memory_order_acquire) != num_tasks) {
+            cpu_relax();
+        }
+    }
+
+private:
+    using InvokeFn = void (*)(void*, size_t);
+    
+    // Low word of next_ while the job fields are being rewritten; no task index reaches it
+    static constexpr uint64_t JOB_CLOSED = 0xffffffffu;
+    
+    // Whether next_ holds an open job of the given generation
+    static bool job_open(uint64_t word, uint64_t generation) {
+        return (word >> 32) == generation && (word & 0xffffffffu) != JOB_CLOSED;
+    }
+    
+    // Claim and run tasks of the given generation until none are left
+    void run_tasks(uint64_t generation) {
+        // Seqlock read: the fields belong to this job only if it was open, unchanged, on both sides
+        const uint64_t before = next_.load(std::memory_order_acquire);
+        if (!job_open(before, generation)) return;
+        InvokeFn invoke = invoke_.load(std::memory_order_relaxed);
+        void* context = context_.load(std::memory_order_relaxed);
+        const size_t num_tasks = num_tasks_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        
+        // A claim only succeeds while the word is still this generation's and open,
+        // so the fields cannot change under a claimed task
+        uint64_t claim = next_.load(std::memory_order_relaxed);
+        while (job_open(claim, generation) && (claim & 0xffffffffu) < num_tasks) {
+            if (next_.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel)) {
+                invoke(context, static_cast<size_t>(claim & 0xffffffffu));
+                completed_.fetch_add(1, std::memory_order_release);
+                claim = next_.load(std::memory_order_acquire);
+            }
+        }
+    }
+    
+    void worker_loop() {
+        uint64_t seen = 0;
+        
+        while (true) {
+            uint64_t generation = next_.load(std::memory_order_acquire) >> 32;
+            
+            for (uint32_t spin = 0; generation == seen && spin < spin_iterations_; ++spin) {
+                cpu_relax();
+                generation = next_.load(std::memory_order_acquire) >> 32;
+                if (stop_.load(std::memory_order_relaxed)) return;
+            }
+            
+            if (generation == seen) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                sleepers_.fetch_add(1, std::memory_order_seq_cst);
+                wake_.wait(lock, [&] {
+                    return stop_.load() || (next_.load(std::memory_order_seq_cst) >> 32) != seen;
+                });
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                if (stop_.load()) return;
+                generation = next_.load(std::memory_order_acquire) >> 32;
+            }
+            
+            seen = generation;
+            run_tasks(generation);
+        }
+    }
+    
+    std::vector<std::thread> workers_;
+    const uint32_t spin_iterations_;
+    
+    // Job generation in the high 32 bits, next unclaimed task in the low 32 bits
+    alignas(64) std::atomic<uint64_t> next_{0};
+    alignas(64) std::atomic<size_t> completed_{0};
+    alignas(64) std::atomic<InvokeFn> invoke_{nullptr};
+    std::atomic<void*> context_{nullptr};
+    std::atomic<size_t> num_tasks_{0};
+    
+    alignas(64) std::atomic<uint32_t> sleepers_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex mutex_;
+    std::condition_variable wake_;
+};
+
+/**
+ * @brief Process-wide pool with one worker per additional hardware thread
+ */
+inline ThreadPool& default_thread_pool() {
+    static ThreadPool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+    return pool;
+}
+
+#endif // THREAD_POOL_H
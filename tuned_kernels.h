@@ -0,0 +1,346 @@
+#ifndef TUNED_KERNELS_H
+#define TUNED_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include "simd.h"
+#include "obj_detection_util.h"
+#include "fixed_size_kernels.h"
+#include "aligned_arena.h"
+#include "kernel_tuning.h"
+
+/*
+ * Per-core loop shapes for the hottest kernels.
+ *
+ * The best loop shape depends on the core. An in-order Cortex-A53 needs
+ * several independent accumulators to cover FMA latency and software
+ * prefetch to make up for its weak hardware prefetcher. A Cortex-A76 issues
+ * out of order on two FP pipes and runs best deeply unrolled, with no
+ * prefetch. Each tuned kernel is therefore compiled in every shape of a
+ * small grid:
+ *
+ *  - accumulators: independent partial sums in the reductions (1 to 8)
+ *  - unroll: vectors processed per loop iteration (1 to 8)
+ *  - prefetch: how many bytes ahead of the loads to prefetch (0 = none)
+ *
+ * tuned_table resolves startup_tuning() (kernel_tuning.h) to the compiled
+ * variants, and the tuned:: functions call the selected shape with one
+ * indirect call.
+ *
+ * Results equal those of obj_detection_util.h, except that sums split over
+ * several accumulators may round differently in the last bit.
+ *
+ * tuned_table is initialized before main(); do not call the tuned::
+ * functions from other static initializers.
+ */
+
+namespace tuned_detail {
+
+/**
+ * @brief Prefetch every cache line of the Bytes bytes starting at p
+ */
+template <size_t Bytes, typename T>
+inline void prefetch_range(const T* p) {
+    const char* bytes = reinterpret_cast<const char*>(p);
+    unroll<(Bytes + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE>([&](auto line) {
+        __builtin_prefetch(bytes + line * CACHE_LINE_SIZE);
+    });
+}
+
+/**
+ * @brief End of the prefetching part of a loop, so that no prefetch reaches past the array
+ * @param count Elements in the array
+ * @param ahead Prefetch distance in elements (0 = no prefetching part)
+ * @param step Elements per loop iteration
+ */
+inline size_t prefetch_limit(size_t count, size_t ahead, size_t step) {
+    return ahead > 0 && count >= ahead + step ? count - ahead - step + 1 : 0;
+}
+
+/**
+ * @brief Sum of Count accumulators as a balanced tree
+ */
+template <int Count>
+inline float32x4_t sum_accumulators(const float32x4_t* acc) {
+    if constexpr (Count == 1) {
+        return acc[0];
+    } else {
+        return vaddq_f32(sum_accumulators<Count / 2>(acc), sum_accumulators<Count / 2>(acc + Count / 2));
+    }
+}
+
+template <int Accumulators, int Unroll>
+inline float cross_correlation(const float* signal1, const float* signal2, size_t length, size_t prefetch_bytes) {
+    static_assert(Unroll % Accumulators == 0, "every accumulator takes the same number of vectors");
+    
+    float32x4_t sum[Accumulators];
+    for (float32x4_t& s : sum) s = vdupq_n_f32(0.0f);
+    
+    constexpr size_t step = 4 * Unroll;
+    auto block = [&](size_t i) {
+        unroll<Unroll>([&](auto j) {
+            sum[j % Accumulators] = vfmaq_f32(sum[j % Accumulators], vld1q_f32(&signal1[i + 4 * j]),
+                                              vld1q_f32(&signal2[i + 4 * j]));
+        });
+    };
+    
+    const size_t ahead = prefetch_bytes / sizeof(float);
+    const size_t prefetch_end = prefetch_limit(length, ahead, step);
+    const size_t block_count = length - length % step;
+    const size_t simd_count = length & ~3;
+    
+    size_t i = 0;
+    for (; i < prefetch_end; i += step) {
+        prefetch_range<step * sizeof(float)>(&signal1[i + ahead]);
+        prefetch_range<step * sizeof(float)>(&signal2[i + ahead]);
+        block(i);
+    }
+    for (; i < block_count; i += step) block(i);
+    for (; i < simd_count; i += 4) {
+        sum[0] = vfmaq_f32(sum[0], vld1q_f32(&signal1[i]), vld1q_f32(&signal2[i]));
+    }
+    
+    if (simd_count < length) {
+        sum[Accumulators - 1] = vfmaq_f32(sum[Accumulators - 1], simd_tail::load_tail_zeroed(signal1, length),
+                                          simd_tail::load_tail_zeroed(signal2, length));
+    }
+    
+    return vaddvq_f32(sum_accumulators<Accumulators>(sum));
+}
+
+template <int Accumulators, int Unroll>
+inline void weighted_sums(const float* values, const float* weights, size_t count,
+                          float& weighted_sum, float& weight_sum, size_t prefetch_bytes) {
+    static_assert(Unroll % Accumulators == 0, "every accumulator takes the same number of vectors");
+    
+    float32x4_t sum_weighted[Accumulators];
+    float32x4_t sum_weights[Accumulators];
+    for (int a = 0; a < Accumulators; ++a) {
+        sum_weighted[a] = vdupq_n_f32(0.0f);
+        sum_weights[a] = vdupq_n_f32(0.0f);
+    }
+    
+    auto accumulate = [&](size_t a, float32x4_t vals, float32x4_t wts) {
+        sum_weighted[a] = vfmaq_f32(sum_weighted[a], vals, wts);
+        sum_weights[a] = vaddq_f32(sum_weights[a], wts);
+    };
+    
+    constexpr size_t step = 4 * Unroll;
+    auto block = [&](size_t i) {
+        unroll<Unroll>([&](auto j) {
+            accumulate(j % Accumulators, vld1q_f32(&values[i + 4 * j]), vld1q_f32(&weights[i + 4 * j]));
+        });
+    };
+    
+    const size_t ahead = prefetch_bytes / sizeof(float);
+    const size_t prefetch_end = prefetch_limit(count, ahead, step);
+    const size_t block_count = count - count % step;
+    const size_t simd_count = count & ~3;
+    
+    size_t i = 0;
+    for (; i < prefetch_end; i += step) {
+        prefetch_range<step * sizeof(float)>(&values[i + ahead]);
+        prefetch_range<step * sizeof(float)>(&weights[i + ahead]);
+        block(i);
+    }
+    for (; i < block_count; i += step) block(i);
+    for (; i < simd_count; i += 4) accumulate(0, vld1q_f32(&values[i]), vld1q_f32(&weights[i]));
+    
+    if (simd_count < count) {
+        accumulate(Accumulators - 1, simd_tail::load_tail_zeroed(values, count), simd_tail::load_tail_zeroed(weights, count));
+    }
+    
+    weighted_sum = vaddvq_f32(sum_accumulators<Accumulators>(sum_weighted));
+    weight_sum = vaddvq_f32(sum_accumulators<Accumulators>(sum_weights));
+}
+
+template <int Accumulators, int Unroll>
+inline void speed(const float* positions_prev, const float* positions_curr, float* speeds,
+                  size_t count, float time_delta, size_t prefetch_bytes) {
+    if (count < 4) {
+        ::speed(positions_prev, positions_curr, speeds, count, time_delta);
+        return;
+    }
+    
+    const float32x4_t time_inv = vdupq_n_f32(1.0f / time_delta);
+    auto speed4 = [&](size_t i) {
+        return vmulq_f32(vsubq_f32(vld1q_f32(&positions_curr[i]), vld1q_f32(&positions_prev[i])), time_inv);
+    };
+    
+    // Last four speeds, computed up front and stored over the overlap at the end
+    const size_t last = count - 4;
+    const float32x4_t tail = speed4(last);
+    
+    constexpr size_t step = 4 * Unroll;
+    auto block = [&](size_t i) {
+        unroll<Unroll>([&](auto j) { vst1q_f32(&speeds[i + 4 * j], speed4(i + 4 * j)); });
+    };
+    
+    const size_t ahead = prefetch_bytes / sizeof(float);
+    const size_t prefetch_end = prefetch_limit(count, ahead, step);
+    const size_t block_count = count - count % step;
+    const size_t simd_count = count & ~3;
+    
+    size_t i = 0;
+    for (; i < prefetch_end; i += step) {
+        prefetch_range<step * sizeof(float)>(&positions_prev[i + ahead]);
+        prefetch_range<step * sizeof(float)>(&positions_curr[i + ahead]);
+        block(i);
+    }
+    for (; i < block_count; i += step) block(i);
+    for (; i < simd_count; i += 4) vst1q_f32(&speeds[i], speed4(i));
+    
+    vst1q_f32(&speeds[last], tail);
+}
+
+template <int Accumulators, int Unroll>
+inline void threshold_detection(const float* sensor_data, uint8_t* detections, size_t count,
+                                float threshold, size_t prefetch_bytes) {
+    if (count < 16) {
+        ::threshold_detection(sensor_data, detections, count, threshold);
+        return;
+    }
+    
+    const float32x4_t thresh_vec = vdupq_n_f32(threshold);
+    
+    // Last 16 detections, stored over the overlap at the end
+    const uint8x16_t tail = threshold_block_f32(&sensor_data[count - 16], thresh_vec);
+    
+    constexpr size_t step = 16 * Unroll;
+    auto block = [&](size_t i) {
+        unroll<Unroll>([&](auto j) {
+            vst1q_u8(&detections[i + 16 * j], threshold_block_f32(&sensor_data[i + 16 * j], thresh_vec));
+        });
+    };
+    
+    const size_t ahead = prefetch_bytes / sizeof(float);
+    const size_t prefetch_end = prefetch_limit(count, ahead, step);
+    const size_t block_count = count - count % step;
+    const size_t simd_count = count & ~15;
+    
+    size_t i = 0;
+    for (; i < prefetch_end; i += step) {
+        prefetch_range<step * sizeof(float)>(&sensor_data[i + ahead]);
+        block(i);
+    }
+    for (; i < block_count; i += step) block(i);
+    for (; i < simd_count; i += 16) vst1q_u8(&detections[i], threshold_block_f32(&sensor_data[i], thresh_vec));
+    
+    vst1q_u8(&detections[count - 16], tail);
+}
+
+/**
+ * @brief The variant make(accumulators, unroll) for the shape in params, or nullptr if no such shape is compiled
+ */
+template <const TuningShape* Shapes, size_t Count, typename Make>
+inline auto find_shape(const TuningParams& params, Make&& make) {
+    decltype(make(std::integral_constant<int, 1>{}, std::integral_constant<int, 1>{})) variant = nullptr;
+    unroll<Count>([&](auto i) {
+        constexpr TuningShape shape = Shapes[decltype(i)::value];
+        if (params.accumulators == shape.accumulators && params.unroll == shape.unroll) {
+            variant = make(std::integral_constant<int, shape.accumulators>{}, std::integral_constant<int, shape.unroll>{});
+        }
+    });
+    return variant;
+}
+
+} // namespace tuned_detail
+
+/**
+ * @brief Entry points of the selected shapes, with the tuning they implement
+ */
+struct TunedKernelTable {
+    float (*cross_correlation)(const float*, const float*, size_t, size_t);
+    void (*weighted_sums)(const float*, const float*, size_t, float&, float&, size_t);
+    void (*speed)(const float*, const float*, float*, size_t, float, size_t);
+    void (*threshold_detection)(const float*, uint8_t*, size_t, float, size_t);
+    KernelTuning tuning;
+};
+
+/**
+ * @brief Resolve a tuning to compiled variants; shapes that are not compiled fall back to the generic row
+ */
+inline TunedKernelTable select_tuned_kernels(const KernelTuning& tuning) {
+    using namespace tuned_detail;
+    constexpr size_t reductions = std::size(REDUCTION_SHAPES);
+    constexpr size_t maps = std::size(MAP_SHAPES);
+    
+    TunedKernelTable table;
+    table.tuning = tuning;
+    const KernelTuning generic = default_tuning("generic");
+    for (int k = 0; k < TUNED_KERNEL_COUNT; ++k) {
+        if (!valid_tuning(static_cast<TunedKernel>(k), table.tuning.params[k])) table.tuning.params[k] = generic.params[k];
+    }
+    
+    const TuningParams* p = table.tuning.params;
+    table.cross_correlation = find_shape<REDUCTION_SHAPES, reductions>(p[TUNED_CROSS_CORRELATION], [](auto a, auto u) {
+        return &tuned_detail::cross_correlation<decltype(a)::value, decltype(u)::value>;
+    });
+    table.weighted_sums = find_shape<REDUCTION_SHAPES, reductions>(p[TUNED_WEIGHTED_AVERAGE], [](auto a, auto u) {
+        return &tuned_detail::weighted_sums<decltype(a)::value, decltype(u)::value>;
+    });
+    table.speed = find_shape<MAP_SHAPES, maps>(p[TUNED_SPEED], [](auto a, auto u) {
+        return &tuned_detail::speed<decltype(a)::value, decltype(u)::value>;
+    });
+    table.threshold_detection = find_shape<MAP_SHAPES, maps>(p[TUNED_THRESHOLD_DETECTION], [](auto a, auto u) {
+        return &tuned_detail::threshold_detection<decltype(a)::value, decltype(u)::value>;
+    });
+    return table;
+}
+
+// Filled once, before main(), from the tuning file or the defaults for this core
+inline const TunedKernelTable tuned_table = select_tuned_kernels(startup_tuning());
+
+/**
+ * @brief Make the streaming kernels prefetch at the distance tuned for speed()
+ *
+ * Not applied automatically: call it from main(), before starting threads
+ * that run the kernels, to opt the streaming paths in to the tuning.
+ */
+inline void apply_streaming_tuning(const KernelTuning& tuning) {
+    streaming_config().prefetch_bytes = tuning.params[TUNED_SPEED].prefetch_bytes;
+}
+
+namespace tuned {
+
+/**
+ * @brief cross_correlation() in the loop shape tuned for this core
+ */
+inline float cross_correlation(const float* signal1, const float* signal2, size_t length) {
+    return tuned_table.cross_correlation(signal1, signal2, length,
+                                         tuned_table.tuning.params[TUNED_CROSS_CORRELATION].prefetch_bytes);
+}
+
+/**
+ * @brief weighted_average() in the loop shape tuned for this core
+ */
+inline float weighted_average(const float* values, const float* weights, size_t count) {
+    float weighted_sum, weight_sum;
+    tuned_table.weighted_sums(values, weights, count, weighted_sum, weight_sum,
+                              tuned_table.tuning.params[TUNED_WEIGHTED_AVERAGE].prefetch_bytes);
+    return weight_sum > 0.0f ? weighted_sum / weight_sum : 0.0f;
+}
+
+/**
+ * @brief speed() in the loop shape tuned for this core
+ */
+inline void speed(const float* positions_prev, const float* positions_curr, float* speeds,
+                  size_t count, float time_delta) {
+    tuned_table.speed(positions_prev, positions_curr, speeds, count, time_delta,
+                      tuned_table.tuning.params[TUNED_SPEED].prefetch_bytes);
+}
+
+/**
+ * @brief threshold_detection() in the loop shape tuned for this core
+ */
+inline void threshold_detection(const float* sensor_data, uint8_t* detections, size_t count, float threshold) {
+    tuned_table.threshold_detection(sensor_data, detections, count, threshold,
+                                    tuned_table.tuning.params[TUNED_THRESHOLD_DETECTION].prefetch_bytes);
+}
+
+} // namespace tuned
+
+#endif // TUNED_KERNELS_H